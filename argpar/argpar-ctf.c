@@ -0,0 +1,506 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "argpar-ctf.h"
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+#    define ARGPAR_HIDDEN
+#else
+#    define ARGPAR_HIDDEN __attribute__((visibility("hidden")))
+#endif
+
+/* Maximum size of a packet (bytes) */
+#define PACKET_SIZE 4096
+
+/*
+ * Size of the packet header and context (bytes):
+ *
+ *     Packet header:
+ *         magic            4
+ *         uuid             16
+ *         stream_id        4
+ *
+ *     Packet context:
+ *         timestamp_begin  8
+ *         timestamp_end    8
+ *         content_size     8
+ *         packet_size      8
+ */
+#define PACKET_PREAMBLE_SIZE 56
+
+/* Maximum size of an event (bytes): header (9) and payload (24) */
+#define MAX_EVENT_SIZE 33
+
+/* IDs of the event classes (see write_metadata()) */
+enum event_class_id
+{
+    EVENT_CLASS_ID_ITER_CREATE,
+    EVENT_CLASS_ID_ITER_NEXT,
+    EVENT_CLASS_ID_ERROR,
+};
+
+struct argpar_ctf_writer
+{
+    /* File descriptor of the data stream file */
+    int fd;
+
+    /* Trace UUID */
+    unsigned char uuid[16];
+
+    /* `true` if any write failed */
+    bool failed;
+
+    /* Value of `errno` after the first failed write */
+    int failed_errno;
+
+    /* Current packet */
+    struct
+    {
+        /* Timestamps of the first and last events */
+        uint64_t ts_begin;
+        uint64_t ts_end;
+
+        /* Size of the current content (bytes) */
+        size_t size;
+
+        /* Packet data */
+        unsigned char data[PACKET_SIZE];
+    } packet;
+};
+
+/* Returns the current value of the monotonic clock (ns) */
+static uint64_t monotonic_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * UINT64_C(1000000000) + (uint64_t) ts.tv_nsec;
+}
+
+/* Returns whether or not the native byte order is little-endian */
+static bool is_little_endian(void)
+{
+    const uint16_t one = 1;
+
+    return *(const unsigned char *) &one == 1;
+}
+
+/* Fills `uuid` with a random UUID (version 4) */
+static void gen_uuid(unsigned char * const uuid)
+{
+    FILE * const fp = fopen("/dev/urandom", "rb");
+    bool ok = false;
+
+    if (fp) {
+        ok = fread(uuid, 16, 1, fp) == 1;
+        fclose(fp);
+    }
+
+    if (!ok) {
+        /* Fall back to the clock and the process ID */
+        uint64_t state = monotonic_now() ^ ((uint64_t) getpid() << 32) ^ (uint64_t) time(NULL);
+        unsigned int i;
+
+        for (i = 0; i < 16; i++) {
+            /* SplitMix64 step */
+            uint64_t z = (state += UINT64_C(0x9e3779b97f4a7c15));
+
+            z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+            z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+            uuid[i] = (unsigned char) (z ^ (z >> 31));
+        }
+    }
+
+    uuid[6] = (unsigned char) ((uuid[6] & 0x0f) | 0x40);
+    uuid[8] = (unsigned char) ((uuid[8] & 0x3f) | 0x80);
+}
+
+/* Formats the UUID `uuid` into `str` (at least 37 bytes) */
+static void format_uuid(const unsigned char * const uuid, char * const str)
+{
+    sprintf(str,
+            "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-"
+            "%02x%02x%02x%02x%02x%02x",
+            uuid[0], uuid[1], uuid[2], uuid[3], uuid[4], uuid[5], uuid[6], uuid[7], uuid[8],
+            uuid[9], uuid[10], uuid[11], uuid[12], uuid[13], uuid[14], uuid[15]);
+}
+
+/*
+ * Writes the TSDL metadata of `writer` to the file `path`.
+ *
+ * Returns 0 on success or -1 on error.
+ */
+static int write_metadata(const argpar_ctf_writer_t * const writer, const char * const path)
+{
+    FILE * const fp = fopen(path, "w");
+    char uuid_str[37];
+    char hostname[256] = "";
+    struct timespec real_ts;
+    uint64_t offset;
+    int ret = 0;
+
+    if (!fp) {
+        goto error;
+    }
+
+    /* Offset of the monotonic clock from the Epoch (ns) */
+    clock_gettime(CLOCK_REALTIME, &real_ts);
+    offset = (uint64_t) real_ts.tv_sec * UINT64_C(1000000000) + (uint64_t) real_ts.tv_nsec -
+             monotonic_now();
+    format_uuid(writer->uuid, uuid_str);
+    gethostname(hostname, sizeof(hostname) - 1);
+    fprintf(fp,
+            "/* CTF 1.8 */\n"
+            "\n"
+            "typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+            "typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+            "typealias integer { size = 32; align = 8; signed = true; } := int32_t;\n"
+            "typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+            "typealias integer { size = 64; align = 8; signed = false; base = 16; } "
+            ":= uint64_hex_t;\n"
+            "typealias integer {\n"
+            "    size = 64; align = 8; signed = false; map = clock.monotonic.value;\n"
+            "} := uint64_clock_monotonic_t;\n"
+            "\n"
+            "typealias enum : int32_t {\n"
+            "    OK = 0, END = 1, END_AT_NON_OPT = 2, ERROR = -1, ERROR_MEMORY = -12,\n"
+            "} := status_t;\n"
+            "\n"
+            "trace {\n"
+            "    major = 1;\n"
+            "    minor = 8;\n"
+            "    uuid = \"%s\";\n"
+            "    byte_order = %s;\n"
+            "    packet.header := struct {\n"
+            "        uint32_t magic;\n"
+            "        uint8_t uuid[16];\n"
+            "        uint32_t stream_id;\n"
+            "    };\n"
+            "};\n"
+            "\n"
+            "env {\n"
+            "    domain = \"argpar\";\n"
+            "    tracer_name = \"argpar\";\n"
+            "    hostname = \"%s\";\n"
+            "    vpid = %ld;\n"
+            "};\n"
+            "\n"
+            "clock {\n"
+            "    name = monotonic;\n"
+            "    uuid = \"%s\";\n"
+            "    freq = 1000000000;\n"
+            "    offset_s = %llu;\n"
+            "    offset = %llu;\n"
+            "    absolute = true;\n"
+            "};\n"
+            "\n"
+            "stream {\n"
+            "    id = 0;\n"
+            "    packet.context := struct {\n"
+            "        uint64_clock_monotonic_t timestamp_begin;\n"
+            "        uint64_clock_monotonic_t timestamp_end;\n"
+            "        uint64_t content_size;\n"
+            "        uint64_t packet_size;\n"
+            "    };\n"
+            "    event.header := struct {\n"
+            "        uint8_t id;\n"
+            "        uint64_clock_monotonic_t timestamp;\n"
+            "    };\n"
+            "};\n"
+            "\n"
+            "event {\n"
+            "    name = \"argpar:iter_create\";\n"
+            "    id = %d;\n"
+            "    stream_id = 0;\n"
+            "    fields := struct {\n"
+            "        uint64_hex_t iter;\n"
+            "        uint32_t argc;\n"
+            "    };\n"
+            "};\n"
+            "\n"
+            "event {\n"
+            "    name = \"argpar:iter_next\";\n"
+            "    id = %d;\n"
+            "    stream_id = 0;\n"
+            "    fields := struct {\n"
+            "        uint64_hex_t iter;\n"
+            "        status_t status;\n"
+            "        uint32_t orig_index;\n"
+            "        enum : int32_t { NONE = -1, OPT = 0, NON_OPT = 1 } item_type;\n"
+            "        int32_t descr_id;\n"
+            "    };\n"
+            "};\n"
+            "\n"
+            "event {\n"
+            "    name = \"argpar:error\";\n"
+            "    id = %d;\n"
+            "    stream_id = 0;\n"
+            "    fields := struct {\n"
+            "        uint64_hex_t iter;\n"
+            "        status_t status;\n"
+            "        uint32_t orig_index;\n"
+            "        enum : int32_t {\n"
+            "            NONE = -1, UNKNOWN_OPT = 0, MISSING_OPT_ARG = 1,\n"
+            "            UNEXPECTED_OPT_ARG = 2, INVALID_CHOICE = 3, INVALID_OPT_ARG = 4,\n"
+            "        } error_type;\n"
+            "        int32_t descr_id;\n"
+            "    };\n"
+            "};\n",
+            uuid_str, is_little_endian() ? "le" : "be", hostname, (long) getpid(), uuid_str,
+            (unsigned long long) (offset / UINT64_C(1000000000)),
+            (unsigned long long) (offset % UINT64_C(1000000000)), EVENT_CLASS_ID_ITER_CREATE,
+            EVENT_CLASS_ID_ITER_NEXT, EVENT_CLASS_ID_ERROR);
+
+    if (fclose(fp) != 0) {
+        goto error;
+    }
+
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+/* Appends the `size` bytes of `data` to the current packet of `writer` */
+static void append(argpar_ctf_writer_t * const writer, const void * const data, const size_t size)
+{
+    memcpy(&writer->packet.data[writer->packet.size], data, size);
+    writer->packet.size += size;
+}
+
+/* Appends the 32-bit value `val` to the current packet of `writer` */
+static void append_u32(argpar_ctf_writer_t * const writer, const uint32_t val)
+{
+    append(writer, &val, sizeof(val));
+}
+
+/* Appends the 64-bit value `val` to the current packet of `writer` */
+static void append_u64(argpar_ctf_writer_t * const writer, const uint64_t val)
+{
+    append(writer, &val, sizeof(val));
+}
+
+/* Starts a new, empty packet for `writer` */
+static void begin_packet(argpar_ctf_writer_t * const writer)
+{
+    writer->packet.size = 0;
+    writer->packet.ts_begin = 0;
+    writer->packet.ts_end = 0;
+    append_u32(writer, UINT32_C(0xc1fc1fc1));
+    append(writer, writer->uuid, sizeof(writer->uuid));
+    append_u32(writer, 0);
+
+    /* Packet context, set by flush_packet() */
+    writer->packet.size = PACKET_PREAMBLE_SIZE;
+}
+
+/*
+ * Completes the packet context of the current packet of `writer`,
+ * appends the packet to the data stream file, and begins a new packet.
+ */
+static void flush_packet(argpar_ctf_writer_t * const writer)
+{
+    const size_t size = writer->packet.size;
+    const uint64_t bits = (uint64_t) size * 8;
+
+    if (size == PACKET_PREAMBLE_SIZE) {
+        /* No event */
+        return;
+    }
+
+    writer->packet.size = PACKET_PREAMBLE_SIZE - 32;
+    append_u64(writer, writer->packet.ts_begin);
+    append_u64(writer, writer->packet.ts_end);
+
+    /* Content size and packet size (no padding) */
+    append_u64(writer, bits);
+    append_u64(writer, bits);
+
+    if (!writer->failed) {
+        const unsigned char *data = writer->packet.data;
+        size_t rem = size;
+
+        while (rem > 0) {
+            const ssize_t written = write(writer->fd, data, rem);
+
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                writer->failed = true;
+                writer->failed_errno = errno;
+                break;
+            }
+
+            data += written;
+            rem -= (size_t) written;
+        }
+    }
+
+    begin_packet(writer);
+}
+
+ARGPAR_HIDDEN argpar_ctf_writer_t *argpar_ctf_writer_create(const char * const dir_path)
+{
+    argpar_ctf_writer_t *writer = (argpar_ctf_writer_t *) calloc(1, sizeof(*writer));
+    char *path = NULL;
+    const size_t path_size = strlen(dir_path) + sizeof("/metadata");
+
+    if (!writer) {
+        goto error;
+    }
+
+    writer->fd = -1;
+    path = (char *) malloc(path_size);
+    if (!path) {
+        goto error;
+    }
+
+    if (mkdir(dir_path, 0755) != 0 && errno != EEXIST) {
+        goto error;
+    }
+
+    gen_uuid(writer->uuid);
+    snprintf(path, path_size, "%s/metadata", dir_path);
+    if (write_metadata(writer, path)) {
+        goto error;
+    }
+
+    snprintf(path, path_size, "%s/stream", dir_path);
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (writer->fd < 0) {
+        goto error;
+    }
+
+    begin_packet(writer);
+    goto end;
+
+error:
+    {
+        const int saved_errno = errno;
+
+        argpar_ctf_writer_destroy(writer);
+        errno = saved_errno;
+        writer = NULL;
+    }
+
+end:
+    free(path);
+    return writer;
+}
+
+ARGPAR_HIDDEN void argpar_ctf_writer_sink(const argpar_event_t * const event, void * const data)
+{
+    argpar_ctf_writer_t * const writer = (argpar_ctf_writer_t *) data;
+    const uint64_t ts = monotonic_now();
+    int32_t type = -1;
+    int32_t descr_id = -1;
+
+    if (writer->packet.size + MAX_EVENT_SIZE > PACKET_SIZE) {
+        flush_packet(writer);
+    }
+
+    if (writer->packet.size == PACKET_PREAMBLE_SIZE) {
+        writer->packet.ts_begin = ts;
+    }
+
+    writer->packet.ts_end = ts;
+
+    switch (event->type) {
+    case ARGPAR_EVENT_TYPE_ITER_CREATE:
+    {
+        const unsigned char id = EVENT_CLASS_ID_ITER_CREATE;
+
+        append(writer, &id, 1);
+        append_u64(writer, ts);
+        append_u64(writer, (uint64_t) (uintptr_t) event->iter);
+        append_u32(writer, event->argc);
+        return;
+    }
+    case ARGPAR_EVENT_TYPE_ITER_NEXT:
+    {
+        const unsigned char id = EVENT_CLASS_ID_ITER_NEXT;
+
+        if (event->item) {
+            type = (int32_t) argpar_item_type(event->item);
+
+            if (type == ARGPAR_ITEM_TYPE_OPT) {
+                descr_id = argpar_item_opt_descr(event->item)->id;
+            }
+        }
+
+        append(writer, &id, 1);
+        break;
+    }
+    case ARGPAR_EVENT_TYPE_ERROR:
+    {
+        const unsigned char id = EVENT_CLASS_ID_ERROR;
+
+        if (event->error) {
+            type = (int32_t) argpar_error_type(event->error);
+
+            if (type != ARGPAR_ERROR_TYPE_UNKNOWN_OPT) {
+                descr_id = argpar_error_opt_descr(event->error, NULL)->id;
+            }
+        }
+
+        append(writer, &id, 1);
+        break;
+    }
+    default:
+        abort();
+    }
+
+    /* `argpar:iter_next` and `argpar:error` have the same layout */
+    append_u64(writer, ts);
+    append_u64(writer, (uint64_t) (uintptr_t) event->iter);
+    append_u32(writer, (uint32_t) (int32_t) event->status);
+    append_u32(writer, event->orig_index);
+    append_u32(writer, (uint32_t) type);
+    append_u32(writer, (uint32_t) descr_id);
+}
+
+ARGPAR_HIDDEN int argpar_ctf_writer_destroy(argpar_ctf_writer_t * const writer)
+{
+    int ret = 0;
+
+    if (!writer) {
+        goto end;
+    }
+
+    if (writer->fd >= 0) {
+        flush_packet(writer);
+
+        if (close(writer->fd) != 0 && !writer->failed) {
+            writer->failed = true;
+            writer->failed_errno = errno;
+        }
+    }
+
+    if (writer->failed) {
+        errno = writer->failed_errno;
+        ret = -1;
+    }
+
+    free(writer);
+
+end:
+    return ret;
+}
@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+#ifndef ARGPAR_ARGPAR_CTF_H
+#define ARGPAR_ARGPAR_CTF_H
+
+#include "argpar.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*!
+@file
+
+CTF trace event sink.
+
+This optional companion of argpar (<code>argpar/argpar-ctf.c</code>
+and <code>argpar/argpar-ctf.h</code>, which require a POSIX system)
+writes the events of argument parsing iterators (see
+argpar_iter_set_event_sink()) into a
+<a href="https://diamon.org/ctf/v1.8.3/">CTF&nbsp;1.8</a> trace
+directory which tools such as
+<a href="https://babeltrace.org/">Babeltrace&nbsp;2</a> can read.
+
+The trace directory contains:
+
+<dl>
+  <dt>\c metadata</dt>
+  <dd>TSDL metadata.</dd>
+
+  <dt>\c stream</dt>
+  <dd>Single binary data stream.</dd>
+</dl>
+
+The event classes are:
+
+<dl>
+  <dt>\c argpar:iter_create</dt>
+  <dd>#ARGPAR_EVENT_TYPE_ITER_CREATE event.</dd>
+
+  <dt>\c argpar:iter_next</dt>
+  <dd>#ARGPAR_EVENT_TYPE_ITER_NEXT event.</dd>
+
+  <dt>\c argpar:error</dt>
+  <dd>#ARGPAR_EVENT_TYPE_ERROR event.</dd>
+</dl>
+
+All the events have the iterator address (\c iter field), and the
+timestamp of each event is the value of the monotonic clock, with an
+offset to make it absolute, so that you can correlate the traces of
+distinct processes.
+
+The writer appends the events to an in-memory packet, appending the
+packet to the data stream file when it's full: the cost of an event is
+mostly the clock reading.
+
+Example:
+
+@code
+argpar_ctf_writer_t *writer = argpar_ctf_writer_create("/tmp/my-trace");
+argpar_iter_t *iter = argpar_iter_create(argc, argv, descrs);
+
+argpar_iter_set_event_sink(iter, argpar_ctf_writer_sink, writer);
+
+// Use argpar_iter_next()...
+
+argpar_iter_destroy(iter);
+argpar_ctf_writer_destroy(writer);
+@endcode
+*/
+
+/*!
+@struct argpar_ctf_writer
+
+@brief
+    Opaque CTF trace writer type.
+*/
+typedef struct argpar_ctf_writer argpar_ctf_writer_t;
+
+/*!
+@brief
+    Creates and returns a CTF trace writer which writes into the
+    directory \p dir_path.
+
+This function creates \p dir_path if it doesn't exist, and replaces
+any existing \c metadata and \c stream file within it: use a distinct
+directory per process.
+
+@param[in] dir_path
+    Path of the trace directory.
+
+@returns
+    New CTF trace writer, or \c NULL on error (\c errno is set).
+
+@pre
+    \p dir_path is not \c NULL.
+*/
+argpar_ctf_writer_t *argpar_ctf_writer_create(const char *dir_path) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Event sink function which writes \p event into the CTF trace writer
+    \p data.
+
+Pass this function and a CTF trace writer to
+argpar_iter_set_event_sink().
+
+@param[in] event
+    Event to write.
+@param[in] data
+    CTF trace writer (#argpar_ctf_writer_t).
+
+@pre
+    \p data is a CTF trace writer.
+*/
+void argpar_ctf_writer_sink(const argpar_event_t *event, void *data) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Writes the pending events of the CTF trace writer \p writer and
+    destroys it.
+
+@param[in] writer
+    CTF trace writer to destroy (may be \c NULL).
+
+@returns
+    0 on success, or -1 if any write failed since the creation of
+    \p writer (\c errno is set).
+*/
+int argpar_ctf_writer_destroy(argpar_ctf_writer_t *writer) ARGPAR_NOEXCEPT;
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* ARGPAR_ARGPAR_CTF_H */
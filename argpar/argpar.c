@@ -4,7 +4,11 @@
  * SPDX-FileCopyrightText: 2020-2024 Simon Marchi <simon.marchi@efficios.com>
  */
 
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -24,11 +28,19 @@
 #    define ARGPAR_HIDDEN __attribute__((visibility("hidden")))
 #endif
 
-#define ARGPAR_REALLOC(_ptr, _type, _nmemb) ((_type *) realloc(_ptr, (_nmemb) * sizeof(_type)))
+/*
+ * Allocation macros: `_allocator` is a user allocator (see
+ * argpar_allocator_t), or `NULL` to use the C library.
+ */
+#define ARGPAR_REALLOC(_allocator, _ptr, _type, _nmemb)                                            \
+    ((_type *) alloc_realloc((_allocator), (_ptr), (_nmemb) * sizeof(_type)))
 
-#define ARGPAR_CALLOC(_type, _nmemb) ((_type *) calloc((_nmemb), sizeof(_type)))
+#define ARGPAR_CALLOC(_allocator, _type, _nmemb)                                                   \
+    ((_type *) alloc_calloc((_allocator), (_nmemb), sizeof(_type)))
 
-#define ARGPAR_ZALLOC(_type) ARGPAR_CALLOC(_type, 1)
+#define ARGPAR_ZALLOC(_allocator, _type) ARGPAR_CALLOC(_allocator, _type, 1)
+
+#define ARGPAR_FREE(_allocator, _ptr) alloc_free((_allocator), (void *) (_ptr))
 
 #ifdef NDEBUG
 /*
@@ -42,53 +54,185 @@
 #endif
 
 /*
- * An argpar iterator.
+ * Reallocates `ptr` to `size` bytes with `allocator`, or with the C
+ * library if `allocator` is `NULL`.
+ */
+static void *alloc_realloc(const argpar_allocator_t * const allocator, void * const ptr,
+                           const size_t size)
+{
+    return allocator ? allocator->realloc_func(ptr, size, allocator->data) : realloc(ptr, size);
+}
+
+/*
+ * Allocates `nmemb` zeroed elements of `size` bytes with `allocator`,
+ * or with the C library if `allocator` is `NULL`.
+ */
+static void *alloc_calloc(const argpar_allocator_t * const allocator, const size_t nmemb,
+                          const size_t size)
+{
+    void *ptr;
+
+    if (!allocator) {
+        return calloc(nmemb, size);
+    }
+
+    if (size != 0 && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    ptr = allocator->realloc_func(NULL, nmemb * size, allocator->data);
+    if (ptr) {
+        memset(ptr, 0, nmemb * size);
+    }
+
+    return ptr;
+}
+
+/*
+ * Frees `ptr` (may be `NULL`) with `allocator`, or with the C library
+ * if `allocator` is `NULL`.
+ */
+static void alloc_free(const argpar_allocator_t * const allocator, void * const ptr)
+{
+    if (!allocator) {
+        free(ptr);
+    } else if (ptr) {
+        allocator->free_func(ptr, allocator->data);
+    }
+}
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+#    if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#        define ARGPAR_HISTOGRAM_UNIT "cycles"
+
+/* Returns the current value of the time-stamp counter */
+static unsigned long long histogram_now(void)
+{
+    return __builtin_ia32_rdtsc();
+}
+#    else
+#        include <time.h>
+#        define ARGPAR_HISTOGRAM_UNIT "ns"
+
+/* Returns the current value of the monotonic clock (ns) */
+static unsigned long long histogram_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + (unsigned long long) ts.tv_nsec;
+}
+#    endif
+#endif
+
+/*
+ * Open addressing hash table of the choices of an option descriptor.
  *
- * Such a structure contains the state of an iterator between calls to
- * argpar_iter_next().
+ * The first slot to probe for a choice is `choice_hash(choice) & mask`,
+ * and the following ones are consecutive. At most half of the slots are
+ * used so that a probe sequence is short and always reaches an empty
+ * slot.
  */
-struct argpar_iter
+struct choice_table
+{
+    /* Slot count minus one (slot count is a power of two) */
+    unsigned int mask;
+
+    /* Choice index per slot, or -1 for an empty slot */
+    const int *slots;
+};
+
+/*
+ * Compiled option descriptor set: an option descriptor array with its
+ * choice tables and, for a namespace, its long name hash table.
+ */
+struct descr_set
 {
+    /* Option descriptors (not owned) */
+    const argpar_opt_descr_t *descrs;
+
+    /* Number of option descriptors, excluding the sentinel */
+    unsigned int count;
+
     /*
-     * Data provided by the user to argpar_iter_create(); immutable
-     * afterwards.
+     * Choice tables, indexed like `descrs` (`slots` is `NULL` for a
+     * descriptor without choices), or `NULL` if no descriptor has
+     * choices.
      */
-    struct
-    {
-        unsigned int argc;
-        const char * const *argv;
-        const argpar_opt_descr_t *descrs;
-    } user;
+    struct choice_table *choice_tables;
+
+    /* Namespace prefix (not owned), or `NULL` for the main set */
+    const char *ns;
+
+    /* Length of `ns` */
+    size_t ns_len;
 
     /*
-     * Index of the argument to process in the next
-     * argpar_iter_next() call.
+     * Lookup strategy of find_set_descr() (main set only, never
+     * `ARGPAR_LOOKUP_STRATEGY_AUTO`).
      */
-    unsigned int i;
+    argpar_lookup_strategy_t strategy;
 
-    /* Counter of non-option arguments */
-    int non_opt_index;
+    /*
+     * Long name hash table (namespace, or `ARGPAR_LOOKUP_STRATEGY_HASH`
+     * main set): descriptor index per slot, or -1 for an empty slot,
+     * using linear probing.
+     */
+    const int *long_name_slots;
+
+    /* Slot count of `long_name_slots` minus one */
+    unsigned int long_name_mask;
 
     /*
-     * Current character within the current short option group: if
-     * it's not `NULL`, the parser is within a short option group,
-     * therefore it must resume there in the next argpar_iter_next()
-     * call.
+     * Short name table (`ARGPAR_LOOKUP_STRATEGY_HASH` main set only):
+     * index of the first descriptor having a given short name per
+     * character, or -1.
+     *
+     * For a set which owns its tables, this table shares the allocation
+     * of `long_name_slots`.
      */
-    const char *short_opt_group_ch;
+    const int *short_name_slots;
 
-    /* Temporary character buffer which only grows */
+    /*
+     * Descriptor image of which this set borrows the descriptors and
+     * all the tables, or `NULL` if this set owns its tables.
+     */
+    const argpar_descr_image_t *image;
+
+    /*
+     * Fingerprints of `descrs`, indexed like `descrs`, to reject most
+     * candidates without touching the descriptors
+     * (`ARGPAR_LOOKUP_STRATEGY_FINGERPRINT` main set only), or all
+     * `NULL`.
+     *
+     * The three arrays share the allocation of `long_name_prefixes`.
+     */
     struct
     {
-        size_t size;
-        char *data;
-    } tmp_buf;
+        /* First eight bytes of the long name, zero-padded, or 0 */
+        const uint64_t *long_name_prefixes;
+
+        /* Length of the long name, or `UINT_MAX` without long name */
+        const unsigned int *long_name_lens;
+
+        /* Short name, or `'\0'` */
+        const char *short_names;
+    } fingerprints;
+
+    /* Allocator of the tables, or `NULL` for the C library */
+    const argpar_allocator_t *allocator;
 };
 
 /* Base parsing item */
 struct argpar_item
 {
     argpar_item_type_t type;
+
+    /*
+     * Allocator of this item, or `NULL` for the C library (only
+     * meaningful for an item which argpar_iter_next() creates).
+     */
+    const argpar_allocator_t *allocator;
 };
 
 /* Option parsing item */
@@ -99,8 +243,26 @@ typedef struct argpar_item_opt
     /* Corresponding descriptor */
     const argpar_opt_descr_t *descr;
 
-    /* Argument, or `NULL` if none; owned by this */
-    char *arg;
+    /*
+     * Argument, or `NULL` if none, pointing within one of the entries
+     * of the original arguments (`argv`).
+     */
+    const char *arg;
+
+    /* `true` if this is the `--no-NAME` form of the option */
+    bool negated;
+
+    /* Index of the choice of the argument, or -1 if not applicable */
+    int choice;
+
+    /* Index of the original argument of this option (`argv`) */
+    unsigned int orig_index;
+
+    /* `true` if this is a short option */
+    bool is_short;
+
+    /* Namespace prefix of the descriptor, or `NULL` if none */
+    const char *ns;
 } argpar_item_opt_t;
 
 /* Non-option parsing item */
@@ -124,6 +286,30 @@ typedef struct argpar_item_non_opt
     unsigned int non_opt_index;
 } argpar_item_non_opt_t;
 
+/* Number of entries of the lookup cache of an iterator */
+#define LOOKUP_CACHE_SIZE 8
+
+/* Entry of the lookup cache of an iterator (see find_iter_descr()) */
+struct lookup_cache_entry
+{
+    /* Option descriptor which a lookup found */
+    const argpar_opt_descr_t *descr;
+
+    /* Hash of the looked up long name (long name lookup only) */
+    unsigned int long_name_hash;
+
+    /* Looked up short name, or `'\0'` for a long name lookup */
+    char short_name;
+};
+
+/* Storage for any parsing item */
+typedef union argpar_item_storage
+{
+    argpar_item_t base;
+    argpar_item_opt_t opt;
+    argpar_item_non_opt_t non_opt;
+} argpar_item_storage_t;
+
 /* Parsing error */
 struct argpar_error
 {
@@ -133,14 +319,151 @@ struct argpar_error
     /* Original argument index */
     unsigned int orig_index;
 
-    /* Name of unknown option; owned by this */
-    char *unknown_opt_name;
+    /* Allocator of this error, or `NULL` for the C library */
+    const argpar_allocator_t *allocator;
+
+    /*
+     * Name of unknown option, with its prefix: within the memory block
+     * of this error for an error which dup_error() creates, or within
+     * the temporary buffer of the iterator for a borrowed error.
+     */
+    const char *unknown_opt_name;
+
+    /* Name of unknown option, without its prefix, within `argv` */
+    argpar_slice_t unknown_opt_name_slice;
 
     /* Option descriptor */
     const argpar_opt_descr_t *opt_descr;
 
     /* `true` if a short option caused the error */
     bool is_short;
+
+    /* Invalid option argument (within `argv`) */
+    const char *invalid_opt_arg;
+
+    /* Suggested choice for `invalid_opt_arg`, or `NULL` */
+    const char *invalid_choice_suggestion;
+};
+
+/*
+ * An argpar iterator.
+ *
+ * Such a structure contains the state of an iterator between calls to
+ * argpar_iter_next().
+ */
+struct argpar_iter
+{
+    /*
+     * Data provided by the user to argpar_iter_create(); immutable
+     * afterwards.
+     */
+    struct
+    {
+        unsigned int argc;
+        const char * const *argv;
+        const argpar_opt_descr_t *descrs;
+    } user;
+
+    /* User allocator, or `NULL` for the C library */
+    const argpar_allocator_t *allocator;
+
+    /*
+     * Index of the argument to process in the next
+     * argpar_iter_next() call.
+     */
+    unsigned int i;
+
+    /* Counter of non-option arguments */
+    int non_opt_index;
+
+    /*
+     * Current character within the current short option group: if
+     * it's not `NULL`, the parser is within a short option group,
+     * therefore it must resume there in the next argpar_iter_next()
+     * call.
+     */
+    const char *short_opt_group_ch;
+
+    /* Temporary character buffer which only grows */
+    struct
+    {
+        size_t size;
+        char *data;
+    } tmp_buf;
+
+    /* Compiled set of `user.descrs` */
+    struct descr_set descr_set;
+
+    /* Namespaces (see argpar_iter_add_namespace()) */
+    struct
+    {
+        /* Compiled descriptor set of each namespace */
+        struct descr_set *sets;
+
+        /* Number of elements of `sets` */
+        unsigned int count;
+
+        /* Capacity of `sets` */
+        unsigned int capacity;
+
+        /*
+         * Prefix hash table: index within `sets` per slot, or -1 for
+         * an empty slot, using linear probing.
+         */
+        int *slots;
+
+        /* Slot count of `slots` minus one */
+        unsigned int mask;
+    } namespaces;
+
+    /*
+     * Flag sink (see argpar_iter_set_flag_sink()): if either member
+     * isn't `NULL`, iter_next() records the options without an
+     * argument instead of producing items for them.
+     */
+    struct
+    {
+        unsigned char *bitset;
+        unsigned int *counters;
+    } flag_sink;
+
+    /*
+     * `true` to stop at the first non-option argument (see
+     * argpar_iter_set_stop_at_non_opt()).
+     */
+    bool stop_at_non_opt;
+
+    /* `true` if stopped at the first non-option argument */
+    bool stopped_at_non_opt;
+
+    /*
+     * Lookup cache (see argpar_iter_set_lookup_cache()): most recently
+     * used entry first.
+     */
+    struct
+    {
+        bool enabled;
+        unsigned int count;
+        struct lookup_cache_entry entries[LOOKUP_CACHE_SIZE];
+    } lookup_cache;
+
+    /* Last item of argpar_iter_borrow_next() */
+    argpar_item_storage_t borrowed_item;
+
+    /* Last error of argpar_iter_borrow_next() */
+    struct argpar_error borrowed_error;
+
+    /* Event sink (see argpar_iter_set_event_sink()) */
+    struct
+    {
+        argpar_event_sink_func_t func;
+        void *data;
+    } event_sink;
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    /* Latency histogram of argpar_iter_next() calls */
+    argpar_histogram_t histogram;
+#endif
 };
 
 ARGPAR_HIDDEN argpar_item_type_t argpar_item_type(const argpar_item_t * const item)
@@ -163,160 +486,250 @@ ARGPAR_HIDDEN const char *argpar_item_opt_arg(const argpar_item_t * const item)
     return ((const argpar_item_opt_t *) item)->arg;
 }
 
-ARGPAR_HIDDEN const char *argpar_item_non_opt_arg(const argpar_item_t * const item)
+ARGPAR_HIDDEN bool argpar_item_opt_is_negated(const argpar_item_t * const item)
 {
     ARGPAR_ASSERT(item);
-    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_NON_OPT);
-    return ((const argpar_item_non_opt_t *) item)->arg;
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_OPT);
+    return ((const argpar_item_opt_t *) item)->negated;
 }
 
-ARGPAR_HIDDEN unsigned int argpar_item_non_opt_orig_index(const argpar_item_t * const item)
+ARGPAR_HIDDEN const char *argpar_item_opt_namespace(const argpar_item_t * const item)
 {
     ARGPAR_ASSERT(item);
-    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_NON_OPT);
-    return ((const argpar_item_non_opt_t *) item)->orig_index;
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_OPT);
+    return ((const argpar_item_opt_t *) item)->ns;
 }
 
-ARGPAR_HIDDEN unsigned int argpar_item_non_opt_non_opt_index(const argpar_item_t * const item)
+ARGPAR_HIDDEN unsigned int argpar_item_opt_choice(const argpar_item_t * const item)
 {
+    const argpar_item_opt_t * const opt_item = (const argpar_item_opt_t *) item;
+
     ARGPAR_ASSERT(item);
-    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_NON_OPT);
-    return ((const argpar_item_non_opt_t *) item)->non_opt_index;
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_OPT);
+    ARGPAR_ASSERT(opt_item->descr->choices);
+    ARGPAR_ASSERT(opt_item->choice >= 0);
+    return (unsigned int) opt_item->choice;
 }
 
-ARGPAR_HIDDEN void argpar_item_destroy(const argpar_item_t * const item)
+/*
+ * Returns the end of the list argument element which starts at `elem`,
+ * that is, the position of the first unescaped list delimiter `delim`
+ * or of the terminating null character.
+ */
+static const char *find_list_elem_end(const char *elem, const char delim, const char escape_ch)
 {
-    if (!item) {
-        goto end;
-    }
-
-    if (item->type == ARGPAR_ITEM_TYPE_OPT) {
-        argpar_item_opt_t * const opt_item = (argpar_item_opt_t *) item;
+    while (*elem && *elem != delim) {
+        if (escape_ch && *elem == escape_ch && elem[1]) {
+            /* Skip escaped character */
+            elem++;
+        }
 
-        free(opt_item->arg);
+        elem++;
     }
 
-    free((void *) item);
-
-end:
-    return;
+    return elem;
 }
 
-/*
- * Creates and returns an option parsing item for the descriptor `descr`
- * and having the argument `arg` (copied; may be `NULL`).
- *
- * Returns `NULL` on memory error.
- */
-static argpar_item_opt_t *create_opt_item(const argpar_opt_descr_t * const descr,
-                                          const char * const arg)
+ARGPAR_HIDDEN unsigned int argpar_item_opt_arg_list_count(const argpar_item_t * const item)
 {
-    argpar_item_opt_t *opt_item = ARGPAR_ZALLOC(argpar_item_opt_t);
-
-    if (!opt_item) {
-        goto end;
-    }
+    const argpar_item_opt_t * const opt_item = (const argpar_item_opt_t *) item;
+    argpar_list_iter_t iter;
+    argpar_slice_t elem;
+    unsigned int count = 0;
 
-    opt_item->base.type = ARGPAR_ITEM_TYPE_OPT;
-    opt_item->descr = descr;
+    ARGPAR_ASSERT(item);
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_OPT);
+    ARGPAR_ASSERT(opt_item->descr->list_delim);
+    ARGPAR_ASSERT(opt_item->arg);
+    argpar_item_opt_arg_list_iter_init(item, &iter);
 
-    if (arg) {
-        opt_item->arg = strdup(arg);
-        if (!opt_item->arg) {
-            goto error;
-        }
+    while (argpar_list_iter_next(&iter, &elem)) {
+        count++;
     }
 
-    goto end;
+    return count;
+}
 
-error:
-    argpar_item_destroy(&opt_item->base);
-    opt_item = NULL;
+ARGPAR_HIDDEN void argpar_item_opt_arg_list_iter_init(const argpar_item_t * const item,
+                                                      argpar_list_iter_t * const iter)
+{
+    const argpar_item_opt_t * const opt_item = (const argpar_item_opt_t *) item;
 
-end:
-    return opt_item;
+    ARGPAR_ASSERT(item);
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_OPT);
+    ARGPAR_ASSERT(opt_item->descr->list_delim);
+    ARGPAR_ASSERT(opt_item->arg);
+    ARGPAR_ASSERT(iter);
+
+    /* An empty argument has no elements */
+    iter->pos = opt_item->arg[0] ? opt_item->arg : NULL;
+    iter->delim = opt_item->descr->list_delim;
+    iter->escape_ch = opt_item->descr->list_escape;
 }
 
-/*
- * Creates and returns a non-option parsing item for the original
- * argument `arg` having the original index `orig_index` and the
- * non-option index `non_opt_index`.
- *
- * Returns `NULL` on memory error.
- */
-static argpar_item_non_opt_t *create_non_opt_item(const char * const arg,
-                                                  const unsigned int orig_index,
-                                                  const unsigned int non_opt_index)
+ARGPAR_HIDDEN bool argpar_list_iter_next(argpar_list_iter_t * const iter,
+                                         argpar_slice_t * const elem)
 {
-    argpar_item_non_opt_t * const non_opt_item = ARGPAR_ZALLOC(argpar_item_non_opt_t);
+    bool ret = false;
+    const char *elem_end;
 
-    if (!non_opt_item) {
+    ARGPAR_ASSERT(iter);
+    ARGPAR_ASSERT(elem);
+
+    if (!iter->pos) {
         goto end;
     }
 
-    non_opt_item->base.type = ARGPAR_ITEM_TYPE_NON_OPT;
-    non_opt_item->arg = arg;
-    non_opt_item->orig_index = orig_index;
-    non_opt_item->non_opt_index = non_opt_index;
+    elem_end = find_list_elem_end(iter->pos, iter->delim, iter->escape_ch);
+    elem->ptr = iter->pos;
+    elem->len = elem_end - iter->pos;
+    iter->pos = *elem_end ? elem_end + 1 : NULL;
+    ret = true;
 
 end:
-    return non_opt_item;
+    return ret;
 }
 
-/*
- * If `error` is not `NULL`, sets the error `error` to a new parsing
- * error object, setting its `unknown_opt_name`, `opt_descr`, and
- * `is_short` members from the parameters.
- *
- * `unknown_opt_name` is the unknown option name without any `-` or `--`
- * prefix: `is_short` controls which type of unknown option it is.
- *
- * Returns 0 on success (including if `error` is `NULL`) or -1 on memory
- * error.
- */
-static int set_error(argpar_error_t ** const error, argpar_error_type_t type,
-                     const char * const unknown_opt_name,
-                     const argpar_opt_descr_t * const opt_descr, const bool is_short)
+ARGPAR_HIDDEN const char *argpar_item_non_opt_arg(const argpar_item_t * const item)
 {
-    int ret = 0;
+    ARGPAR_ASSERT(item);
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_NON_OPT);
+    return ((const argpar_item_non_opt_t *) item)->arg;
+}
 
-    if (!error) {
-        goto end;
-    }
+ARGPAR_HIDDEN unsigned int argpar_item_non_opt_orig_index(const argpar_item_t * const item)
+{
+    ARGPAR_ASSERT(item);
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_NON_OPT);
+    return ((const argpar_item_non_opt_t *) item)->orig_index;
+}
 
-    *error = ARGPAR_ZALLOC(argpar_error_t);
-    if (!*error) {
-        goto error;
+ARGPAR_HIDDEN unsigned int argpar_item_non_opt_non_opt_index(const argpar_item_t * const item)
+{
+    ARGPAR_ASSERT(item);
+    ARGPAR_ASSERT(item->type == ARGPAR_ITEM_TYPE_NON_OPT);
+    return ((const argpar_item_non_opt_t *) item)->non_opt_index;
+}
+
+ARGPAR_HIDDEN void argpar_item_destroy(const argpar_item_t * const item)
+{
+    if (item) {
+        ARGPAR_FREE(item->allocator, item);
     }
+}
 
-    (*error)->type = type;
+/*
+ * Initializes the option parsing item `opt_item` for the descriptor
+ * `descr` and having the argument `arg` (not copied; may be `NULL`).
+ *
+ * `negated` indicates whether or not it's the `--no-NAME` form of the
+ * option.
+ *
+ * `choice` is the index of the choice of `arg`, or -1 if `descr` has
+ * no choices.
+ *
+ * `orig_index` is the index of the original argument of the option and
+ * `is_short` indicates whether or not it's a short option.
+ */
+static void init_opt_item(argpar_item_opt_t * const opt_item,
+                          const argpar_opt_descr_t * const descr, const char * const arg,
+                          const bool negated, const int choice, const unsigned int orig_index,
+                          const bool is_short)
+{
+    memset(opt_item, 0, sizeof(*opt_item));
+    opt_item->base.type = ARGPAR_ITEM_TYPE_OPT;
+    opt_item->descr = descr;
+    opt_item->arg = arg;
+    opt_item->negated = negated;
+    opt_item->choice = choice;
+    opt_item->orig_index = orig_index;
+    opt_item->is_short = is_short;
+}
 
-    if (unknown_opt_name) {
-        (*error)->unknown_opt_name =
-            ARGPAR_CALLOC(char, strlen(unknown_opt_name) + 1 + (is_short ? 1 : 2));
-        if (!(*error)->unknown_opt_name) {
-            goto error;
-        }
+/*
+ * Initializes the non-option parsing item `non_opt_item` for the
+ * original argument `arg` having the original index `orig_index` and
+ * the non-option index `non_opt_index`.
+ */
+static void init_non_opt_item(argpar_item_non_opt_t * const non_opt_item, const char * const arg,
+                              const unsigned int orig_index, const unsigned int non_opt_index)
+{
+    non_opt_item->base.type = ARGPAR_ITEM_TYPE_NON_OPT;
+    non_opt_item->arg = arg;
+    non_opt_item->orig_index = orig_index;
+    non_opt_item->non_opt_index = non_opt_index;
+}
 
-        if (is_short) {
-            strcpy((*error)->unknown_opt_name, "-");
-        } else {
-            strcpy((*error)->unknown_opt_name, "--");
-        }
+/*
+ * Creates and returns a copy of the parsing item `item`, allocated
+ * with `allocator`.
+ *
+ * Returns `NULL` on memory error.
+ */
+static argpar_item_t *dup_item(const argpar_allocator_t * const allocator,
+                               const argpar_item_storage_t * const item)
+{
+    const size_t size = item->base.type == ARGPAR_ITEM_TYPE_OPT ? sizeof(argpar_item_opt_t) :
+                                                                  sizeof(argpar_item_non_opt_t);
+    argpar_item_t * const new_item = (argpar_item_t *) alloc_realloc(allocator, NULL, size);
 
-        strcat((*error)->unknown_opt_name, unknown_opt_name);
+    if (new_item) {
+        memcpy(new_item, item, size);
+        new_item->allocator = allocator;
     }
 
-    (*error)->opt_descr = opt_descr;
-    (*error)->is_short = is_short;
-    goto end;
+    return new_item;
+}
 
-error:
-    argpar_error_destroy(*error);
-    ret = -1;
+/*
+ * Sets the pending error `*error` (see complete_error() and
+ * dup_error()), setting its `unknown_opt_name_slice`, `opt_descr`, and
+ * `is_short` members from the parameters.
+ *
+ * This function never allocates memory: an iterator only completes and
+ * copies a pending error for a caller which wants it.
+ *
+ * `unknown_opt_name` is the unknown option name (`unknown_opt_name_len`
+ * characters) without any `-` or `--` prefix, within the original
+ * arguments: `is_short` controls which type of unknown option it is.
+ */
+static void set_error(argpar_error_t * const error, const argpar_error_type_t type,
+                      const char * const unknown_opt_name, const size_t unknown_opt_name_len,
+                      const argpar_opt_descr_t * const opt_descr, const bool is_short)
+{
+    memset(error, 0, sizeof(*error));
+    error->type = type;
+    error->unknown_opt_name_slice.ptr = unknown_opt_name;
+    error->unknown_opt_name_slice.len = unknown_opt_name_len;
+    error->opt_descr = opt_descr;
+    error->is_short = is_short;
+}
 
-end:
-    return ret;
+/*
+ * Returns a copy of the completed pending error `error`, allocated with
+ * `allocator` within a single memory block (including its unknown
+ * option name, if any), or `NULL` on memory error.
+ */
+static argpar_error_t *dup_error(const argpar_allocator_t * const allocator,
+                                 const argpar_error_t * const error)
+{
+    const size_t name_size = error->unknown_opt_name ? strlen(error->unknown_opt_name) + 1 : 0;
+    argpar_error_t * const new_error =
+        alloc_realloc(allocator, NULL, sizeof(*new_error) + name_size);
+
+    if (new_error) {
+        *new_error = *error;
+        new_error->allocator = allocator;
+
+        if (name_size > 0) {
+            char * const name = (char *) (new_error + 1);
+
+            memcpy(name, error->unknown_opt_name, name_size);
+            new_error->unknown_opt_name = name;
+        }
+    }
+
+    return new_error;
 }
 
 ARGPAR_HIDDEN argpar_error_type_t argpar_error_type(const argpar_error_t * const error)
@@ -344,7 +757,9 @@ ARGPAR_HIDDEN const argpar_opt_descr_t *argpar_error_opt_descr(const argpar_erro
 {
     ARGPAR_ASSERT(error);
     ARGPAR_ASSERT(error->type == ARGPAR_ERROR_TYPE_MISSING_OPT_ARG ||
-                  error->type == ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG);
+                  error->type == ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG ||
+                  error->type == ARGPAR_ERROR_TYPE_INVALID_CHOICE ||
+                  error->type == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG);
     ARGPAR_ASSERT(error->opt_descr);
 
     if (is_short) {
@@ -354,11 +769,46 @@ ARGPAR_HIDDEN const argpar_opt_descr_t *argpar_error_opt_descr(const argpar_erro
     return error->opt_descr;
 }
 
+ARGPAR_HIDDEN const char *argpar_error_invalid_choice_arg(const argpar_error_t * const error)
+{
+    ARGPAR_ASSERT(error);
+    ARGPAR_ASSERT(error->type == ARGPAR_ERROR_TYPE_INVALID_CHOICE);
+    return error->invalid_opt_arg;
+}
+
+ARGPAR_HIDDEN argpar_slice_t argpar_error_unknown_opt_name_slice(const argpar_error_t * const error,
+                                                                 bool * const is_short)
+{
+    ARGPAR_ASSERT(error);
+    ARGPAR_ASSERT(error->type == ARGPAR_ERROR_TYPE_UNKNOWN_OPT);
+
+    if (is_short) {
+        *is_short = error->is_short;
+    }
+
+    return error->unknown_opt_name_slice;
+}
+
+ARGPAR_HIDDEN const char *argpar_error_invalid_opt_arg(const argpar_error_t * const error)
+{
+    ARGPAR_ASSERT(error);
+    ARGPAR_ASSERT(error->type == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG ||
+                  error->type == ARGPAR_ERROR_TYPE_INVALID_CHOICE);
+    return error->invalid_opt_arg;
+}
+
+ARGPAR_HIDDEN const char *argpar_error_invalid_choice_suggestion(const argpar_error_t * const error)
+{
+    ARGPAR_ASSERT(error);
+    ARGPAR_ASSERT(error->type == ARGPAR_ERROR_TYPE_INVALID_CHOICE);
+    return error->invalid_choice_suggestion;
+}
+
 ARGPAR_HIDDEN void argpar_error_destroy(const argpar_error_t * const error)
 {
+    /* Unknown option name within the same memory block */
     if (error) {
-        free(error->unknown_opt_name);
-        free((void *) error);
+        ARGPAR_FREE(error->allocator, error);
     }
 }
 
@@ -392,358 +842,4009 @@ end:
     return !descr->short_name && !descr->long_name ? NULL : descr;
 }
 
-/* Return type of parse_short_opt_group() and parse_long_opt() */
-typedef enum parse_orig_arg_opt_ret
+/*
+ * Returns the 32-bit FNV-1a hash of the `len` first characters of
+ * `str`.
+ */
+static unsigned int slice_hash(const char * const str, const size_t len)
 {
-    PARSE_ORIG_ARG_OPT_RET_OK,
-    PARSE_ORIG_ARG_OPT_RET_ERROR = -1,
-    PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY = -2,
-} parse_orig_arg_opt_ret_t;
+    unsigned int hash = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (unsigned char) str[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
 
 /*
- * Parses the short option group argument `short_opt_group`, starting
- * where needed depending on the state of `iter`.
- *
- * On success, sets `*item`.
+ * Returns the first option descriptor of the descriptor set `set`,
+ * which has a long name hash table, having the long name `long_name`,
+ * or `NULL` if not found.
  *
- * On error (except for `PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY`), sets
- * `*error`.
+ * This function probes at most all the slots of the long name hash
+ * table, even if it has no empty slot.
  */
-static parse_orig_arg_opt_ret_t
-parse_short_opt_group(const char * const short_opt_group, const char * const next_orig_arg,
-                      const argpar_opt_descr_t * const descrs, argpar_iter_t * const iter,
-                      argpar_error_t ** const error, argpar_item_t ** const item)
+static const argpar_opt_descr_t *find_long_name_descr(const struct descr_set * const set,
+                                                      const char * const long_name)
 {
-    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
-    bool used_next_orig_arg = false;
-    const char *opt_arg = NULL;
-    const argpar_opt_descr_t *descr;
-    argpar_item_opt_t *opt_item;
+    const argpar_opt_descr_t *descr = NULL;
+    unsigned int slot = slice_hash(long_name, strlen(long_name)) & set->long_name_mask;
+    unsigned int i;
 
-    ARGPAR_ASSERT(strlen(short_opt_group) != 0);
+    for (i = 0; i <= set->long_name_mask && set->long_name_slots[slot] >= 0;
+         i++, slot = (slot + 1) & set->long_name_mask) {
+        const argpar_opt_descr_t * const cand = &set->descrs[set->long_name_slots[slot]];
 
-    if (!iter->short_opt_group_ch) {
-        iter->short_opt_group_ch = short_opt_group;
+        if (strcmp(cand->long_name, long_name) == 0) {
+            descr = cand;
+            break;
+        }
     }
 
-    /* Find corresponding option descriptor */
-    descr = find_descr(descrs, *iter->short_opt_group_ch, NULL);
-    if (!descr) {
-        const char unknown_opt_name[] = {*iter->short_opt_group_ch, '\0'};
+    return descr;
+}
 
-        ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+/* Number of long name fingerprints which one block compares at once */
+#define FINGERPRINT_BLOCK_SIZE 16U
 
-        if (set_error(error, ARGPAR_ERROR_TYPE_UNKNOWN_OPT, unknown_opt_name, NULL, true)) {
-            ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
-        }
+/*
+ * Returns the first eight bytes (at most `len`) of the long name
+ * `long_name` of length `len`, zero-padded, as a long name fingerprint
+ * prefix.
+ */
+static uint64_t long_name_prefix(const char * const long_name, const size_t len)
+{
+    uint64_t prefix = 0;
 
-        goto error;
+    memcpy(&prefix, long_name, len < sizeof(prefix) ? len : sizeof(prefix));
+    return prefix;
+}
+
+/*
+ * Returns a mask of which of the `count` (at most
+ * `FINGERPRINT_BLOCK_SIZE`) long name fingerprints of `prefixes` and
+ * `lens` are equal to `prefix` and `len`: bit `i` is set for the
+ * fingerprint `i`.
+ *
+ * This loop has no early exit so that the compiler may vectorize it.
+ */
+static unsigned int fingerprint_block_mask(const uint64_t * const prefixes,
+                                           const unsigned int * const lens, const uint64_t prefix,
+                                           const unsigned int len, const unsigned int count)
+{
+    unsigned int mask = 0;
+    unsigned int i;
+
+    for (i = 0; i < count; i++) {
+        mask |= (unsigned int) ((prefixes[i] == prefix) & (lens[i] == len)) << i;
     }
 
-    if (descr->with_arg) {
-        if (iter->short_opt_group_ch[1]) {
-            /* `-oarg` form */
-            opt_arg = &iter->short_opt_group_ch[1];
-        } else {
-            /* `-o arg` form */
-            opt_arg = next_orig_arg;
-            used_next_orig_arg = true;
-        }
+    return mask;
+}
 
-        /*
-         * We accept `-o ''` (empty option argument), but not
-         * `-o` alone if an option argument is expected.
-         */
-        if (!opt_arg || (iter->short_opt_group_ch[1] && strlen(opt_arg) == 0)) {
-            ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+/*
+ * Like find_descr() for the descriptor set `set`, which has
+ * fingerprints, with only one of `short_name` and `long_name`.
+ *
+ * A long name of at most eight bytes is entirely within its prefix:
+ * this function only calls strcmp(), from the ninth byte, for the
+ * candidates having a longer name.
+ */
+static const argpar_opt_descr_t *find_fingerprint_descr(const struct descr_set * const set,
+                                                        const char short_name,
+                                                        const char * const long_name)
+{
+    const argpar_opt_descr_t *descr = NULL;
+    size_t len;
+    uint64_t prefix;
+    unsigned int base;
 
-            if (set_error(error, ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, NULL, descr, true)) {
-                ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
-            }
+    if (short_name) {
+        const char * const found = memchr(set->fingerprints.short_names, short_name, set->count);
 
-            goto error;
+        if (found) {
+            descr = &set->descrs[found - set->fingerprints.short_names];
         }
+
+        goto end;
     }
 
-    /* Create and append option argument */
-    opt_item = create_opt_item(descr, opt_arg);
-    if (!opt_item) {
-        ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
-        goto error;
+    len = strlen(long_name);
+    if (len >= UINT_MAX) {
+        descr = find_descr(set->descrs, '\0', long_name);
+        goto end;
     }
 
-    *item = &opt_item->base;
-    iter->short_opt_group_ch++;
+    prefix = long_name_prefix(long_name, len);
 
-    if (descr->with_arg || !*iter->short_opt_group_ch) {
-        /* Option has an argument: no more options */
-        iter->short_opt_group_ch = NULL;
+    for (base = 0; base < set->count; base += FINGERPRINT_BLOCK_SIZE) {
+        const unsigned int rem = set->count - base;
+        unsigned int mask;
+        unsigned int i;
 
-        if (used_next_orig_arg) {
-            iter->i += 2;
+        /* Constant count for a full block so that it vectorizes */
+        if (rem >= FINGERPRINT_BLOCK_SIZE) {
+            mask = fingerprint_block_mask(&set->fingerprints.long_name_prefixes[base],
+                                          &set->fingerprints.long_name_lens[base], prefix,
+                                          (unsigned int) len, FINGERPRINT_BLOCK_SIZE);
         } else {
-            iter->i++;
+            mask = fingerprint_block_mask(&set->fingerprints.long_name_prefixes[base],
+                                          &set->fingerprints.long_name_lens[base], prefix,
+                                          (unsigned int) len, rem);
         }
-    }
-
-    goto end;
 
-error:
-    ARGPAR_ASSERT(ret != PARSE_ORIG_ARG_OPT_RET_OK);
+        for (i = base; mask; i++, mask >>= 1) {
+            if ((mask & 1) && (len <= sizeof(prefix) ||
+                               strcmp(&set->descrs[i].long_name[sizeof(prefix)],
+                                      &long_name[sizeof(prefix)]) == 0)) {
+                descr = &set->descrs[i];
+                goto end;
+            }
+        }
+    }
 
 end:
-    return ret;
+    return descr;
 }
 
 /*
- * Parses the long option argument `long_opt_arg`.
+ * Finds and returns the _first_ descriptor of the descriptor set `set`
+ * having the short option name `short_name` or, if `short_name` is
+ * `'\0'`, the long option name `long_name`.
  *
- * On success, sets `*item`.
+ * This function uses the tables of the lookup strategy of `set`.
  *
- * On error (except for `PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY`), sets
- * `*error`.
+ * Returns `NULL` if no descriptor is found.
  */
-static parse_orig_arg_opt_ret_t
-parse_long_opt(const char * const long_opt_arg, const char * const next_orig_arg,
-               const argpar_opt_descr_t * const descrs, argpar_iter_t * const iter,
-               argpar_error_t ** const error, argpar_item_t ** const item)
+static const argpar_opt_descr_t *find_set_descr(const struct descr_set * const set,
+                                                const char short_name,
+                                                const char * const long_name)
 {
-    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
     const argpar_opt_descr_t *descr;
-    argpar_item_opt_t *opt_item;
-    bool used_next_orig_arg = false;
 
-    /* Option's argument, if any */
-    const char *opt_arg = NULL;
+    if (set->strategy == ARGPAR_LOOKUP_STRATEGY_SCAN) {
+        descr = find_descr(set->descrs, short_name, long_name);
+    } else if (set->strategy == ARGPAR_LOOKUP_STRATEGY_FINGERPRINT) {
+        descr = find_fingerprint_descr(set, short_name, long_name);
+    } else if (short_name) {
+        const int index = set->short_name_slots[(unsigned char) short_name];
 
-    /* Position of first `=`, if any */
-    const char *eq_pos;
+        descr = index >= 0 ? &set->descrs[index] : NULL;
+    } else {
+        descr = find_long_name_descr(set, long_name);
+    }
 
-    /* Option name */
-    const char *long_opt_name = long_opt_arg;
+    return descr;
+}
 
-    ARGPAR_ASSERT(strlen(long_opt_arg) != 0);
+/*
+ * Like find_set_descr() for the main descriptor set of `iter`, but
+ * consults the lookup cache of `iter`, if enabled, before scanning the
+ * descriptors.
+ *
+ * The cache only contains results of find_set_descr(), therefore a hit
+ * is always the _first_ matching descriptor.
+ */
+static const argpar_opt_descr_t *find_iter_descr(argpar_iter_t * const iter,
+                                                 const char short_name,
+                                                 const char * const long_name)
+{
+    struct lookup_cache_entry * const entries = iter->lookup_cache.entries;
+    const argpar_opt_descr_t *descr = NULL;
+    unsigned int long_name_hash = 0;
+    struct lookup_cache_entry entry;
+    unsigned int i;
 
-    /* Find the first `=` in original argument */
-    eq_pos = strchr(long_opt_arg, '=');
-    if (eq_pos) {
-        const size_t long_opt_name_size = eq_pos - long_opt_arg;
+    if (!iter->lookup_cache.enabled || iter->descr_set.strategy == ARGPAR_LOOKUP_STRATEGY_HASH) {
+        descr = find_set_descr(&iter->descr_set, short_name, long_name);
+        goto end;
+    }
 
-        /* Isolate the option name */
-        while (long_opt_name_size > iter->tmp_buf.size - 1) {
-            const size_t new_size = iter->tmp_buf.size * 2;
-            char * const new_data = ARGPAR_REALLOC(iter->tmp_buf.data, char, new_size);
+    if (!short_name) {
+        long_name_hash = slice_hash(long_name, strlen(long_name));
+    }
 
-            if (!new_data) {
-                ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
-                goto error;
-            }
+    for (i = 0; i < iter->lookup_cache.count; i++) {
+        entry = entries[i];
 
-            iter->tmp_buf.size = new_size;
-            iter->tmp_buf.data = new_data;
+        if (short_name ? entry.short_name == short_name :
+                         !entry.short_name && entry.long_name_hash == long_name_hash &&
+                             strcmp(entry.descr->long_name, long_name) == 0) {
+            break;
         }
-
-        memcpy(iter->tmp_buf.data, long_opt_arg, long_opt_name_size);
-        iter->tmp_buf.data[long_opt_name_size] = '\0';
-        long_opt_name = iter->tmp_buf.data;
     }
 
-    /* Find corresponding option descriptor */
-    descr = find_descr(descrs, '\0', long_opt_name);
-    if (!descr) {
-        ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+    if (i < iter->lookup_cache.count) {
+        /* Hit */
+        descr = entry.descr;
+    } else {
+        /* Miss: insert at the front, evicting the least recently used */
+        descr = find_set_descr(&iter->descr_set, short_name, long_name);
+        if (!descr) {
+            goto end;
+        }
 
-        if (set_error(error, ARGPAR_ERROR_TYPE_UNKNOWN_OPT, long_opt_name, NULL, false)) {
-            ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
+        entry.descr = descr;
+        entry.long_name_hash = long_name_hash;
+        entry.short_name = short_name;
+
+        if (iter->lookup_cache.count < LOOKUP_CACHE_SIZE) {
+            iter->lookup_cache.count++;
         }
 
-        goto error;
+        i = iter->lookup_cache.count - 1;
     }
 
-    /* Find option's argument if any */
-    if (descr->with_arg) {
-        if (eq_pos) {
-            /* `--long-opt=arg` style */
-            opt_arg = eq_pos + 1;
-        } else {
-            /* `--long-opt arg` style */
-            if (!next_orig_arg) {
-                ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+    /* Move to the front */
+    memmove(&entries[1], &entries[0], i * sizeof(*entries));
+    entries[0] = entry;
 
-                if (set_error(error, ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, NULL, descr, false)) {
-                    ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
-                }
+end:
+    return descr;
+}
 
-                goto error;
-            }
+/* Return type of parse_short_opt_group() and parse_long_opt() */
+typedef enum parse_orig_arg_opt_ret
+{
+    PARSE_ORIG_ARG_OPT_RET_OK,
+    PARSE_ORIG_ARG_OPT_RET_ERROR = -1,
+    PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY = -2,
+} parse_orig_arg_opt_ret_t;
 
-            opt_arg = next_orig_arg;
-            used_next_orig_arg = true;
-        }
-    } else if (eq_pos) {
-        /*
-         * Unexpected `--opt=arg` style for a long option which
-         * doesn't accept an argument.
-         */
-        ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+/*
+ * Returns the hash of the choice `str`: the same as slice_hash(), as
+ * choice tables are part of descriptor images.
+ */
+static unsigned int choice_hash(const char * const str)
+{
+    return slice_hash(str, strlen(str));
+}
 
-        if (set_error(error, ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG, NULL, descr, false)) {
-            ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
-        }
+/* Maximum number of choices of an option descriptor */
+#define CHOICE_MAX_COUNT (1U << 24)
 
-        goto error;
-    }
+/*
+ * Fills the slots `slots` (slot count minus one: `mask`) of a choice
+ * table with the choices `choices` (`choice_count` of them).
+ *
+ * A choice equal to a previous one doesn't get a slot, the first one
+ * having precedence.
+ */
+static void fill_choice_slots(int * const slots, const unsigned int mask,
+                              const char * const * const choices, const unsigned int choice_count)
+{
+    unsigned int i;
+
+    for (i = 0; i <= mask; i++) {
+        slots[i] = -1;
+    }
+
+    for (i = 0; i < choice_count; i++) {
+        unsigned int slot = choice_hash(choices[i]) & mask;
+
+        while (slots[slot] >= 0 && strcmp(choices[slots[slot]], choices[i]) != 0) {
+            slot = (slot + 1) & mask;
+        }
+
+        if (slots[slot] < 0) {
+            slots[slot] = (int) i;
+        }
+    }
+}
+
+/*
+ * Builds the hash table `table` of the choices `choices`, having at
+ * least twice as many slots as choices.
+ *
+ * Returns 0 on success or -1 on memory error, including when there are
+ * more than `CHOICE_MAX_COUNT` choices.
+ */
+static int build_choice_table(const argpar_allocator_t * const allocator,
+                              struct choice_table * const table,
+                              const char * const * const choices)
+{
+    int ret = 0;
+    unsigned int choice_count = 0;
+    unsigned int slot_count = 4;
+    int *slots;
+
+    while (choices[choice_count]) {
+        if (choice_count == CHOICE_MAX_COUNT) {
+            ret = -1;
+            goto end;
+        }
+
+        choice_count++;
+    }
+
+    while (slot_count < choice_count * 2) {
+        slot_count *= 2;
+    }
+
+    slots = ARGPAR_CALLOC(allocator, int, slot_count);
+    if (!slots) {
+        ret = -1;
+        goto end;
+    }
+
+    fill_choice_slots(slots, slot_count - 1, choices, choice_count);
+    table->slots = slots;
+    table->mask = slot_count - 1;
+
+end:
+    return ret;
+}
+
+/*
+ * Returns the index, within the choices of `descr`, of `arg` using the
+ * choice table `table`, or -1 if `arg` isn't one of them.
+ *
+ * This function probes at most all the slots of `table`, even if it
+ * has no empty slot.
+ */
+static int find_choice(const struct choice_table * const table,
+                       const argpar_opt_descr_t * const descr, const char * const arg)
+{
+    int choice = -1;
+    unsigned int slot = choice_hash(arg) & table->mask;
+    unsigned int i;
+
+    for (i = 0; i <= table->mask && table->slots[slot] >= 0; i++) {
+        if (strcmp(descr->choices[table->slots[slot]], arg) == 0) {
+            choice = table->slots[slot];
+            break;
+        }
+
+        slot = (slot + 1) & table->mask;
+    }
+
+    return choice;
+}
+
+/* Maximum length of a string which suggest_choice() considers */
+#define SUGGEST_CHOICE_MAX_LEN 63
+
+/*
+ * Returns the optimal string alignment distance (Levenshtein distance
+ * also counting adjacent transpositions) between `a` and `b`, both
+ * having at most `SUGGEST_CHOICE_MAX_LEN` characters.
+ */
+static unsigned int str_distance(const char * const a, const char * const b)
+{
+    const size_t a_len = strlen(a);
+    const size_t b_len = strlen(b);
+    unsigned int rows[3][SUGGEST_CHOICE_MAX_LEN + 1];
+
+    /* Rows `i - 2`, `i - 1`, and `i` */
+    unsigned int *row_2 = rows[0];
+    unsigned int *row_1 = rows[1];
+    unsigned int *row = rows[2];
+    size_t i, j;
+
+    ARGPAR_ASSERT(a_len <= SUGGEST_CHOICE_MAX_LEN);
+    ARGPAR_ASSERT(b_len <= SUGGEST_CHOICE_MAX_LEN);
+
+    for (j = 0; j <= b_len; j++) {
+        row_1[j] = (unsigned int) j;
+    }
+
+    for (i = 1; i <= a_len; i++) {
+        unsigned int *tmp;
+
+        row[0] = (unsigned int) i;
+
+        for (j = 1; j <= b_len; j++) {
+            const unsigned int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            unsigned int dist = row_1[j] + 1;
+
+            if (row[j - 1] + 1 < dist) {
+                /* Insertion */
+                dist = row[j - 1] + 1;
+            }
+
+            if (row_1[j - 1] + cost < dist) {
+                /* Substitution */
+                dist = row_1[j - 1] + cost;
+            }
+
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1] &&
+                row_2[j - 2] + 1 < dist) {
+                /* Transposition */
+                dist = row_2[j - 2] + 1;
+            }
+
+            row[j] = dist;
+        }
+
+        tmp = row_2;
+        row_2 = row_1;
+        row_1 = row;
+        row = tmp;
+    }
+
+    return row_1[b_len];
+}
+
+/*
+ * Returns the choice of `descr` which is the nearest to `arg`, or
+ * `NULL` if none is near enough.
+ */
+static const char *suggest_choice(const argpar_opt_descr_t * const descr, const char * const arg)
+{
+    const char *suggestion = NULL;
+    unsigned int best_dist = 0;
+    const char * const *choice;
+
+    if (strlen(arg) > SUGGEST_CHOICE_MAX_LEN) {
+        goto end;
+    }
+
+    for (choice = descr->choices; *choice; choice++) {
+        const size_t choice_len = strlen(*choice);
+        const size_t max_len = choice_len > strlen(arg) ? choice_len : strlen(arg);
+        size_t max_dist = max_len / 3;
+        unsigned int dist;
+
+        if (choice_len > SUGGEST_CHOICE_MAX_LEN) {
+            continue;
+        }
+
+        if (max_dist == 0) {
+            max_dist = 1;
+        }
+
+        dist = str_distance(arg, *choice);
+        if (dist <= max_dist && (!suggestion || dist < best_dist)) {
+            suggestion = *choice;
+            best_dist = dist;
+        }
+    }
+
+end:
+    return suggestion;
+}
+
+/*
+ * If `descr`, which belongs to `set`, has choices, sets `*choice` to
+ * the index of the choice `opt_arg`, using the choice tables of `set`.
+ *
+ * Otherwise, sets `*choice` to -1.
+ *
+ * On invalid choice (`PARSE_ORIG_ARG_OPT_RET_ERROR`), sets the pending
+ * error `*error`.
+ */
+static parse_orig_arg_opt_ret_t
+validate_choice(const struct descr_set * const set, const argpar_opt_descr_t * const descr,
+                const char * const opt_arg, const bool is_short, argpar_error_t * const error,
+                int * const choice)
+{
+    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
+
+    *choice = -1;
+
+    if (!descr->choices) {
+        goto end;
+    }
+
+    ARGPAR_ASSERT(opt_arg);
+    ARGPAR_ASSERT(set->choice_tables);
+    *choice = find_choice(&set->choice_tables[descr - set->descrs], descr, opt_arg);
+    if (*choice >= 0) {
+        goto end;
+    }
+
+    /* complete_error() computes the suggestion */
+    ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+    set_error(error, ARGPAR_ERROR_TYPE_INVALID_CHOICE, NULL, 0, descr, is_short);
+    error->invalid_opt_arg = opt_arg;
+
+end:
+    return ret;
+}
+
+/*
+ * Grows the temporary buffer of `iter`, if needed, so that it contains
+ * at least `size` characters.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int ensure_tmp_buf_size(argpar_iter_t * const iter, const size_t size)
+{
+    while (size > iter->tmp_buf.size) {
+        const size_t new_size = iter->tmp_buf.size * 2;
+        char * const new_data = ARGPAR_REALLOC(iter->allocator, iter->tmp_buf.data, char, new_size);
+
+        if (!new_data) {
+            return -1;
+        }
+
+        iter->tmp_buf.size = new_size;
+        iter->tmp_buf.data = new_data;
+    }
+
+    return 0;
+}
+
+/*
+ * Parses the short option group argument `short_opt_group`, starting
+ * where needed depending on the state of `iter`.
+ *
+ * On success, initializes `*opt_item`.
+ *
+ * On error (except for `PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY`), sets the
+ * pending error `*error`.
+ */
+static parse_orig_arg_opt_ret_t
+parse_short_opt_group(const char * const short_opt_group, const char * const next_orig_arg,
+                      argpar_iter_t * const iter, argpar_error_t * const error,
+                      argpar_item_opt_t * const opt_item)
+{
+    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
+    bool used_next_orig_arg = false;
+    const char *opt_arg = NULL;
+    const argpar_opt_descr_t *descr;
+    int choice;
+
+    ARGPAR_ASSERT(strlen(short_opt_group) != 0);
+
+    if (!iter->short_opt_group_ch) {
+        iter->short_opt_group_ch = short_opt_group;
+    }
+
+    /* Find corresponding option descriptor */
+    descr = find_iter_descr(iter, *iter->short_opt_group_ch, NULL);
+    if (!descr) {
+        ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+        set_error(error, ARGPAR_ERROR_TYPE_UNKNOWN_OPT, iter->short_opt_group_ch, 1, NULL, true);
+        goto error;
+    }
+
+    if (descr->with_arg) {
+        if (iter->short_opt_group_ch[1]) {
+            /* `-oarg` form */
+            opt_arg = &iter->short_opt_group_ch[1];
+        } else {
+            /* `-o arg` form */
+            opt_arg = next_orig_arg;
+            used_next_orig_arg = true;
+        }
+
+        /*
+         * We accept `-o ''` (empty option argument), but not
+         * `-o` alone if an option argument is expected.
+         */
+        if (!opt_arg || (iter->short_opt_group_ch[1] && strlen(opt_arg) == 0)) {
+            ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+            set_error(error, ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, NULL, 0, descr, true);
+            goto error;
+        }
+    }
+
+    ret = validate_choice(&iter->descr_set, descr, opt_arg, true, error, &choice);
+    if (ret) {
+        goto error;
+    }
+
+    init_opt_item(opt_item, descr, opt_arg, false, choice, iter->i, true);
+    iter->short_opt_group_ch++;
+
+    if (descr->with_arg || !*iter->short_opt_group_ch) {
+        /* Option has an argument: no more options */
+        iter->short_opt_group_ch = NULL;
+
+        if (used_next_orig_arg) {
+            iter->i += 2;
+        } else {
+            iter->i++;
+        }
+    }
+
+    goto end;
+
+error:
+    ARGPAR_ASSERT(ret != PARSE_ORIG_ARG_OPT_RET_OK);
+
+end:
+    return ret;
+}
+
+/*
+ * Returns the namespace descriptor set of `iter` having the prefix
+ * `prefix` of which the length is `prefix_len`, or `NULL` if not found.
+ */
+static const struct descr_set *find_ns(const argpar_iter_t * const iter, const char * const prefix,
+                                       const size_t prefix_len)
+{
+    const struct descr_set *set = NULL;
+    unsigned int slot;
+
+    if (iter->namespaces.count == 0) {
+        goto end;
+    }
+
+    slot = slice_hash(prefix, prefix_len) & iter->namespaces.mask;
+
+    for (; iter->namespaces.slots[slot] >= 0; slot = (slot + 1) & iter->namespaces.mask) {
+        const struct descr_set * const cand = &iter->namespaces.sets[iter->namespaces.slots[slot]];
+
+        if (cand->ns_len == prefix_len && memcmp(cand->ns, prefix, prefix_len) == 0) {
+            set = cand;
+            break;
+        }
+    }
+
+end:
+    return set;
+}
+
+/*
+ * Finds the namespaced option descriptor of `iter` for the long option
+ * name `long_opt_name`, of which the namespace prefix is everything
+ * before the last `.`.
+ *
+ * On success, returns the descriptor, sets `*set` to its set, and sets
+ * `*negated` if `long_opt_name` is the `no-NAME` form of a negatable
+ * option. Otherwise, returns `NULL`.
+ */
+static const argpar_opt_descr_t *find_namespaced_descr(const argpar_iter_t * const iter,
+                                                       const char * const long_opt_name,
+                                                       const struct descr_set ** const set,
+                                                       bool * const negated)
+{
+    const argpar_opt_descr_t *descr = NULL;
+    const char * const dot = strrchr(long_opt_name, '.');
+    const char *name;
+
+    if (!dot) {
+        goto end;
+    }
+
+    *set = find_ns(iter, long_opt_name, dot - long_opt_name);
+    if (!*set) {
+        goto end;
+    }
+
+    name = dot + 1;
+    descr = find_long_name_descr(*set, name);
+    if (!descr && strncmp(name, "no-", 3) == 0) {
+        descr = find_long_name_descr(*set, &name[3]);
+        if (descr && (descr->flags & ARGPAR_OPT_DESCR_FLAG_NEGATABLE)) {
+            *negated = true;
+        } else {
+            descr = NULL;
+        }
+    }
+
+end:
+    return descr;
+}
+
+/*
+ * Parses the long option argument `long_opt_arg`.
+ *
+ * On success, initializes `*opt_item`.
+ *
+ * On error (except for `PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY`), sets the
+ * pending error `*error`.
+ */
+static parse_orig_arg_opt_ret_t
+parse_long_opt(const char * const long_opt_arg, const char * const next_orig_arg,
+               argpar_iter_t * const iter, argpar_error_t * const error,
+               argpar_item_opt_t * const opt_item)
+{
+    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
+    const argpar_opt_descr_t *descr;
+    const struct descr_set *set = &iter->descr_set;
+    bool used_next_orig_arg = false;
+    bool negated = false;
+    int choice;
+
+    /* Option's argument, if any */
+    const char *opt_arg = NULL;
+
+    /* Position of first `=`, if any */
+    const char *eq_pos;
+
+    /* Option name */
+    const char *long_opt_name = long_opt_arg;
+
+    ARGPAR_ASSERT(strlen(long_opt_arg) != 0);
+
+    /* Find the first `=` in original argument */
+    eq_pos = strchr(long_opt_arg, '=');
+    if (eq_pos) {
+        const size_t long_opt_name_size = eq_pos - long_opt_arg;
+
+        /* Isolate the option name */
+        if (ensure_tmp_buf_size(iter, long_opt_name_size + 1)) {
+            ret = PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY;
+            goto error;
+        }
+
+        memcpy(iter->tmp_buf.data, long_opt_arg, long_opt_name_size);
+        iter->tmp_buf.data[long_opt_name_size] = '\0';
+        long_opt_name = iter->tmp_buf.data;
+    }
+
+    /* Find corresponding option descriptor */
+    descr = find_iter_descr(iter, '\0', long_opt_name);
+    if (!descr && strncmp(long_opt_name, "no-", 3) == 0) {
+        /*
+         * Try the negated form: a single lookup of the name without
+         * its `no-` prefix, which must be a negatable option.
+         */
+        descr = find_iter_descr(iter, '\0', &long_opt_name[3]);
+        if (descr && (descr->flags & ARGPAR_OPT_DESCR_FLAG_NEGATABLE)) {
+            ARGPAR_ASSERT(!descr->with_arg);
+            negated = true;
+        } else {
+            descr = NULL;
+        }
+    }
+
+    if (!descr) {
+        /* Try a namespaced option (`--PREFIX.NAME`) */
+        descr = find_namespaced_descr(iter, long_opt_name, &set, &negated);
+    }
+
+    if (!descr) {
+        ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+        set_error(error, ARGPAR_ERROR_TYPE_UNKNOWN_OPT, long_opt_arg,
+                  eq_pos ? (size_t) (eq_pos - long_opt_arg) : strlen(long_opt_arg), NULL, false);
+        goto error;
+    }
+
+    /* Find option's argument if any */
+    if (descr->with_arg) {
+        if (eq_pos) {
+            /* `--long-opt=arg` style */
+            opt_arg = eq_pos + 1;
+        } else {
+            /* `--long-opt arg` style */
+            if (!next_orig_arg) {
+                ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+                set_error(error, ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, NULL, 0, descr, false);
+                goto error;
+            }
+
+            opt_arg = next_orig_arg;
+            used_next_orig_arg = true;
+        }
+    } else if (eq_pos) {
+        /*
+         * Unexpected `--opt=arg` style for a long option which
+         * doesn't accept an argument.
+         */
+        ret = PARSE_ORIG_ARG_OPT_RET_ERROR;
+        set_error(error, ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG, NULL, 0, descr, false);
+        goto error;
+    }
+
+    ret = validate_choice(set, descr, opt_arg, false, error, &choice);
+    if (ret) {
+        goto error;
+    }
+
+    init_opt_item(opt_item, descr, opt_arg, negated, choice, iter->i, false);
+    opt_item->ns = set->ns;
+
+    if (used_next_orig_arg) {
+        iter->i += 2;
+    } else {
+        iter->i++;
+    }
+
+    goto end;
+
+error:
+    ARGPAR_ASSERT(ret != PARSE_ORIG_ARG_OPT_RET_OK);
+
+end:
+    return ret;
+}
+
+/*
+ * Parses the original argument `orig_arg`.
+ *
+ * On success, initializes `*opt_item`.
+ *
+ * On error (except for `PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY`), sets the
+ * pending error `*error`.
+ */
+static parse_orig_arg_opt_ret_t
+parse_orig_arg_opt(const char * const orig_arg, const char * const next_orig_arg,
+                   argpar_iter_t * const iter, argpar_error_t * const error,
+                   argpar_item_opt_t * const opt_item)
+{
+    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
+
+    ARGPAR_ASSERT(orig_arg[0] == '-');
+
+    if (orig_arg[1] == '-') {
+        /* Long option */
+        ret = parse_long_opt(&orig_arg[2], next_orig_arg, iter, error, opt_item);
+    } else {
+        /* Short option */
+        ret = parse_short_opt_group(&orig_arg[1], next_orig_arg, iter, error, opt_item);
+    }
+
+    return ret;
+}
+
+/*
+ * Returns the slot count of a long name hash table for `count` option
+ * descriptors.
+ */
+static unsigned int long_name_slot_count(const unsigned int count)
+{
+    unsigned int slot_count = 4;
+
+    while (slot_count < count * 2) {
+        slot_count *= 2;
+    }
+
+    return slot_count;
+}
+
+/*
+ * Fills the long name hash table `slots` (slot count minus one:
+ * `mask`) with the long names of the `count` option descriptors
+ * `descrs`.
+ *
+ * A long name equal to a previous one doesn't get a slot, the first one
+ * having precedence.
+ */
+static void fill_long_name_slots(int * const slots, const unsigned int mask,
+                                 const argpar_opt_descr_t * const descrs, const unsigned int count)
+{
+    unsigned int i;
+
+    for (i = 0; i <= mask; i++) {
+        slots[i] = -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        const char * const long_name = descrs[i].long_name;
+        unsigned int slot;
+
+        if (!long_name) {
+            continue;
+        }
+
+        slot = slice_hash(long_name, strlen(long_name)) & mask;
+
+        while (slots[slot] >= 0 && strcmp(descrs[slots[slot]].long_name, long_name) != 0) {
+            slot = (slot + 1) & mask;
+        }
+
+        if (slots[slot] < 0) {
+            slots[slot] = (int) i;
+        }
+    }
+}
+
+/* Slot count of a short name table: one per character */
+#define SHORT_NAME_SLOT_COUNT 256U
+
+/*
+ * Fills the short name table `slots` (`SHORT_NAME_SLOT_COUNT` slots)
+ * with the short names of the `count` option descriptors `descrs`.
+ *
+ * A short name equal to a previous one doesn't get a slot, the first
+ * one having precedence.
+ */
+static void fill_short_name_slots(int * const slots, const argpar_opt_descr_t * const descrs,
+                                  const unsigned int count)
+{
+    unsigned int i;
+
+    for (i = 0; i < SHORT_NAME_SLOT_COUNT; i++) {
+        slots[i] = -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        const unsigned char short_name = (unsigned char) descrs[i].short_name;
+
+        if (short_name && slots[short_name] < 0) {
+            slots[short_name] = (int) i;
+        }
+    }
+}
+
+/*
+ * Initializes the compiled descriptor set `set` for the option
+ * descriptors `descrs`, creating its choice tables if at least one of
+ * them has choices.
+ *
+ * If `ns` isn't `NULL`, `set` is for the namespace having the prefix
+ * `ns`: this function also creates its long name hash table.
+ *
+ * On error, `set` may contain partial data to release with
+ * fini_descr_set().
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int init_descr_set(struct descr_set * const set, const argpar_opt_descr_t * const descrs,
+                          const char * const ns, const argpar_allocator_t * const allocator)
+{
+    int ret = 0;
+    bool has_choices = false;
+    unsigned int i;
+
+    memset(set, 0, sizeof(*set));
+    set->descrs = descrs;
+    set->ns = ns;
+    set->strategy = ARGPAR_LOOKUP_STRATEGY_SCAN;
+    set->allocator = allocator;
+
+    for (; descrs[set->count].short_name || descrs[set->count].long_name; set->count++) {
+        if (descrs[set->count].choices) {
+            has_choices = true;
+        }
+    }
+
+    if (has_choices) {
+        set->choice_tables = ARGPAR_CALLOC(allocator, struct choice_table, set->count);
+        if (!set->choice_tables) {
+            goto error;
+        }
+
+        for (i = 0; i < set->count; i++) {
+            const argpar_opt_descr_t * const descr = &descrs[i];
+
+            if (descr->choices) {
+                ARGPAR_ASSERT(descr->with_arg);
+
+                if (build_choice_table(allocator, &set->choice_tables[i], descr->choices)) {
+                    goto error;
+                }
+            }
+        }
+    }
+
+    if (ns) {
+        const unsigned int slot_count = long_name_slot_count(set->count);
+        int * const slots = ARGPAR_CALLOC(allocator, int, slot_count);
+
+        set->ns_len = strlen(ns);
+
+        if (!slots) {
+            goto error;
+        }
+
+        for (i = 0; i < set->count; i++) {
+            ARGPAR_ASSERT(!descrs[i].long_name || !strchr(descrs[i].long_name, '.'));
+        }
+
+        fill_long_name_slots(slots, slot_count - 1, descrs, set->count);
+        set->long_name_slots = slots;
+        set->long_name_mask = slot_count - 1;
+    }
+
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+/*
+ * Creates the fingerprints of the compiled descriptor set `set`.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int build_fingerprints(struct descr_set * const set)
+{
+    int ret = 0;
+    const unsigned int count = set->count;
+    uint64_t *prefixes;
+    unsigned int *lens;
+    char *short_names;
+    unsigned int i;
+
+    /* One allocation: prefixes, then lengths, then short names */
+    prefixes = alloc_calloc(set->allocator, count,
+                            sizeof(*prefixes) + sizeof(*lens) + sizeof(*short_names));
+    if (!prefixes) {
+        goto error;
+    }
+
+    lens = (unsigned int *) &prefixes[count];
+    short_names = (char *) &lens[count];
+
+    for (i = 0; i < count; i++) {
+        const argpar_opt_descr_t * const descr = &set->descrs[i];
+        const size_t len = descr->long_name ? strlen(descr->long_name) : UINT_MAX;
+
+        /* find_fingerprint_descr() doesn't handle such long names */
+        lens[i] = len < UINT_MAX ? (unsigned int) len : UINT_MAX;
+
+        if (descr->long_name) {
+            prefixes[i] = long_name_prefix(descr->long_name, len);
+        }
+
+        short_names[i] = descr->short_name;
+    }
+
+    set->fingerprints.long_name_prefixes = prefixes;
+    set->fingerprints.long_name_lens = lens;
+    set->fingerprints.short_names = short_names;
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+/*
+ * Creates the short name table and the long name hash table of the
+ * compiled descriptor set `set`, with a single allocation.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int build_hash_tables(struct descr_set * const set)
+{
+    int ret = 0;
+    const unsigned int slot_count = long_name_slot_count(set->count);
+    int * const pool = ARGPAR_CALLOC(set->allocator, int, slot_count + SHORT_NAME_SLOT_COUNT);
+
+    if (!pool) {
+        goto error;
+    }
+
+    fill_long_name_slots(pool, slot_count - 1, set->descrs, set->count);
+    fill_short_name_slots(&pool[slot_count], set->descrs, set->count);
+    set->long_name_slots = pool;
+    set->long_name_mask = slot_count - 1;
+    set->short_name_slots = &pool[slot_count];
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+/*
+ * Minimum descriptor counts of a main set for which
+ * `ARGPAR_LOOKUP_STRATEGY_AUTO` selects the fingerprint and hash
+ * strategies, as measured with `bench-argpar` (iterator creation
+ * included).
+ */
+#define FINGERPRINT_MIN_COUNT 24U
+#define HASH_MIN_COUNT 64U
+
+/*
+ * Returns the lookup strategy which `ARGPAR_LOOKUP_STRATEGY_AUTO`
+ * selects for the compiled descriptor set `set`.
+ *
+ * Below `HASH_MIN_COUNT`, fingerprints also lose to hashing when most
+ * long names are longer than eight bytes: such a name always needs a
+ * strcmp() to match, as well as to reject another name having the
+ * same prefix and length.
+ */
+static argpar_lookup_strategy_t auto_lookup_strategy(const struct descr_set * const set)
+{
+    argpar_lookup_strategy_t strategy = ARGPAR_LOOKUP_STRATEGY_SCAN;
+    unsigned int long_count = 0;
+    unsigned int i;
+
+    if (set->count < FINGERPRINT_MIN_COUNT) {
+        goto end;
+    }
+
+    if (set->count >= HASH_MIN_COUNT) {
+        strategy = ARGPAR_LOOKUP_STRATEGY_HASH;
+        goto end;
+    }
+
+    for (i = 0; i < set->count; i++) {
+        const char * const long_name = set->descrs[i].long_name;
+
+        if (long_name && strlen(long_name) > sizeof(uint64_t)) {
+            long_count++;
+        }
+    }
+
+    strategy = long_count > set->count / 2 ? ARGPAR_LOOKUP_STRATEGY_HASH :
+                                             ARGPAR_LOOKUP_STRATEGY_FINGERPRINT;
+
+end:
+    return strategy;
+}
+
+/*
+ * Releases the lookup tables of the compiled descriptor set `set`
+ * (main set owning its tables), making it use
+ * `ARGPAR_LOOKUP_STRATEGY_SCAN`.
+ */
+static void release_lookup_tables(struct descr_set * const set)
+{
+    ARGPAR_FREE(set->allocator, set->long_name_slots);
+    ARGPAR_FREE(set->allocator, set->fingerprints.long_name_prefixes);
+    set->long_name_slots = NULL;
+    set->long_name_mask = 0;
+    set->short_name_slots = NULL;
+    memset(&set->fingerprints, 0, sizeof(set->fingerprints));
+    set->strategy = ARGPAR_LOOKUP_STRATEGY_SCAN;
+}
+
+/*
+ * Makes the compiled descriptor set `set` (main set owning its tables)
+ * use the lookup strategy `strategy`, creating its tables.
+ *
+ * On error, `set` uses `ARGPAR_LOOKUP_STRATEGY_SCAN`.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int set_lookup_strategy(struct descr_set * const set, argpar_lookup_strategy_t strategy)
+{
+    int ret = 0;
+
+    if (strategy == ARGPAR_LOOKUP_STRATEGY_AUTO) {
+        strategy = auto_lookup_strategy(set);
+    }
+
+    if (strategy == set->strategy) {
+        goto end;
+    }
+
+    release_lookup_tables(set);
+
+    if (strategy == ARGPAR_LOOKUP_STRATEGY_FINGERPRINT) {
+        ret = build_fingerprints(set);
+    } else if (strategy == ARGPAR_LOOKUP_STRATEGY_HASH) {
+        ret = build_hash_tables(set);
+    }
+
+    if (ret == 0) {
+        set->strategy = strategy;
+    }
+
+end:
+    return ret;
+}
+
+/*
+ * Releases the resources of the compiled descriptor set `set`.
+ */
+static void fini_descr_set(struct descr_set * const set)
+{
+    if (set->image) {
+        /* The descriptor image owns the tables */
+        goto end;
+    }
+
+    if (set->choice_tables) {
+        unsigned int i;
+
+        for (i = 0; i < set->count; i++) {
+            ARGPAR_FREE(set->allocator, set->choice_tables[i].slots);
+        }
+    }
+
+    ARGPAR_FREE(set->allocator, set->choice_tables);
+    ARGPAR_FREE(set->allocator, set->long_name_slots);
+    ARGPAR_FREE(set->allocator, set->fingerprints.long_name_prefixes);
+
+end:
+    return;
+}
+
+/* Magic bytes of a descriptor image */
+#define IMAGE_MAGIC "ARGPARDI"
+
+/* Format version of a descriptor image */
+#define IMAGE_VERSION 2U
+
+/* Byte order mark of a descriptor image */
+#define IMAGE_BYTE_ORDER 0x01020304U
+
+/* Short name table slot count of a descriptor image */
+#define IMAGE_SHORT_NAME_SLOT_COUNT SHORT_NAME_SLOT_COUNT
+
+/* String offset of a descriptor image record meaning "none" */
+#define IMAGE_NO_STR UINT_MAX
+
+/*
+ * Descriptor image header.
+ *
+ * A descriptor image, of which the size is a multiple of 8, contains,
+ * in this order:
+ *
+ * 1. This header.
+ *
+ * 2. The `descr_count` option descriptor records
+ *    (`struct image_descr`).
+ *
+ * 3. The `pool_len` integers of the table pool:
+ *
+ *    a. The long name hash table (`long_name_mask + 1` slots, like
+ *       `struct descr_set`).
+ *
+ *    b. The short name table (`IMAGE_SHORT_NAME_SLOT_COUNT` slots,
+ *       like `struct descr_set`).
+ *
+ *    c. For each descriptor having choices: its choice hash table
+ *       slots (like `struct choice_table`) followed with the offsets,
+ *       within the string table, of its choices.
+ *
+ * 4. The string table (`strings_size` bytes): null-terminated long
+ *    names and choices.
+ *
+ * 5. Zero padding.
+ *
+ * All the values are in the native byte order: an image is only valid
+ * for the ABI of the program which wrote it.
+ */
+struct image_header
+{
+    /* `IMAGE_MAGIC`, without its null character */
+    char magic[8];
+
+    /* `IMAGE_VERSION` */
+    unsigned int version;
+
+    /* `IMAGE_BYTE_ORDER` */
+    unsigned int byte_order;
+
+    /* User key (see argpar_descr_image_write()) */
+    unsigned long long key;
+
+    /* image_checksum() of everything following this header */
+    unsigned long long checksum;
+
+    /* Size of the whole image (bytes) */
+    unsigned int size;
+
+    /* Number of option descriptor records */
+    unsigned int descr_count;
+
+    /* Slot count of the long name hash table minus one */
+    unsigned int long_name_mask;
+
+    /* Number of integers of the table pool */
+    unsigned int pool_len;
+
+    /* Size of the string table (bytes) */
+    unsigned int strings_size;
+
+    /* `sizeof(struct image_descr)` */
+    unsigned int record_size;
+};
+
+/* Option descriptor record of a descriptor image */
+struct image_descr
+{
+    /* Option descriptor fields */
+    int id;
+    unsigned int flags;
+
+    /* Offset of the long name within the string table, or `IMAGE_NO_STR` */
+    unsigned int long_name;
+
+    /* Number of choices */
+    unsigned int choice_count;
+
+    /* Pool index of the string offsets of the choices */
+    unsigned int choices;
+
+    /*
+     * Choice hash table: mask (0 if the option has no choices) and pool
+     * index of its slots.
+     */
+    unsigned int choice_mask;
+    unsigned int choice_slots;
+
+    /* Option descriptor fields */
+    char short_name;
+    char with_arg;
+    char list_delim;
+    char list_escape;
+};
+
+/*
+ * Loaded descriptor image.
+ *
+ * Such a structure only contains the materialized option descriptors
+ * and choice tables: the names and all the other tables remain within
+ * the image data.
+ */
+struct argpar_descr_image
+{
+    /* Allocator of this structure, or `NULL` for the C library */
+    const argpar_allocator_t *allocator;
+
+    /* Compiled descriptor set, borrowing the tables of the image data */
+    struct descr_set set;
+
+    /*
+     * Option descriptors, including a sentinel: the names point to the
+     * image data.
+     */
+    argpar_opt_descr_t *descrs;
+
+    /* `NULL`-terminated choice arrays of `descrs`, or `NULL` if none */
+    const char **choices;
+};
+
+/*
+ * Returns the size of a descriptor image having `descr_count` option
+ * descriptor records, `pool_len` table pool integers, and a string
+ * table of `strings_size` bytes.
+ */
+static size_t image_size(const size_t descr_count, const size_t pool_len,
+                         const size_t strings_size)
+{
+    const size_t size = sizeof(struct image_header) + descr_count * sizeof(struct image_descr) +
+                        pool_len * sizeof(int) + strings_size;
+
+    return (size + 7) & ~(size_t) 7;
+}
+
+/*
+ * Returns the checksum of the `size` bytes (multiple of 8) of `data`
+ * (8-byte aligned): a 64-bit FNV-1a variant which hashes eight bytes at
+ * a time.
+ */
+static unsigned long long image_checksum(const char * const data, const size_t size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    size_t i;
+
+    for (i = 0; i < size; i += 8) {
+        unsigned long long word;
+
+        memcpy(&word, &data[i], sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * Copies the string `str`, including its null character, to the
+ * string table `strings` at the offset `*offset`, and then advances
+ * `*offset`.
+ *
+ * Returns the initial value of `*offset`.
+ */
+static unsigned int image_put_str(char * const strings, unsigned int * const offset,
+                                  const char * const str)
+{
+    const unsigned int str_offset = *offset;
+    const size_t size = strlen(str) + 1;
+
+    memcpy(&strings[str_offset], str, size);
+    *offset += (unsigned int) size;
+    return str_offset;
+}
+
+/*
+ * Writes the descriptor image of the compiled descriptor set `set`
+ * (main set), of which the long name hash table has `slot_count`
+ * slots, to `data` (`size` bytes).
+ */
+static void write_image(const struct descr_set * const set, const unsigned long long key,
+                        const unsigned int slot_count, const unsigned int pool_len,
+                        const unsigned int strings_size, char * const data, const size_t size)
+{
+    struct image_header header;
+    struct image_descr * const records = (struct image_descr *) &data[sizeof(header)];
+    int * const pool = (int *) &records[set->count];
+    int * const short_name_slots = &pool[slot_count];
+    char * const strings = (char *) &pool[pool_len];
+    unsigned int pool_pos = slot_count + IMAGE_SHORT_NAME_SLOT_COUNT;
+    unsigned int str_pos = 0;
+    unsigned int i;
+
+    memset(data, 0, size);
+    fill_long_name_slots(pool, slot_count - 1, set->descrs, set->count);
+    fill_short_name_slots(short_name_slots, set->descrs, set->count);
+
+    for (i = 0; i < set->count; i++) {
+        const argpar_opt_descr_t * const descr = &set->descrs[i];
+        struct image_descr * const record = &records[i];
+
+        record->id = descr->id;
+        record->flags = descr->flags;
+        record->short_name = descr->short_name;
+        record->with_arg = (char) descr->with_arg;
+        record->list_delim = descr->list_delim;
+        record->list_escape = descr->list_escape;
+        record->long_name = IMAGE_NO_STR;
+
+        if (descr->long_name) {
+            record->long_name = image_put_str(strings, &str_pos, descr->long_name);
+        }
+
+        if (descr->choices) {
+            const struct choice_table * const table = &set->choice_tables[i];
+
+            record->choice_mask = table->mask;
+            record->choice_slots = pool_pos;
+            memcpy(&pool[pool_pos], table->slots, (table->mask + 1) * sizeof(int));
+            pool_pos += table->mask + 1;
+            record->choices = pool_pos;
+
+            for (; descr->choices[record->choice_count]; record->choice_count++) {
+                pool[pool_pos] =
+                    (int) image_put_str(strings, &str_pos, descr->choices[record->choice_count]);
+                pool_pos++;
+            }
+        }
+    }
+
+    ARGPAR_ASSERT(pool_pos == pool_len);
+    ARGPAR_ASSERT(str_pos == strings_size);
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_VERSION;
+    header.byte_order = IMAGE_BYTE_ORDER;
+    header.key = key;
+    header.checksum = image_checksum(&data[sizeof(header)], size - sizeof(header));
+    header.size = (unsigned int) size;
+    header.descr_count = set->count;
+    header.long_name_mask = slot_count - 1;
+    header.pool_len = pool_len;
+    header.strings_size = strings_size;
+    header.record_size = sizeof(struct image_descr);
+    memcpy(data, &header, sizeof(header));
+}
+
+ARGPAR_HIDDEN size_t argpar_descr_image_write(const argpar_opt_descr_t * const descrs,
+                                              const unsigned long long key, void * const buf,
+                                              const size_t buf_size)
+{
+    struct descr_set set;
+    unsigned int slot_count;
+    size_t pool_len, strings_size = 0;
+    size_t size = 0;
+    unsigned int i;
+
+    /* Reuse the choice tables of a compiled descriptor set */
+    if (init_descr_set(&set, descrs, NULL, NULL)) {
+        goto end;
+    }
+
+    slot_count = long_name_slot_count(set.count);
+    pool_len = slot_count + IMAGE_SHORT_NAME_SLOT_COUNT;
+
+    for (i = 0; i < set.count; i++) {
+        const argpar_opt_descr_t * const descr = &descrs[i];
+
+        if (descr->long_name) {
+            strings_size += strlen(descr->long_name) + 1;
+        }
+
+        if (descr->choices) {
+            unsigned int j;
+
+            pool_len += set.choice_tables[i].mask + 1;
+
+            for (j = 0; descr->choices[j]; j++) {
+                pool_len++;
+                strings_size += strlen(descr->choices[j]) + 1;
+            }
+        }
+    }
+
+    if (pool_len > INT_MAX || strings_size > INT_MAX ||
+        image_size(set.count, pool_len, strings_size) > UINT_MAX) {
+        /* Too large */
+        goto end;
+    }
+
+    size = image_size(set.count, pool_len, strings_size);
+
+    if (buf && buf_size >= size) {
+        write_image(&set, key, slot_count, (unsigned int) pool_len, (unsigned int) strings_size,
+                    buf, size);
+    }
+
+end:
+    fini_descr_set(&set);
+    return size;
+}
+
+/*
+ * Validates the header, the layout, and the checksum of the descriptor
+ * image `data` (`size` bytes), setting `*header` to a copy of its
+ * header.
+ */
+static argpar_descr_image_open_status_t check_image_header(const char * const data,
+                                                           const size_t size,
+                                                           const unsigned long long key,
+                                                           struct image_header * const header)
+{
+    argpar_descr_image_open_status_t status = ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID;
+
+    if (size < sizeof(*header) || (uintptr_t) data % 8 != 0) {
+        goto end;
+    }
+
+    memcpy(header, data, sizeof(*header));
+
+    if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0) {
+        goto end;
+    }
+
+    if (header->version != IMAGE_VERSION || header->byte_order != IMAGE_BYTE_ORDER ||
+        header->record_size != sizeof(struct image_descr) || header->key != key) {
+        status = ARGPAR_DESCR_IMAGE_OPEN_STATUS_STALE;
+        goto end;
+    }
+
+    if (header->size != size || header->descr_count > size / sizeof(struct image_descr) ||
+        header->pool_len > size / sizeof(int) || header->strings_size > size ||
+        image_size(header->descr_count, header->pool_len, header->strings_size) != size) {
+        goto end;
+    }
+
+    /*
+     * The long name hash table must fit in the pool, with its short
+     * name table, and have more slots than option descriptors
+     * (check_image_tables() ensures that it has an empty slot).
+     */
+    if (header->pool_len < IMAGE_SHORT_NAME_SLOT_COUNT ||
+        header->long_name_mask >= header->pool_len - IMAGE_SHORT_NAME_SLOT_COUNT ||
+        ((header->long_name_mask + 1) & header->long_name_mask) != 0 ||
+        header->long_name_mask < header->descr_count) {
+        goto end;
+    }
+
+    if (image_checksum(&data[sizeof(*header)], size - sizeof(*header)) != header->checksum) {
+        goto end;
+    }
+
+    status = ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK;
+
+end:
+    return status;
+}
+
+/*
+ * Validates the option descriptor records and the tables of the
+ * descriptor image `data` having the valid header `header`.
+ *
+ * On success, sets `*choice_ptr_count` to the total number of choices
+ * plus the number of descriptors having choices.
+ *
+ * Returns `false` if any record or table is invalid.
+ */
+static bool check_image_tables(const char * const data, const struct image_header * const header,
+                               size_t * const choice_ptr_count)
+{
+    const struct image_descr * const records = (const struct image_descr *) &data[sizeof(*header)];
+    const int * const pool = (const int *) &records[header->descr_count];
+    const int * const short_name_slots = &pool[header->long_name_mask + 1];
+    const char * const strings = (const char *) &pool[header->pool_len];
+    const int count = (int) header->descr_count;
+    unsigned int empty_slot_count;
+    bool ret = false;
+    unsigned int i;
+
+    *choice_ptr_count = 0;
+
+    if (header->strings_size > 0 && strings[header->strings_size - 1] != '\0') {
+        goto end;
+    }
+
+    for (i = 0; i < header->descr_count; i++) {
+        const struct image_descr * const record = &records[i];
+        unsigned int j;
+
+        if ((!record->short_name && record->long_name == IMAGE_NO_STR) ||
+            (record->long_name != IMAGE_NO_STR && record->long_name >= header->strings_size) ||
+            ((record->choice_mask > 0 || record->list_delim) && !record->with_arg) ||
+            ((record->flags & ARGPAR_OPT_DESCR_FLAG_NEGATABLE) && record->with_arg)) {
+            goto end;
+        }
+
+        if (record->choice_mask == 0) {
+            if (record->choice_count > 0) {
+                goto end;
+            }
+
+            continue;
+        }
+
+        if (record->choice_mask >= header->pool_len ||
+            ((record->choice_mask + 1) & record->choice_mask) != 0 ||
+            record->choice_slots > header->pool_len - record->choice_mask - 1 ||
+            record->choices > header->pool_len ||
+            record->choice_count > header->pool_len - record->choices) {
+            goto end;
+        }
+
+        /* The choice hash table must have at least one empty slot */
+        empty_slot_count = 0;
+
+        for (j = 0; j <= record->choice_mask; j++) {
+            const int slot = pool[record->choice_slots + j];
+
+            if (slot < -1 || slot >= (int) record->choice_count) {
+                goto end;
+            }
+
+            if (slot < 0) {
+                empty_slot_count++;
+            }
+        }
+
+        if (empty_slot_count == 0) {
+            goto end;
+        }
+
+        for (j = 0; j < record->choice_count; j++) {
+            const int offset = pool[record->choices + j];
+
+            if (offset < 0 || (unsigned int) offset >= header->strings_size) {
+                goto end;
+            }
+        }
+
+        *choice_ptr_count += record->choice_count + 1;
+    }
+
+    /* The long name hash table must have at least one empty slot */
+    empty_slot_count = 0;
+
+    for (i = 0; i <= header->long_name_mask; i++) {
+        const int slot = pool[i];
+
+        if (slot < -1 || slot >= count ||
+            (slot >= 0 && records[slot].long_name == IMAGE_NO_STR)) {
+            goto end;
+        }
+
+        if (slot < 0) {
+            empty_slot_count++;
+        }
+    }
+
+    if (empty_slot_count == 0) {
+        goto end;
+    }
+
+    for (i = 0; i < IMAGE_SHORT_NAME_SLOT_COUNT; i++) {
+        const int slot = short_name_slots[i];
+
+        if (slot < -1 || slot >= count ||
+            (slot >= 0 && (unsigned char) records[slot].short_name != i)) {
+            goto end;
+        }
+    }
+
+    ret = true;
+
+end:
+    return ret;
+}
+
+/*
+ * Loads the valid descriptor image `data` having the header `header`
+ * into `image`, materializing its option descriptors (see
+ * check_image_tables() for `choice_ptr_count`).
+ *
+ * On error, `image` may contain partial data to release with
+ * argpar_descr_image_destroy().
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int load_image(argpar_descr_image_t * const image, const char * const data,
+                      const struct image_header * const header, const size_t choice_ptr_count)
+{
+    const struct image_descr * const records = (const struct image_descr *) &data[sizeof(*header)];
+    const int * const pool = (const int *) &records[header->descr_count];
+    const char * const strings = (const char *) &pool[header->pool_len];
+    const argpar_opt_descr_t sentinel = ARGPAR_OPT_DESCR_SENTINEL;
+    struct descr_set * const set = &image->set;
+    size_t choice_ptr_index = 0;
+    int ret = 0;
+    unsigned int i;
+
+    image->descrs = ARGPAR_CALLOC(image->allocator, argpar_opt_descr_t, header->descr_count + 1);
+    if (!image->descrs) {
+        goto error;
+    }
+
+    if (choice_ptr_count > 0) {
+        image->choices = ARGPAR_CALLOC(image->allocator, const char *, choice_ptr_count);
+        if (!image->choices) {
+            goto error;
+        }
+
+        set->choice_tables =
+            ARGPAR_CALLOC(image->allocator, struct choice_table, header->descr_count);
+        if (!set->choice_tables) {
+            goto error;
+        }
+    }
+
+    for (i = 0; i < header->descr_count; i++) {
+        const struct image_descr * const record = &records[i];
+        const char **choices = NULL;
+        unsigned int j;
+
+        if (record->choice_mask > 0) {
+            struct choice_table * const table = &set->choice_tables[i];
+
+            choices = &image->choices[choice_ptr_index];
+
+            for (j = 0; j < record->choice_count; j++) {
+                choices[j] = &strings[pool[record->choices + j]];
+            }
+
+            choice_ptr_index += record->choice_count + 1;
+            table->mask = record->choice_mask;
+            table->slots = &pool[record->choice_slots];
+        }
+
+        {
+            const argpar_opt_descr_t descr = {
+                record->id,
+                record->short_name,
+                record->long_name == IMAGE_NO_STR ? NULL : &strings[record->long_name],
+                record->with_arg != 0,
+                record->flags,
+                record->list_delim,
+                record->list_escape,
+                choices,
+                ARGPAR_BIND_NONE,
+            };
+
+            /* Option descriptor members are `const` */
+            memcpy(&image->descrs[i], &descr, sizeof(descr));
+        }
+    }
+
+    memcpy(&image->descrs[header->descr_count], &sentinel, sizeof(sentinel));
+    set->descrs = image->descrs;
+    set->count = header->descr_count;
+    set->long_name_slots = pool;
+    set->long_name_mask = header->long_name_mask;
+    set->short_name_slots = &pool[header->long_name_mask + 1];
+    set->strategy = ARGPAR_LOOKUP_STRATEGY_HASH;
+    set->image = image;
+    set->allocator = image->allocator;
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+ARGPAR_HIDDEN argpar_descr_image_open_status_t
+argpar_descr_image_open(const void * const data, const size_t size, const unsigned long long key,
+                        const argpar_allocator_t * const allocator,
+                        const argpar_descr_image_t ** const image)
+{
+    struct image_header header;
+    size_t choice_ptr_count;
+    argpar_descr_image_t *new_image = NULL;
+    argpar_descr_image_open_status_t status = check_image_header(data, size, key, &header);
+
+    *image = NULL;
+
+    if (status != ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK) {
+        goto end;
+    }
+
+    if (!check_image_tables(data, &header, &choice_ptr_count)) {
+        status = ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID;
+        goto end;
+    }
+
+    new_image = ARGPAR_ZALLOC(allocator, argpar_descr_image_t);
+    if (!new_image) {
+        status = ARGPAR_DESCR_IMAGE_OPEN_STATUS_ERROR_MEMORY;
+        goto end;
+    }
+
+    new_image->allocator = allocator;
+
+    if (load_image(new_image, data, &header, choice_ptr_count)) {
+        status = ARGPAR_DESCR_IMAGE_OPEN_STATUS_ERROR_MEMORY;
+        argpar_descr_image_destroy(new_image);
+        goto end;
+    }
+
+    *image = new_image;
+
+end:
+    return status;
+}
+
+ARGPAR_HIDDEN const argpar_opt_descr_t *
+argpar_descr_image_descrs(const argpar_descr_image_t * const image)
+{
+    ARGPAR_ASSERT(image);
+    return image->descrs;
+}
+
+ARGPAR_HIDDEN void argpar_descr_image_destroy(const argpar_descr_image_t * const image)
+{
+    if (image) {
+        ARGPAR_FREE(image->allocator, image->set.choice_tables);
+        ARGPAR_FREE(image->allocator, image->choices);
+        ARGPAR_FREE(image->allocator, image->descrs);
+        ARGPAR_FREE(image->allocator, image);
+    }
+}
+
+/*
+ * Creates an argument parsing iterator for the option descriptors
+ * `descrs`, using the compiled descriptor set of the descriptor image
+ * `image` if it's not `NULL`.
+ */
+static argpar_iter_t *create_iter(const unsigned int argc, const char * const * const argv,
+                                  const argpar_opt_descr_t * const descrs,
+                                  const argpar_descr_image_t * const image,
+                                  const argpar_allocator_t * const allocator)
+{
+    argpar_iter_t *iter = ARGPAR_ZALLOC(allocator, argpar_iter_t);
+
+    if (!iter) {
+        goto end;
+    }
+
+    iter->allocator = allocator;
+    iter->user.argc = argc;
+    iter->user.argv = argv;
+    iter->user.descrs = descrs;
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    iter->histogram.unit = ARGPAR_HISTOGRAM_UNIT;
+#endif
+    iter->tmp_buf.size = 128;
+    iter->tmp_buf.data = ARGPAR_CALLOC(allocator, char, iter->tmp_buf.size);
+    if (!iter->tmp_buf.data) {
+        goto error;
+    }
+
+    if (image) {
+        /* Borrow the tables of the image */
+        iter->descr_set = image->set;
+    } else if (init_descr_set(&iter->descr_set, descrs, NULL, allocator)) {
+        goto error;
+    } else if (set_lookup_strategy(&iter->descr_set, ARGPAR_LOOKUP_STRATEGY_AUTO)) {
+        goto error;
+    }
+
+    goto end;
+
+error:
+    argpar_iter_destroy(iter);
+    iter = NULL;
+
+end:
+    return iter;
+}
+
+ARGPAR_HIDDEN argpar_iter_t *
+argpar_iter_create_with_allocator(const unsigned int argc, const char * const * const argv,
+                                  const argpar_opt_descr_t * const descrs,
+                                  const argpar_allocator_t * const allocator)
+{
+    return create_iter(argc, argv, descrs, NULL, allocator);
+}
+
+ARGPAR_HIDDEN argpar_iter_t *argpar_iter_create_with_image(const unsigned int argc,
+                                                           const char * const * const argv,
+                                                           const argpar_descr_image_t * const image)
+{
+    return create_iter(argc, argv, image->descrs, image, image->allocator);
+}
+
+ARGPAR_HIDDEN argpar_iter_t *argpar_iter_create(const unsigned int argc,
+                                                const char * const * const argv,
+                                                const argpar_opt_descr_t * const descrs)
+{
+    return argpar_iter_create_with_allocator(argc, argv, descrs, NULL);
+}
+
+ARGPAR_HIDDEN void argpar_iter_destroy(argpar_iter_t * const iter)
+{
+    if (iter) {
+        unsigned int i;
+
+        fini_descr_set(&iter->descr_set);
+
+        for (i = 0; i < iter->namespaces.count; i++) {
+            fini_descr_set(&iter->namespaces.sets[i]);
+        }
+
+        ARGPAR_FREE(iter->allocator, iter->namespaces.sets);
+        ARGPAR_FREE(iter->allocator, iter->namespaces.slots);
+        ARGPAR_FREE(iter->allocator, iter->tmp_buf.data);
+        ARGPAR_FREE(iter->allocator, iter);
+    }
+}
+
+/*
+ * Records the option without an argument `opt_item` into the flag sink
+ * of `iter`.
+ */
+static void record_flag(argpar_iter_t * const iter, const argpar_item_opt_t * const opt_item)
+{
+    const int id = opt_item->descr->id;
+
+    ARGPAR_ASSERT(id >= 0);
+
+    if (iter->flag_sink.bitset) {
+        unsigned char * const byte = &iter->flag_sink.bitset[id / 8];
+        const unsigned char mask = (unsigned char) (1U << (id % 8));
+
+        if (opt_item->negated) {
+            *byte &= (unsigned char) ~mask;
+        } else {
+            *byte |= mask;
+        }
+    }
+
+    if (iter->flag_sink.counters) {
+        if (opt_item->negated) {
+            iter->flag_sink.counters[id] = 0;
+        } else {
+            iter->flag_sink.counters[id]++;
+        }
+    }
+}
+
+/*
+ * Parses the next item of `iter` into `*item`, without allocating it.
+ *
+ * If `iter` has a flag sink, records the options without an argument
+ * into it and skips them.
+ *
+ * On parsing error, sets the pending error `*error` (see
+ * complete_error()).
+ *
+ * Same semantics as argpar_iter_next() otherwise.
+ */
+static argpar_iter_next_status_t iter_next(argpar_iter_t * const iter,
+                                           argpar_item_storage_t * const item,
+                                           argpar_error_t * const error)
+{
+    argpar_iter_next_status_t status;
+    parse_orig_arg_opt_ret_t parse_orig_arg_opt_ret;
+    const char *orig_arg;
+    const char *next_orig_arg;
+
+    ARGPAR_ASSERT(iter->i <= iter->user.argc);
+
+next:
+    if (iter->stopped_at_non_opt) {
+        status = ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT;
+        goto end;
+    }
+
+    if (iter->i == iter->user.argc) {
+        status = ARGPAR_ITER_NEXT_STATUS_END;
+        goto end;
+    }
+
+    orig_arg = iter->user.argv[iter->i];
+    next_orig_arg = iter->i < (iter->user.argc - 1) ? iter->user.argv[iter->i + 1] : NULL;
+
+    if (strcmp(orig_arg, "-") == 0 || strcmp(orig_arg, "--") == 0 || orig_arg[0] != '-') {
+        if (iter->stop_at_non_opt) {
+            /* Stop here, ingesting a `--` argument */
+            if (strcmp(orig_arg, "--") == 0) {
+                iter->i++;
+            }
+
+            iter->stopped_at_non_opt = true;
+            goto next;
+        }
+
+        /* Non-option argument */
+        init_non_opt_item(&item->non_opt, orig_arg, iter->i, iter->non_opt_index);
+        iter->non_opt_index++;
+        iter->i++;
+        status = ARGPAR_ITER_NEXT_STATUS_OK;
+        goto end;
+    }
+
+    /* Option argument */
+    parse_orig_arg_opt_ret = parse_orig_arg_opt(orig_arg, next_orig_arg, iter, error, &item->opt);
+    switch (parse_orig_arg_opt_ret) {
+    case PARSE_ORIG_ARG_OPT_RET_OK:
+        if (!item->opt.descr->with_arg && (iter->flag_sink.bitset || iter->flag_sink.counters)) {
+            record_flag(iter, &item->opt);
+            goto next;
+        }
+
+        status = ARGPAR_ITER_NEXT_STATUS_OK;
+        break;
+    case PARSE_ORIG_ARG_OPT_RET_ERROR:
+        error->orig_index = iter->i;
+        status = ARGPAR_ITER_NEXT_STATUS_ERROR;
+        break;
+    case PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY:
+        status = ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY;
+        break;
+    default:
+        abort();
+    }
+
+end:
+    return status;
+}
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+/*
+ * Records the latency `latency` of an argpar_iter_next() call with
+ * `iter` which returned `status` and, on success, parsed `item`.
+ */
+static void record_latency(argpar_iter_t * const iter, const argpar_iter_next_status_t status,
+                           const argpar_item_storage_t * const item,
+                           const unsigned long long latency)
+{
+    argpar_histogram_path_stats_t *stats;
+    unsigned int bucket = 0;
+
+    switch (status) {
+    case ARGPAR_ITER_NEXT_STATUS_OK:
+        if (item->base.type == ARGPAR_ITEM_TYPE_NON_OPT) {
+            stats = &iter->histogram.paths[ARGPAR_HISTOGRAM_PATH_NON_OPT];
+        } else if (item->opt.is_short) {
+            stats = &iter->histogram.paths[ARGPAR_HISTOGRAM_PATH_SHORT_OPT];
+        } else {
+            stats = &iter->histogram.paths[ARGPAR_HISTOGRAM_PATH_LONG_OPT];
+        }
+
+        break;
+    case ARGPAR_ITER_NEXT_STATUS_ERROR:
+    case ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY:
+        stats = &iter->histogram.paths[ARGPAR_HISTOGRAM_PATH_ERROR];
+        break;
+    default:
+        /* End of iteration: not recorded */
+        return;
+    }
+
+    /* Bucket `i` > 0 is [2^(i - 1), 2^i) */
+    while (bucket < ARGPAR_HISTOGRAM_BUCKET_COUNT - 1 && (latency >> bucket) != 0) {
+        bucket++;
+    }
+
+    stats->call_count++;
+    stats->total += latency;
+    stats->buckets[bucket]++;
+
+    if (latency > stats->max) {
+        stats->max = latency;
+    }
+}
+#endif
+
+/*
+ * Emits the event of an argpar_iter_next() call with `iter` which
+ * returned `status`, producing `item` on success and `error` on parsing
+ * error, to the event sink of `iter`.
+ *
+ * `item_storage` is the storage in which iter_next() parsed `item`
+ * (`item` itself, or the original of a copy).
+ */
+static void emit_iter_next_event(const argpar_iter_t * const iter,
+                                 const argpar_iter_next_status_t status,
+                                 const argpar_item_t * const item,
+                                 const argpar_item_storage_t * const item_storage,
+                                 const argpar_error_t * const error)
+{
+    argpar_event_t event;
+
+    event.iter = iter;
+    event.argc = iter->user.argc;
+    event.status = status;
+    event.item = NULL;
+    event.error = NULL;
+
+    switch (status) {
+    case ARGPAR_ITER_NEXT_STATUS_OK:
+        ARGPAR_ASSERT(item);
+        event.type = ARGPAR_EVENT_TYPE_ITER_NEXT;
+        event.item = item;
+        event.orig_index = item_storage->base.type == ARGPAR_ITEM_TYPE_OPT ?
+                               item_storage->opt.orig_index :
+                               item_storage->non_opt.orig_index;
+        break;
+    case ARGPAR_ITER_NEXT_STATUS_ERROR:
+        event.type = ARGPAR_EVENT_TYPE_ERROR;
+        event.error = error;
+        event.orig_index = error->orig_index;
+        break;
+    case ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY:
+        event.type = ARGPAR_EVENT_TYPE_ERROR;
+        event.orig_index = iter->i;
+        break;
+    default:
+        event.type = ARGPAR_EVENT_TYPE_ITER_NEXT;
+        event.orig_index = iter->i;
+        break;
+    }
+
+    iter->event_sink.func(&event, iter->event_sink.data);
+}
+
+/*
+ * Completes the pending error `error` of `iter` for a caller which
+ * wants it: computes its choice suggestion, if any, and writes its
+ * unknown option name, if any, with its prefix into the temporary
+ * buffer of `iter`.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int complete_error(argpar_iter_t * const iter, argpar_error_t * const error)
+{
+    const argpar_slice_t name = error->unknown_opt_name_slice;
+    const size_t prefix_len = error->is_short ? 1 : 2;
+
+    if (error->type == ARGPAR_ERROR_TYPE_INVALID_CHOICE) {
+        error->invalid_choice_suggestion = suggest_choice(error->opt_descr, error->invalid_opt_arg);
+    }
+
+    if (error->type != ARGPAR_ERROR_TYPE_UNKNOWN_OPT) {
+        return 0;
+    }
+
+    if (ensure_tmp_buf_size(iter, prefix_len + name.len + 1)) {
+        return -1;
+    }
+
+    memcpy(iter->tmp_buf.data, "--", prefix_len);
+    memcpy(&iter->tmp_buf.data[prefix_len], name.ptr, name.len);
+    iter->tmp_buf.data[prefix_len + name.len] = '\0';
+    error->unknown_opt_name = iter->tmp_buf.data;
+    return 0;
+}
+
+/*
+ * If `error` is not `NULL`, completes the pending error
+ * `pending_error` of `iter` and sets `*error` to a copy of it, allocated
+ * with the allocator of `iter`.
+ *
+ * Returns 0 on success (including if `error` is `NULL`) or -1 on memory
+ * error.
+ */
+static int set_new_error(argpar_iter_t * const iter, argpar_error_t * const pending_error,
+                         const argpar_error_t ** const error)
+{
+    if (!error) {
+        return 0;
+    }
+
+    if (complete_error(iter, pending_error)) {
+        return -1;
+    }
+
+    *error = dup_error(iter->allocator, pending_error);
+    return *error ? 0 : -1;
+}
+
+/*
+ * Common implementation of argpar_iter_next() and
+ * argpar_iter_borrow_next(): on success, sets `*item` to the borrowed
+ * item of `iter` if `borrow` is true, or to a new item otherwise.
+ *
+ * On parsing error, sets `*error`, if `error` isn't `NULL`, to the
+ * borrowed error of `iter` if `borrow` is true, or to a new error
+ * otherwise: only a caller (or an event sink) which wants the error
+ * pays for its completion.
+ */
+static argpar_iter_next_status_t iter_next_item(argpar_iter_t * const iter, const bool borrow,
+                                                const argpar_item_t ** const item,
+                                                const argpar_error_t ** const error)
+{
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    const unsigned long long begin = histogram_now();
+#endif
+    argpar_item_storage_t local_item_storage;
+    argpar_item_storage_t * const item_storage =
+        borrow ? &iter->borrowed_item : &local_item_storage;
+    argpar_error_t local_error;
+    argpar_error_t * const pending_error = borrow ? &iter->borrowed_error : &local_error;
+    const argpar_item_t *new_item = NULL;
+    argpar_iter_next_status_t status;
+
+    if (error) {
+        *error = NULL;
+    }
+
+    status = iter_next(iter, item_storage, pending_error);
+
+    if (status == ARGPAR_ITER_NEXT_STATUS_ERROR) {
+        /* An event sink gets the error, even if the caller doesn't */
+        if (borrow || !error) {
+            if ((error || iter->event_sink.func) && complete_error(iter, pending_error)) {
+                status = ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY;
+            } else if (error) {
+                *error = pending_error;
+            }
+        } else if (set_new_error(iter, pending_error, error)) {
+            status = ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY;
+        }
+    } else if (status == ARGPAR_ITER_NEXT_STATUS_OK) {
+        new_item = borrow ? &item_storage->base : dup_item(iter->allocator, item_storage);
+        if (new_item) {
+            *item = new_item;
+        } else {
+            status = ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY;
+        }
+    }
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    record_latency(iter, status, item_storage, histogram_now() - begin);
+#endif
+
+    if (iter->event_sink.func) {
+        emit_iter_next_event(iter, status, new_item, item_storage, pending_error);
+    }
+
+    return status;
+}
+
+ARGPAR_HIDDEN argpar_iter_next_status_t argpar_iter_next(argpar_iter_t * const iter,
+                                                         const argpar_item_t ** const item,
+                                                         const argpar_error_t ** const error)
+{
+    return iter_next_item(iter, false, item, error);
+}
+
+ARGPAR_HIDDEN argpar_iter_next_status_t
+argpar_iter_borrow_next(argpar_iter_t * const iter, const argpar_item_t ** const item,
+                        const argpar_error_t ** const error)
+{
+    return iter_next_item(iter, true, item, error);
+}
+
+ARGPAR_HIDDEN unsigned int argpar_iter_ingested_orig_args(const argpar_iter_t * const iter)
+{
+    return iter->i;
+}
+
+ARGPAR_HIDDEN void argpar_iter_set_flag_sink(argpar_iter_t * const iter,
+                                             unsigned char * const bitset,
+                                             unsigned int * const counters)
+{
+    ARGPAR_ASSERT(iter);
+    ARGPAR_ASSERT(iter->i == 0);
+    iter->flag_sink.bitset = bitset;
+    iter->flag_sink.counters = counters;
+}
+
+ARGPAR_HIDDEN void argpar_iter_set_stop_at_non_opt(argpar_iter_t * const iter, const bool stop)
+{
+    ARGPAR_ASSERT(iter);
+    ARGPAR_ASSERT(iter->i == 0);
+    iter->stop_at_non_opt = stop;
+}
+
+ARGPAR_HIDDEN void argpar_iter_set_lookup_cache(argpar_iter_t * const iter, const bool enable)
+{
+    ARGPAR_ASSERT(iter);
+    iter->lookup_cache.enabled = enable;
+    iter->lookup_cache.count = 0;
+}
+
+ARGPAR_HIDDEN argpar_iter_set_lookup_strategy_status_t
+argpar_iter_set_lookup_strategy(argpar_iter_t * const iter, const argpar_lookup_strategy_t strategy)
+{
+    argpar_iter_set_lookup_strategy_status_t status = ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK;
+
+    ARGPAR_ASSERT(iter);
+
+    if (iter->descr_set.image) {
+        /* The image owns the tables */
+        goto end;
+    }
+
+    if (set_lookup_strategy(&iter->descr_set, strategy)) {
+        status = ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_ERROR_MEMORY;
+    }
+
+end:
+    return status;
+}
+
+ARGPAR_HIDDEN argpar_lookup_strategy_t argpar_iter_lookup_strategy(const argpar_iter_t * const iter)
+{
+    ARGPAR_ASSERT(iter);
+    return iter->descr_set.strategy;
+}
+
+ARGPAR_HIDDEN void argpar_iter_set_event_sink(argpar_iter_t * const iter,
+                                              const argpar_event_sink_func_t func,
+                                              void * const data)
+{
+    ARGPAR_ASSERT(iter);
+    ARGPAR_ASSERT(iter->i == 0);
+    iter->event_sink.func = func;
+    iter->event_sink.data = data;
+
+    if (func) {
+        argpar_event_t event;
+
+        event.type = ARGPAR_EVENT_TYPE_ITER_CREATE;
+        event.iter = iter;
+        event.argc = iter->user.argc;
+        event.orig_index = 0;
+        event.status = ARGPAR_ITER_NEXT_STATUS_OK;
+        event.item = NULL;
+        event.error = NULL;
+        func(&event, data);
+    }
+}
+
+ARGPAR_HIDDEN const argpar_histogram_t *argpar_iter_get_histogram(const argpar_iter_t * const iter)
+{
+    ARGPAR_ASSERT(iter);
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    return &iter->histogram;
+#else
+    return NULL;
+#endif
+}
+
+ARGPAR_HIDDEN void argpar_histogram_print(const argpar_histogram_t * const histogram,
+                                          FILE * const stream)
+{
+    static const char * const path_names[] = {
+        "Non-option argument",
+        "Short option",
+        "Long option",
+        "Error",
+    };
+    static const char bar[] = "########################################";
+    unsigned int path;
+
+    ARGPAR_ASSERT(histogram);
+    ARGPAR_ASSERT(stream);
+
+    for (path = 0; path < ARGPAR_HISTOGRAM_PATH_COUNT; path++) {
+        const argpar_histogram_path_stats_t * const stats = &histogram->paths[path];
+        unsigned long long max_bucket_count = 0;
+        unsigned int i;
+
+        if (stats->call_count == 0) {
+            continue;
+        }
+
+        for (i = 0; i < ARGPAR_HISTOGRAM_BUCKET_COUNT; i++) {
+            if (stats->buckets[i] > max_bucket_count) {
+                max_bucket_count = stats->buckets[i];
+            }
+        }
+
+        fprintf(stream, "%s: %llu call%s, mean %llu %s, max %llu %s\n", path_names[path],
+                stats->call_count, stats->call_count == 1 ? "" : "s",
+                stats->total / stats->call_count, histogram->unit, stats->max, histogram->unit);
+
+        for (i = 0; i < ARGPAR_HISTOGRAM_BUCKET_COUNT; i++) {
+            const unsigned long long lower = i == 0 ? 0 : 1ULL << (i - 1);
+            int bar_len;
+
+            if (stats->buckets[i] == 0) {
+                continue;
+            }
+
+            bar_len = (int) ((stats->buckets[i] * (sizeof(bar) - 1) + max_bucket_count - 1) /
+                             max_bucket_count);
+
+            if (i == ARGPAR_HISTOGRAM_BUCKET_COUNT - 1) {
+                fprintf(stream, "  [%10llu, %10s) %10llu %.*s\n", lower, "inf",
+                        stats->buckets[i], bar_len, bar);
+            } else {
+                fprintf(stream, "  [%10llu, %10llu) %10llu %.*s\n", lower, 1ULL << i,
+                        stats->buckets[i], bar_len, bar);
+            }
+        }
+    }
+}
+
+/*
+ * Rebuilds the namespace prefix hash table of `iter` with `slot_count`
+ * slots.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int rebuild_ns_slots(argpar_iter_t * const iter, const unsigned int slot_count)
+{
+    int ret = 0;
+    int * const new_slots =
+        ARGPAR_REALLOC(iter->allocator, iter->namespaces.slots, int, slot_count);
+    unsigned int i;
+
+    if (!new_slots) {
+        ret = -1;
+        goto end;
+    }
+
+    iter->namespaces.slots = new_slots;
+    iter->namespaces.mask = slot_count - 1;
+
+    for (i = 0; i < slot_count; i++) {
+        new_slots[i] = -1;
+    }
+
+    for (i = 0; i < iter->namespaces.count; i++) {
+        const struct descr_set * const set = &iter->namespaces.sets[i];
+        unsigned int slot = slice_hash(set->ns, set->ns_len) & iter->namespaces.mask;
+
+        while (new_slots[slot] >= 0) {
+            slot = (slot + 1) & iter->namespaces.mask;
+        }
+
+        new_slots[slot] = (int) i;
+    }
+
+end:
+    return ret;
+}
+
+ARGPAR_HIDDEN argpar_iter_add_namespace_status_t
+argpar_iter_add_namespace(argpar_iter_t * const iter, const char * const prefix,
+                          const argpar_opt_descr_t * const descrs)
+{
+    argpar_iter_add_namespace_status_t status = ARGPAR_ITER_ADD_NAMESPACE_STATUS_OK;
+    struct descr_set *set;
+
+    ARGPAR_ASSERT(iter);
+    ARGPAR_ASSERT(prefix);
+    ARGPAR_ASSERT(strlen(prefix) > 0);
+    ARGPAR_ASSERT(descrs);
+    ARGPAR_ASSERT(!find_ns(iter, prefix, strlen(prefix)));
+
+    if (iter->namespaces.count == iter->namespaces.capacity) {
+        const unsigned int new_capacity =
+            iter->namespaces.capacity == 0 ? 4 : iter->namespaces.capacity * 2;
+        struct descr_set * const new_sets =
+            ARGPAR_REALLOC(iter->allocator, iter->namespaces.sets, struct descr_set, new_capacity);
+
+        if (!new_sets) {
+            goto error;
+        }
+
+        iter->namespaces.sets = new_sets;
+        iter->namespaces.capacity = new_capacity;
+    }
+
+    set = &iter->namespaces.sets[iter->namespaces.count];
+
+    if (init_descr_set(set, descrs, prefix, iter->allocator)) {
+        fini_descr_set(set);
+        goto error;
+    }
+
+    iter->namespaces.count++;
+
+    /* Keep the prefix hash table at most half full */
+    if (!iter->namespaces.slots || iter->namespaces.count * 2 > iter->namespaces.mask + 1) {
+        const unsigned int slot_count =
+            iter->namespaces.slots ? (iter->namespaces.mask + 1) * 2 : 8;
+
+        if (rebuild_ns_slots(iter, slot_count)) {
+            iter->namespaces.count--;
+            fini_descr_set(set);
+            goto error;
+        }
+    } else {
+        unsigned int slot = slice_hash(set->ns, set->ns_len) & iter->namespaces.mask;
+
+        while (iter->namespaces.slots[slot] >= 0) {
+            slot = (slot + 1) & iter->namespaces.mask;
+        }
+
+        iter->namespaces.slots[slot] = (int) (iter->namespaces.count - 1);
+    }
+
+    goto end;
+
+error:
+    status = ARGPAR_ITER_ADD_NAMESPACE_STATUS_ERROR_MEMORY;
+
+end:
+    return status;
+}
+
+ARGPAR_HIDDEN void argpar_arg_list_fini(argpar_arg_list_t * const list)
+{
+    ARGPAR_ASSERT(list);
+    ARGPAR_FREE(NULL, list->args);
+    memset(list, 0, sizeof(*list));
+}
+
+/*
+ * Stores the unsigned integer `val` into the integer member `member`
+ * of which the size is `size`, truncating it.
+ */
+static void store_uint(void * const member, const size_t size, const unsigned long long val)
+{
+    if (size == sizeof(unsigned char)) {
+        *(unsigned char *) member = (unsigned char) val;
+    } else if (size == sizeof(unsigned short)) {
+        *(unsigned short *) member = (unsigned short) val;
+    } else if (size == sizeof(unsigned int)) {
+        *(unsigned int *) member = (unsigned int) val;
+    } else {
+        ARGPAR_ASSERT(size == sizeof(unsigned long long));
+        *(unsigned long long *) member = val;
+    }
+}
+
+/*
+ * Loads and returns the value of the unsigned integer member `member`
+ * of which the size is `size`.
+ */
+static unsigned long long load_uint(const void * const member, const size_t size)
+{
+    unsigned long long val;
+
+    if (size == sizeof(unsigned char)) {
+        val = *(const unsigned char *) member;
+    } else if (size == sizeof(unsigned short)) {
+        val = *(const unsigned short *) member;
+    } else if (size == sizeof(unsigned int)) {
+        val = *(const unsigned int *) member;
+    } else {
+        ARGPAR_ASSERT(size == sizeof(unsigned long long));
+        val = *(const unsigned long long *) member;
+    }
+
+    return val;
+}
+
+/*
+ * Stores the signed integer `val` into the signed integer member
+ * `member` of which the size is `size`.
+ *
+ * Returns `false` if `val` is out of range.
+ */
+static bool store_int(void * const member, const size_t size, const long long val)
+{
+    bool ret = true;
+
+    if (size == sizeof(signed char)) {
+        if (val < SCHAR_MIN || val > SCHAR_MAX) {
+            ret = false;
+            goto end;
+        }
+
+        *(signed char *) member = (signed char) val;
+    } else if (size == sizeof(short)) {
+        if (val < SHRT_MIN || val > SHRT_MAX) {
+            ret = false;
+            goto end;
+        }
+
+        *(short *) member = (short) val;
+    } else if (size == sizeof(int)) {
+        if (val < INT_MIN || val > INT_MAX) {
+            ret = false;
+            goto end;
+        }
+
+        *(int *) member = (int) val;
+    } else {
+        ARGPAR_ASSERT(size == sizeof(long long));
+        *(long long *) member = val;
+    }
+
+end:
+    return ret;
+}
+
+/*
+ * Returns the maximum value of an unsigned integer member of which the
+ * size is `size`.
+ */
+static unsigned long long uint_max(const size_t size)
+{
+    return size >= sizeof(unsigned long long) ? ULLONG_MAX : (1ULL << (size * CHAR_BIT)) - 1;
+}
+
+/*
+ * Returns whether or not the numeric argument `arg` may start a number:
+ * strtoll(), strtoull(), strtod(), and strtof() skip leading
+ * whitespaces, but a numeric argument may not have any.
+ */
+static bool is_number_arg_start(const char * const arg)
+{
+    return *arg != '\0' && !isspace((unsigned char) *arg);
+}
+
+/* Return type of apply_binding() */
+typedef enum apply_binding_ret
+{
+    APPLY_BINDING_RET_OK,
+    APPLY_BINDING_RET_ERROR_INVALID_ARG = -1,
+    APPLY_BINDING_RET_ERROR_MEMORY = -2,
+} apply_binding_ret_t;
+
+/*
+ * Writes, according to `binding`, the argument `arg` (may be `NULL`) of
+ * the option or non-option `item` into the structure `target`.
+ */
+static apply_binding_ret_t apply_binding(const argpar_binding_t * const binding,
+                                         void * const target,
+                                         const argpar_item_storage_t * const item,
+                                         const char * const arg)
+{
+    apply_binding_ret_t ret = APPLY_BINDING_RET_OK;
+    void * const member = (char *) target + binding->offset;
+    const bool negated = item->base.type == ARGPAR_ITEM_TYPE_OPT && item->opt.negated;
+    char *conv_end;
+
+    switch (binding->kind) {
+    case ARGPAR_BINDING_KIND_NONE:
+        break;
+    case ARGPAR_BINDING_KIND_FLAG:
+        store_uint(member, binding->size, negated ? 0 : 1);
+        break;
+    case ARGPAR_BINDING_KIND_COUNTER:
+        store_uint(member, binding->size, negated ? 0 : load_uint(member, binding->size) + 1);
+        break;
+    case ARGPAR_BINDING_KIND_STR:
+        ARGPAR_ASSERT(arg);
+        ARGPAR_ASSERT(binding->size == sizeof(const char *));
+        *(const char **) member = arg;
+        break;
+    case ARGPAR_BINDING_KIND_INT:
+    {
+        long long val;
+
+        ARGPAR_ASSERT(arg);
+        errno = 0;
+        val = strtoll(arg, &conv_end, 0);
+        if (!is_number_arg_start(arg) || *conv_end != '\0' || errno != 0 ||
+            !store_int(member, binding->size, val)) {
+            ret = APPLY_BINDING_RET_ERROR_INVALID_ARG;
+        }
+
+        break;
+    }
+    case ARGPAR_BINDING_KIND_UINT:
+    {
+        unsigned long long val;
+
+        ARGPAR_ASSERT(arg);
+        errno = 0;
+        val = strtoull(arg, &conv_end, 0);
+        if (!is_number_arg_start(arg) || *conv_end != '\0' || errno != 0 || strchr(arg, '-') ||
+            val > uint_max(binding->size)) {
+            ret = APPLY_BINDING_RET_ERROR_INVALID_ARG;
+            break;
+        }
+
+        store_uint(member, binding->size, val);
+        break;
+    }
+    case ARGPAR_BINDING_KIND_REAL:
+    {
+        ARGPAR_ASSERT(arg);
+        errno = 0;
+
+        /*
+         * Convert with strtof() for a `float` member: converting a
+         * `double` which is out of the range of `float` is undefined.
+         */
+        if (binding->size == sizeof(float)) {
+            const float val = strtof(arg, &conv_end);
+
+            if (!is_number_arg_start(arg) || *conv_end != '\0' || errno != 0) {
+                ret = APPLY_BINDING_RET_ERROR_INVALID_ARG;
+                break;
+            }
+
+            *(float *) member = val;
+        } else {
+            const double val = strtod(arg, &conv_end);
+
+            ARGPAR_ASSERT(binding->size == sizeof(double));
+
+            if (!is_number_arg_start(arg) || *conv_end != '\0' || errno != 0) {
+                ret = APPLY_BINDING_RET_ERROR_INVALID_ARG;
+                break;
+            }
+
+            *(double *) member = val;
+        }
+
+        break;
+    }
+    case ARGPAR_BINDING_KIND_CHOICE:
+        ARGPAR_ASSERT(item->base.type == ARGPAR_ITEM_TYPE_OPT);
+        ARGPAR_ASSERT(item->opt.choice >= 0);
+        ARGPAR_ASSERT(binding->size == sizeof(int));
+        *(int *) member = item->opt.choice;
+        break;
+    case ARGPAR_BINDING_KIND_APPEND:
+    {
+        argpar_arg_list_t * const list = (argpar_arg_list_t *) member;
+
+        ARGPAR_ASSERT(arg);
+        ARGPAR_ASSERT(binding->size == sizeof(argpar_arg_list_t));
+
+        if (list->count == list->capacity) {
+            const unsigned int new_capacity = list->capacity == 0 ? 8 : list->capacity * 2;
+            const char ** const new_args =
+                ARGPAR_REALLOC(NULL, (void *) list->args, const char *, new_capacity);
+
+            if (!new_args) {
+                ret = APPLY_BINDING_RET_ERROR_MEMORY;
+                break;
+            }
+
+            list->args = new_args;
+            list->capacity = new_capacity;
+        }
+
+        list->args[list->count] = arg;
+        list->count++;
+        break;
+    }
+    default:
+        abort();
+    }
+
+    return ret;
+}
+
+ARGPAR_HIDDEN argpar_parse_into_status_t
+argpar_parse_into(const unsigned int argc, const char * const * const argv,
+                  const argpar_opt_descr_t * const descrs,
+                  const argpar_binding_t * const non_opt_binding, void * const target,
+                  const argpar_error_t ** const error)
+{
+    argpar_parse_into_status_t status = ARGPAR_PARSE_INTO_STATUS_OK;
+    argpar_iter_t * const iter = argpar_iter_create(argc, argv, descrs);
+    argpar_error_t pending_error;
+
+    ARGPAR_ASSERT(target);
+
+    if (error) {
+        *error = NULL;
+    }
+
+    if (!iter) {
+        status = ARGPAR_PARSE_INTO_STATUS_ERROR_MEMORY;
+        goto end;
+    }
+
+    ARGPAR_ASSERT(!non_opt_binding || non_opt_binding->kind == ARGPAR_BINDING_KIND_STR ||
+                  non_opt_binding->kind == ARGPAR_BINDING_KIND_APPEND);
+
+    for (;;) {
+        argpar_item_storage_t item;
+        apply_binding_ret_t apply_binding_ret = APPLY_BINDING_RET_OK;
+
+        switch (iter_next(iter, &item, &pending_error)) {
+        case ARGPAR_ITER_NEXT_STATUS_OK:
+            break;
+        case ARGPAR_ITER_NEXT_STATUS_END:
+            goto end;
+        case ARGPAR_ITER_NEXT_STATUS_ERROR:
+            status = ARGPAR_PARSE_INTO_STATUS_ERROR;
+            goto error;
+        default:
+            status = ARGPAR_PARSE_INTO_STATUS_ERROR_MEMORY;
+            goto end;
+        }
+
+        if (item.base.type == ARGPAR_ITEM_TYPE_OPT) {
+            apply_binding_ret =
+                apply_binding(&item.opt.descr->binding, target, &item, item.opt.arg);
+        } else if (non_opt_binding) {
+            apply_binding_ret = apply_binding(non_opt_binding, target, &item, item.non_opt.arg);
+        }
+
+        switch (apply_binding_ret) {
+        case APPLY_BINDING_RET_OK:
+            break;
+        case APPLY_BINDING_RET_ERROR_INVALID_ARG:
+            ARGPAR_ASSERT(item.base.type == ARGPAR_ITEM_TYPE_OPT);
+            status = ARGPAR_PARSE_INTO_STATUS_ERROR;
+            set_error(&pending_error, ARGPAR_ERROR_TYPE_INVALID_OPT_ARG, NULL, 0, item.opt.descr,
+                      item.opt.is_short);
+            pending_error.orig_index = item.opt.orig_index;
+            pending_error.invalid_opt_arg = item.opt.arg;
+            goto error;
+        default:
+            status = ARGPAR_PARSE_INTO_STATUS_ERROR_MEMORY;
+            goto end;
+        }
+    }
+
+error:
+    if (set_new_error(iter, &pending_error, error)) {
+        status = ARGPAR_PARSE_INTO_STATUS_ERROR_MEMORY;
+    }
+
+end:
+    argpar_iter_destroy(iter);
+    return status;
+}
+
+/* Parsing result (see argpar_parse()) */
+struct argpar_parse_result
+{
+    /* Allocator of this result, or `NULL` for the C library */
+    const argpar_allocator_t *allocator;
+
+    /* Items */
+    struct
+    {
+        argpar_item_storage_t *data;
+        unsigned int count;
+        unsigned int capacity;
+    } items;
+
+    /* Segments */
+    struct
+    {
+        argpar_segment_t *data;
+        unsigned int count;
+        unsigned int capacity;
+    } segments;
+
+    /*
+     * Permutation (with `ARGPAR_PARSE_FLAG_PERMUTE` only): item indexes
+     * of the options, in order, followed with the item indexes of the
+     * non-option arguments, in order.
+     *
+     * `data` and `non_opt_indexes` have the capacity of `items`.
+     */
+    struct
+    {
+        unsigned int *data;
+
+        /* Number of options */
+        unsigned int opt_count;
+
+        /*
+         * Item indexes of the non-option arguments during parsing,
+         * appended to `data` at the end of argpar_parse().
+         */
+        unsigned int *non_opt_indexes;
+        unsigned int non_opt_count;
+    } permutation;
+};
+
+/*
+ * Makes sure that `result` has room for one more item and, if
+ * `with_segment` is true, for one more segment.
+ *
+ * Returns 0 on success, or -1 on memory error.
+ */
+static int ensure_parse_result_room(argpar_parse_result_t * const result,
+                                    const bool with_segment)
+{
+    int ret = 0;
+
+    if (result->items.count == result->items.capacity) {
+        const unsigned int new_capacity = result->items.capacity * 2;
+        argpar_item_storage_t * const new_data =
+            ARGPAR_REALLOC(result->allocator, result->items.data, argpar_item_storage_t,
+                           new_capacity);
+
+        if (!new_data) {
+            goto error;
+        }
+
+        result->items.data = new_data;
+
+        if (result->permutation.data) {
+            unsigned int * const new_perm_data =
+                ARGPAR_REALLOC(result->allocator, result->permutation.data, unsigned int,
+                               new_capacity);
+            unsigned int *new_non_opt_indexes;
+
+            if (!new_perm_data) {
+                goto error;
+            }
+
+            result->permutation.data = new_perm_data;
+            new_non_opt_indexes =
+                ARGPAR_REALLOC(result->allocator, result->permutation.non_opt_indexes,
+                               unsigned int, new_capacity);
+
+            if (!new_non_opt_indexes) {
+                goto error;
+            }
+
+            result->permutation.non_opt_indexes = new_non_opt_indexes;
+        }
+
+        result->items.capacity = new_capacity;
+    }
+
+    if (with_segment && result->segments.count == result->segments.capacity) {
+        const unsigned int new_capacity = result->segments.capacity * 2;
+        argpar_segment_t * const new_data =
+            ARGPAR_REALLOC(result->allocator, result->segments.data, argpar_segment_t,
+                           new_capacity);
+
+        if (!new_data) {
+            goto error;
+        }
+
+        result->segments.data = new_data;
+        result->segments.capacity = new_capacity;
+    }
+
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+ARGPAR_HIDDEN argpar_parse_status_t argpar_parse_with_allocator(
+    const unsigned int argc, const char * const * const argv,
+    const argpar_opt_descr_t * const descrs, const unsigned int flags,
+    const argpar_allocator_t * const allocator, const argpar_parse_result_t ** const result,
+    const argpar_error_t ** const error)
+{
+    argpar_parse_status_t status = ARGPAR_PARSE_STATUS_OK;
+    argpar_iter_t * const iter = argpar_iter_create_with_allocator(argc, argv, descrs, allocator);
+    argpar_parse_result_t * const res = ARGPAR_ZALLOC(allocator, argpar_parse_result_t);
+    argpar_error_t pending_error;
+
+    ARGPAR_ASSERT(result);
+    *result = NULL;
+
+    if (error) {
+        *error = NULL;
+    }
+
+    if (res) {
+        res->allocator = allocator;
+    }
+
+    if (!iter || !res) {
+        goto error_memory;
+    }
+
+    /*
+     * Most original arguments make a single item: start with this
+     * capacity to avoid reallocating the item array.
+     */
+    res->items.capacity = argc > 0 ? argc : 1;
+    res->items.data = ARGPAR_CALLOC(allocator, argpar_item_storage_t, res->items.capacity);
+    res->segments.capacity = 4;
+    res->segments.data = ARGPAR_CALLOC(allocator, argpar_segment_t, res->segments.capacity);
+
+    if (!res->items.data || !res->segments.data) {
+        goto error_memory;
+    }
+
+    if (flags & ARGPAR_PARSE_FLAG_PERMUTE) {
+        res->permutation.data = ARGPAR_CALLOC(allocator, unsigned int, res->items.capacity);
+        res->permutation.non_opt_indexes =
+            ARGPAR_CALLOC(allocator, unsigned int, res->items.capacity);
+
+        if (!res->permutation.data || !res->permutation.non_opt_indexes) {
+            goto error_memory;
+        }
+    }
+
+    for (;;) {
+        argpar_item_storage_t item_storage;
+        const argpar_item_storage_t *item;
+        argpar_segment_t *seg;
+        unsigned int index;
+        bool opens_segment;
+
+        /*
+         * Parse into `item_storage` first so as to grow the arrays
+         * only when there's actually a new item.
+         */
+        switch (iter_next(iter, &item_storage, &pending_error)) {
+        case ARGPAR_ITER_NEXT_STATUS_OK:
+            break;
+        case ARGPAR_ITER_NEXT_STATUS_END:
+            goto success;
+        case ARGPAR_ITER_NEXT_STATUS_ERROR:
+            status = ARGPAR_PARSE_STATUS_ERROR;
+
+            if (set_new_error(iter, &pending_error, error)) {
+                status = ARGPAR_PARSE_STATUS_ERROR_MEMORY;
+            }
+
+            goto error;
+        default:
+            goto error_memory;
+        }
+
+        opens_segment = res->segments.count == 0 ||
+                        (item_storage.base.type == ARGPAR_ITEM_TYPE_OPT &&
+                         (item_storage.opt.descr->flags & ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER));
+
+        if (ensure_parse_result_room(res, opens_segment)) {
+            goto error_memory;
+        }
+
+        index = res->items.count;
+        res->items.data[index] = item_storage;
+        item = &res->items.data[index];
+        res->items.count++;
+
+        if (res->permutation.data) {
+            if (item->base.type == ARGPAR_ITEM_TYPE_OPT) {
+                res->permutation.data[res->permutation.opt_count] = index;
+                res->permutation.opt_count++;
+            } else {
+                res->permutation.non_opt_indexes[res->permutation.non_opt_count] = index;
+                res->permutation.non_opt_count++;
+            }
+        }
+
+        if (item->base.type == ARGPAR_ITEM_TYPE_OPT &&
+            (item->opt.descr->flags & ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER)) {
+            /* New segment with an opener */
+            seg = &res->segments.data[res->segments.count];
+            seg->opener_index = index;
+            seg->first_index = index;
+            res->segments.count++;
+        } else if (res->segments.count == 0) {
+            /* First segment without an opener */
+            seg = &res->segments.data[0];
+            seg->opener_index = ARGPAR_SEGMENT_NO_OPENER;
+            seg->first_index = index;
+            res->segments.count++;
+        } else {
+            /* Continue current segment */
+            seg = &res->segments.data[res->segments.count - 1];
+        }
+
+        seg->last_index = index;
+    }
+
+error_memory:
+    status = ARGPAR_PARSE_STATUS_ERROR_MEMORY;
+
+error:
+    argpar_parse_result_destroy(res);
+    goto end;
+
+success:
+    if (res->permutation.data) {
+        /* Non-option arguments follow the options */
+        memcpy(&res->permutation.data[res->permutation.opt_count],
+               res->permutation.non_opt_indexes,
+               res->permutation.non_opt_count * sizeof(*res->permutation.non_opt_indexes));
+        ARGPAR_FREE(res->allocator, res->permutation.non_opt_indexes);
+        res->permutation.non_opt_indexes = NULL;
+    }
+
+    *result = res;
+
+end:
+    argpar_iter_destroy(iter);
+    return status;
+}
+
+ARGPAR_HIDDEN argpar_parse_status_t argpar_parse(const unsigned int argc,
+                                                 const char * const * const argv,
+                                                 const argpar_opt_descr_t * const descrs,
+                                                 const unsigned int flags,
+                                                 const argpar_parse_result_t ** const result,
+                                                 const argpar_error_t ** const error)
+{
+    return argpar_parse_with_allocator(argc, argv, descrs, flags, NULL, result, error);
+}
+
+ARGPAR_HIDDEN unsigned int
+argpar_parse_result_item_count(const argpar_parse_result_t * const result)
+{
+    ARGPAR_ASSERT(result);
+    return result->items.count;
+}
+
+ARGPAR_HIDDEN const argpar_item_t *
+argpar_parse_result_item(const argpar_parse_result_t * const result, const unsigned int index)
+{
+    ARGPAR_ASSERT(result);
+    ARGPAR_ASSERT(index < result->items.count);
+    return &result->items.data[index].base;
+}
+
+ARGPAR_HIDDEN unsigned int
+argpar_parse_result_segment_count(const argpar_parse_result_t * const result)
+{
+    ARGPAR_ASSERT(result);
+    return result->segments.count;
+}
+
+ARGPAR_HIDDEN const argpar_segment_t *
+argpar_parse_result_segment(const argpar_parse_result_t * const result, const unsigned int index)
+{
+    ARGPAR_ASSERT(result);
+    ARGPAR_ASSERT(index < result->segments.count);
+    return &result->segments.data[index];
+}
+
+ARGPAR_HIDDEN const argpar_item_t *
+argpar_parse_result_permuted_item(const argpar_parse_result_t * const result,
+                                  const unsigned int index)
+{
+    ARGPAR_ASSERT(result);
+    ARGPAR_ASSERT(result->permutation.data);
+    ARGPAR_ASSERT(index < result->items.count);
+    return &result->items.data[result->permutation.data[index]].base;
+}
+
+ARGPAR_HIDDEN unsigned int argpar_parse_result_opt_count(const argpar_parse_result_t * const result)
+{
+    ARGPAR_ASSERT(result);
+    ARGPAR_ASSERT(result->permutation.data);
+    return result->permutation.opt_count;
+}
+
+ARGPAR_HIDDEN void argpar_parse_result_destroy(const argpar_parse_result_t * const result)
+{
+    if (result) {
+        ARGPAR_FREE(result->allocator, result->items.data);
+        ARGPAR_FREE(result->allocator, result->segments.data);
+        ARGPAR_FREE(result->allocator, result->permutation.data);
+        ARGPAR_FREE(result->allocator, result->permutation.non_opt_indexes);
+        ARGPAR_FREE(result->allocator, result);
+    }
+}
+
+/* Boundary of an original argument which isn't a safe boundary */
+#define REPARSER_NO_BOUNDARY UINT_MAX
+
+/*
+ * Parsing state at the beginning of an original argument of an
+ * incremental reparser.
+ */
+struct reparser_boundary
+{
+    /*
+     * If the original argument is a safe boundary (not the argument of
+     * a preceding option), number of items before it; otherwise,
+     * `REPARSER_NO_BOUNDARY`.
+     */
+    unsigned int item_count;
+
+    /* Non-option argument index of the iterator there */
+    int non_opt_index;
+};
+
+/*
+ * Incremental reparser: keeps the results of the last parse to resume
+ * the next one from the last safe boundary before the first changed
+ * original argument.
+ */
+struct argpar_reparser
+{
+    /* Allocator of this reparser, or `NULL` for the C library */
+    const argpar_allocator_t *allocator;
+
+    /* Iterator of which the original arguments are `args.data` */
+    argpar_iter_t *iter;
+
+    /* Retained copies of the original arguments of the last parse */
+    struct
+    {
+        char **data;
+        unsigned int count;
+        unsigned int capacity;
+    } args;
+
+    /*
+     * Parsing state at the beginning of each original argument, having
+     * the capacity of `args` plus one (the end is a boundary too).
+     *
+     * Only the `count` first entries are known: the last parse didn't
+     * reach the other original arguments.
+     */
+    struct
+    {
+        struct reparser_boundary *data;
+        unsigned int count;
+    } boundaries;
+
+    /* Items of the last parse */
+    struct
+    {
+        argpar_item_storage_t *data;
+        unsigned int count;
+        unsigned int capacity;
+    } items;
+
+    /* Number of original arguments which the last parse reused */
+    unsigned int reused_orig_args;
+};
+
+ARGPAR_HIDDEN argpar_reparser_t *
+argpar_reparser_create_with_allocator(const argpar_opt_descr_t * const descrs,
+                                      const argpar_allocator_t * const allocator)
+{
+    argpar_reparser_t *reparser = ARGPAR_ZALLOC(allocator, argpar_reparser_t);
+
+    if (!reparser) {
+        goto end;
+    }
+
+    reparser->allocator = allocator;
+    reparser->iter = create_iter(0, NULL, descrs, NULL, allocator);
+    reparser->boundaries.data = ARGPAR_ZALLOC(allocator, struct reparser_boundary);
+    reparser->items.capacity = 8;
+    reparser->items.data =
+        ARGPAR_CALLOC(allocator, argpar_item_storage_t, reparser->items.capacity);
+
+    if (!reparser->iter || !reparser->boundaries.data || !reparser->items.data) {
+        goto error;
+    }
+
+    /* The beginning is always a boundary */
+    reparser->boundaries.count = 1;
+    goto end;
+
+error:
+    argpar_reparser_destroy(reparser);
+    reparser = NULL;
+
+end:
+    return reparser;
+}
+
+ARGPAR_HIDDEN argpar_reparser_t *argpar_reparser_create(const argpar_opt_descr_t * const descrs)
+{
+    return argpar_reparser_create_with_allocator(descrs, NULL);
+}
+
+/*
+ * Makes sure that `reparser` has room for `argc` original arguments.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int ensure_reparser_arg_room(argpar_reparser_t * const reparser, const unsigned int argc)
+{
+    int ret = 0;
+    unsigned int new_capacity = reparser->args.capacity > 0 ? reparser->args.capacity : 8;
+    char **new_args;
+    struct reparser_boundary *new_boundaries;
+
+    if (argc <= reparser->args.capacity) {
+        goto end;
+    }
+
+    while (new_capacity < argc) {
+        new_capacity *= 2;
+    }
+
+    new_args = ARGPAR_REALLOC(reparser->allocator, reparser->args.data, char *, new_capacity);
+    if (!new_args) {
+        goto error;
+    }
+
+    reparser->args.data = new_args;
+    new_boundaries = ARGPAR_REALLOC(reparser->allocator, reparser->boundaries.data,
+                                    struct reparser_boundary, new_capacity + 1);
+    if (!new_boundaries) {
+        goto error;
+    }
+
+    reparser->boundaries.data = new_boundaries;
+    reparser->args.capacity = new_capacity;
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+/*
+ * Replaces the retained original arguments of `reparser`, from the
+ * index `first`, with copies of the original arguments `argv` (`argc`
+ * of them) from the same index.
+ *
+ * Returns 0 on success or -1 on memory error.
+ */
+static int replace_reparser_args(argpar_reparser_t * const reparser, const unsigned int first,
+                                 const unsigned int argc, const char * const * const argv)
+{
+    int ret = 0;
+    unsigned int i;
+
+    for (i = first; i < reparser->args.count; i++) {
+        ARGPAR_FREE(reparser->allocator, reparser->args.data[i]);
+    }
+
+    reparser->args.count = first;
+
+    if (ensure_reparser_arg_room(reparser, argc)) {
+        goto error;
+    }
+
+    for (i = first; i < argc; i++) {
+        const size_t size = strlen(argv[i]) + 1;
+        char * const arg = ARGPAR_CALLOC(reparser->allocator, char, size);
+
+        if (!arg) {
+            goto error;
+        }
+
+        memcpy(arg, argv[i], size);
+        reparser->args.data[i] = arg;
+        reparser->args.count++;
+    }
+
+    goto end;
+
+error:
+    ret = -1;
+
+end:
+    return ret;
+}
+
+/*
+ * Records, in `reparser`, that its iterator is at the beginning of an
+ * original argument, and that it skipped the original arguments since
+ * the last recorded boundary.
+ */
+static void record_reparser_boundary(argpar_reparser_t * const reparser)
+{
+    const argpar_iter_t * const iter = reparser->iter;
+
+    for (; reparser->boundaries.count < iter->i; reparser->boundaries.count++) {
+        reparser->boundaries.data[reparser->boundaries.count].item_count = REPARSER_NO_BOUNDARY;
+    }
+
+    reparser->boundaries.data[iter->i].item_count = reparser->items.count;
+    reparser->boundaries.data[iter->i].non_opt_index = iter->non_opt_index;
+    reparser->boundaries.count = iter->i + 1;
+}
+
+ARGPAR_HIDDEN argpar_parse_status_t
+argpar_reparser_parse(argpar_reparser_t * const reparser, const unsigned int argc,
+                      const char * const * const argv, const argpar_error_t ** const error)
+{
+    argpar_parse_status_t status = ARGPAR_PARSE_STATUS_OK;
+    argpar_iter_t * const iter = reparser->iter;
+    unsigned int first_changed = 0;
+    unsigned int resume;
+    argpar_error_t pending_error;
+
+    ARGPAR_ASSERT(argv || argc == 0);
+
+    if (error) {
+        *error = NULL;
+    }
+
+    /* Find the first changed original argument */
+    while (first_changed < argc && first_changed < reparser->args.count &&
+           strcmp(reparser->args.data[first_changed], argv[first_changed]) == 0) {
+        first_changed++;
+    }
+
+    /*
+     * Resume from the last known safe boundary at or before it: any
+     * item before this boundary only depends on unchanged original
+     * arguments.
+     */
+    resume = first_changed < reparser->boundaries.count ? first_changed :
+                                                          reparser->boundaries.count - 1;
+
+    while (reparser->boundaries.data[resume].item_count == REPARSER_NO_BOUNDARY) {
+        ARGPAR_ASSERT(resume > 0);
+        resume--;
+    }
+
+    reparser->reused_orig_args = resume;
+    reparser->items.count = reparser->boundaries.data[resume].item_count;
+    reparser->boundaries.count = resume + 1;
+
+    if (replace_reparser_args(reparser, first_changed, argc, argv)) {
+        goto error_memory;
+    }
+
+    iter->user.argc = argc;
+    iter->user.argv = (const char * const *) reparser->args.data;
+    iter->i = resume;
+    iter->non_opt_index = reparser->boundaries.data[resume].non_opt_index;
+    iter->short_opt_group_ch = NULL;
+
+    for (;;) {
+        if (!iter->short_opt_group_ch) {
+            record_reparser_boundary(reparser);
+        }
+
+        if (reparser->items.count == reparser->items.capacity) {
+            const unsigned int new_capacity = reparser->items.capacity * 2;
+            argpar_item_storage_t * const new_data =
+                ARGPAR_REALLOC(reparser->allocator, reparser->items.data,
+                               argpar_item_storage_t, new_capacity);
+
+            if (!new_data) {
+                goto error_memory;
+            }
+
+            reparser->items.data = new_data;
+            reparser->items.capacity = new_capacity;
+        }
+
+        switch (iter_next(iter, &reparser->items.data[reparser->items.count], &pending_error)) {
+        case ARGPAR_ITER_NEXT_STATUS_OK:
+            reparser->items.count++;
+            break;
+        case ARGPAR_ITER_NEXT_STATUS_END:
+            goto end;
+        case ARGPAR_ITER_NEXT_STATUS_ERROR:
+            status = ARGPAR_PARSE_STATUS_ERROR;
 
-    /* Create and append option argument */
-    opt_item = create_opt_item(descr, opt_arg);
-    if (!opt_item) {
-        goto error;
-    }
+            if (set_new_error(iter, &pending_error, error)) {
+                status = ARGPAR_PARSE_STATUS_ERROR_MEMORY;
+            }
 
-    if (used_next_orig_arg) {
-        iter->i += 2;
-    } else {
-        iter->i++;
+            goto end;
+        default:
+            goto error_memory;
+        }
     }
 
-    *item = &opt_item->base;
-    goto end;
-
-error:
-    ARGPAR_ASSERT(ret != PARSE_ORIG_ARG_OPT_RET_OK);
+error_memory:
+    /* Start over on the next parse */
+    status = ARGPAR_PARSE_STATUS_ERROR_MEMORY;
+    reparser->items.count = 0;
+    reparser->boundaries.count = 1;
+    reparser->reused_orig_args = 0;
 
 end:
-    return ret;
+    return status;
+}
+
+ARGPAR_HIDDEN unsigned int argpar_reparser_item_count(const argpar_reparser_t * const reparser)
+{
+    ARGPAR_ASSERT(reparser);
+    return reparser->items.count;
+}
+
+ARGPAR_HIDDEN const argpar_item_t *argpar_reparser_item(const argpar_reparser_t * const reparser,
+                                                       const unsigned int index)
+{
+    ARGPAR_ASSERT(reparser);
+    ARGPAR_ASSERT(index < reparser->items.count);
+    return &reparser->items.data[index].base;
+}
+
+ARGPAR_HIDDEN unsigned int
+argpar_reparser_reused_orig_args(const argpar_reparser_t * const reparser)
+{
+    ARGPAR_ASSERT(reparser);
+    return reparser->reused_orig_args;
 }
 
+ARGPAR_HIDDEN void argpar_reparser_destroy(const argpar_reparser_t * const reparser)
+{
+    if (reparser) {
+        unsigned int i;
+
+        for (i = 0; i < reparser->args.count; i++) {
+            ARGPAR_FREE(reparser->allocator, reparser->args.data[i]);
+        }
+
+        argpar_iter_destroy(reparser->iter);
+        ARGPAR_FREE(reparser->allocator, reparser->args.data);
+        ARGPAR_FREE(reparser->allocator, reparser->boundaries.data);
+        ARGPAR_FREE(reparser->allocator, reparser->items.data);
+        ARGPAR_FREE(reparser->allocator, reparser);
+    }
+}
+
+/* 128-bit FNV-1a hash state (see argpar_fingerprint()) */
+struct hash128
+{
+    unsigned long long high;
+    unsigned long long low;
+};
+
 /*
- * Parses the original argument `orig_arg`.
- *
- * On success, sets `*item`.
- *
- * On error (except for `PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY`), sets
- * `*error`.
+ * Multiplies the hash `hash` by the 128-bit FNV prime,
+ * 2^88 + 0x13b, modulo 2^128.
  */
-static parse_orig_arg_opt_ret_t
-parse_orig_arg_opt(const char * const orig_arg, const char * const next_orig_arg,
-                   const argpar_opt_descr_t * const descrs, argpar_iter_t * const iter,
-                   argpar_error_t ** const error, argpar_item_t ** const item)
+static void hash128_mul_prime(struct hash128 * const hash)
 {
-    parse_orig_arg_opt_ret_t ret = PARSE_ORIG_ARG_OPT_RET_OK;
+    /* `hash->low` times 0x13b, by 32-bit halves */
+    const unsigned long long low_low = (hash->low & 0xffffffffULL) * 0x13bULL;
+    const unsigned long long low_high = (hash->low >> 32) * 0x13bULL;
+    const unsigned long long mid = (low_low >> 32) + (low_high & 0xffffffffULL);
 
-    ARGPAR_ASSERT(orig_arg[0] == '-');
+    hash->high = hash->high * 0x13bULL + (low_high >> 32) + (mid >> 32) + (hash->low << 24);
+    hash->low = (low_low & 0xffffffffULL) | (mid << 32);
+}
 
-    if (orig_arg[1] == '-') {
-        /* Long option */
-        ret = parse_long_opt(&orig_arg[2], next_orig_arg, descrs, iter, error, item);
-    } else {
-        /* Short option */
-        ret = parse_short_opt_group(&orig_arg[1], next_orig_arg, descrs, iter, error, item);
+/* Initializes the hash `hash` to the 128-bit FNV offset basis */
+static void hash128_init(struct hash128 * const hash)
+{
+    hash->high = 0x6c62272e07bb0142ULL;
+    hash->low = 0x62b821756295c58dULL;
+}
+
+/* Adds the `len` bytes `data` to the hash `hash` */
+static void hash128_add(struct hash128 * const hash, const void * const data, const size_t len)
+{
+    const unsigned char * const bytes = data;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash->low ^= bytes[i];
+        hash128_mul_prime(hash);
     }
+}
 
-    return ret;
+/*
+ * Adds the normalized form of the item `item` to the hash `hash` (see
+ * argpar_fingerprint()).
+ */
+static void hash_fingerprint_item(struct hash128 * const hash,
+                                  const argpar_item_storage_t * const item)
+{
+    if (item->base.type == ARGPAR_ITEM_TYPE_OPT) {
+        const unsigned int id = (unsigned int) item->opt.descr->id;
+        const unsigned char head[] = {
+            item->opt.negated ? 'n' : 'o',
+            (unsigned char) (id & 0xff),
+            (unsigned char) ((id >> 8) & 0xff),
+            (unsigned char) ((id >> 16) & 0xff),
+            (unsigned char) ((id >> 24) & 0xff),
+        };
+
+        hash128_add(hash, head, sizeof(head));
+
+        if (item->opt.arg) {
+            hash128_add(hash, "a", 1);
+            hash128_add(hash, item->opt.arg, strlen(item->opt.arg) + 1);
+        }
+    } else {
+        hash128_add(hash, "p", 1);
+        hash128_add(hash, item->non_opt.arg, strlen(item->non_opt.arg) + 1);
+    }
 }
 
-ARGPAR_HIDDEN argpar_iter_t *argpar_iter_create(const unsigned int argc,
-                                                const char * const * const argv,
-                                                const argpar_opt_descr_t * const descrs)
+ARGPAR_HIDDEN argpar_fingerprint_status_t
+argpar_fingerprint(const unsigned int argc, const char * const * const argv,
+                   const argpar_opt_descr_t * const descrs,
+                   argpar_hash128_t * const fingerprint, const argpar_error_t ** const error)
 {
-    argpar_iter_t *iter = ARGPAR_ZALLOC(argpar_iter_t);
+    argpar_fingerprint_status_t status = ARGPAR_FINGERPRINT_STATUS_OK;
+    argpar_iter_t * const iter = argpar_iter_create(argc, argv, descrs);
+    argpar_error_t pending_error;
+    argpar_item_storage_t item;
+    argpar_iter_next_status_t next_status;
+    struct hash128 ordered;
+
+    /* Sum of the hashes of the order-insensitive items */
+    struct hash128 unordered = {0, 0};
+
+    ARGPAR_ASSERT(fingerprint);
+
+    if (error) {
+        *error = NULL;
+    }
 
     if (!iter) {
+        status = ARGPAR_FINGERPRINT_STATUS_ERROR_MEMORY;
         goto end;
     }
 
-    iter->user.argc = argc;
-    iter->user.argv = argv;
-    iter->user.descrs = descrs;
-    iter->tmp_buf.size = 128;
-    iter->tmp_buf.data = ARGPAR_CALLOC(char, iter->tmp_buf.size);
-    if (!iter->tmp_buf.data) {
-        argpar_iter_destroy(iter);
-        iter = NULL;
+    hash128_init(&ordered);
+
+    while ((next_status = iter_next(iter, &item, &pending_error)) ==
+           ARGPAR_ITER_NEXT_STATUS_OK) {
+        if (item.base.type == ARGPAR_ITEM_TYPE_OPT &&
+            (item.opt.descr->flags & ARGPAR_OPT_DESCR_FLAG_ORDER_INSENSITIVE)) {
+            struct hash128 item_hash;
+
+            hash128_init(&item_hash);
+            hash_fingerprint_item(&item_hash, &item);
+            unordered.low += item_hash.low;
+            unordered.high += item_hash.high + (unordered.low < item_hash.low);
+        } else {
+            hash_fingerprint_item(&ordered, &item);
+        }
+    }
+
+    switch (next_status) {
+    case ARGPAR_ITER_NEXT_STATUS_END:
+        break;
+    case ARGPAR_ITER_NEXT_STATUS_ERROR:
+        status = ARGPAR_FINGERPRINT_STATUS_ERROR;
+
+        if (set_new_error(iter, &pending_error, error)) {
+            status = ARGPAR_FINGERPRINT_STATUS_ERROR_MEMORY;
+        }
+
+        goto end;
+    default:
+        status = ARGPAR_FINGERPRINT_STATUS_ERROR_MEMORY;
         goto end;
     }
 
+    /* Finish with the sum, most significant byte first */
+    {
+        unsigned char sum[17] = {'s'};
+        unsigned int i;
+
+        for (i = 0; i < 8; i++) {
+            sum[1 + i] = (unsigned char) ((unordered.high >> (56 - 8 * i)) & 0xff);
+            sum[9 + i] = (unsigned char) ((unordered.low >> (56 - 8 * i)) & 0xff);
+        }
+
+        hash128_add(&ordered, sum, sizeof(sum));
+    }
+
+    fingerprint->high = ordered.high;
+    fingerprint->low = ordered.low;
+
 end:
-    return iter;
+    argpar_iter_destroy(iter);
+    return status;
 }
 
-ARGPAR_HIDDEN void argpar_iter_destroy(argpar_iter_t * const iter)
+ARGPAR_HIDDEN size_t argpar_slice_unescape(const argpar_slice_t slice, const char escape_ch,
+                                           char * const buf)
 {
-    if (iter) {
-        free(iter->tmp_buf.data);
-        free(iter);
+    size_t i;
+    size_t len = 0;
+
+    ARGPAR_ASSERT(buf);
+
+    for (i = 0; i < slice.len; i++) {
+        if (slice.ptr[i] == escape_ch && i + 1 < slice.len) {
+            /* Keep the escaped character */
+            i++;
+        }
+
+        buf[len] = slice.ptr[i];
+        len++;
     }
+
+    buf[len] = '\0';
+    return len;
 }
 
-ARGPAR_HIDDEN argpar_iter_next_status_t argpar_iter_next(argpar_iter_t * const iter,
-                                                         const argpar_item_t ** const item,
-                                                         const argpar_error_t ** const error)
+/* Parsing state of a key-value argument iterator */
+typedef enum kv_iter_state
 {
-    argpar_iter_next_status_t status;
-    parse_orig_arg_opt_ret_t parse_orig_arg_opt_ret;
-    const char *orig_arg;
-    const char *next_orig_arg;
-    argpar_error_t ** const nc_error = (argpar_error_t **) error;
+    /* At the beginning of the argument, of an array, or of a map */
+    KV_ITER_STATE_FIRST_ENTRY,
 
-    ARGPAR_ASSERT(iter->i <= iter->user.argc);
+    /* After a `,` separator: expecting an entry */
+    KV_ITER_STATE_ENTRY,
 
-    if (error) {
-        *nc_error = NULL;
+    /* After an entry: expecting a `,` separator or the end */
+    KV_ITER_STATE_AFTER_ENTRY,
+
+    /* End of iteration */
+    KV_ITER_STATE_END,
+
+    /* Syntax error */
+    KV_ITER_STATE_ERROR,
+} kv_iter_state_t;
+
+/*
+ * Returns whether or not `ch` may be the first character of a key.
+ */
+static bool kv_is_key_first_ch(const char ch)
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+/*
+ * Returns whether or not `ch` may be a non-first character of a key.
+ */
+static bool kv_is_key_ch(const char ch)
+{
+    return kv_is_key_first_ch(ch) || (ch >= '0' && ch <= '9') || ch == '-' || ch == '.' ||
+           ch == ':';
+}
+
+/*
+ * Returns whether or not `ch` ends an unquoted scalar.
+ */
+static bool kv_is_unquoted_scalar_end_ch(const char ch)
+{
+    return ch == '\0' || ch == ' ' || ch == '\t' || ch == '"' || ch == ',' || ch == '=' ||
+           ch == '[' || ch == ']' || ch == '{' || ch == '}';
+}
+
+/*
+ * Skips the spaces and tabs at the current position of `iter`.
+ */
+static void kv_skip_ws(argpar_kv_iter_t * const iter)
+{
+    while (*iter->pos == ' ' || *iter->pos == '\t') {
+        iter->pos++;
     }
+}
 
-    if (iter->i == iter->user.argc) {
-        status = ARGPAR_ITER_NEXT_STATUS_END;
+/*
+ * Returns whether or not the slice `slice` is exactly `str`.
+ */
+static bool slice_eq(const argpar_slice_t slice, const char * const str)
+{
+    return strncmp(slice.ptr, str, slice.len) == 0 && str[slice.len] == '\0';
+}
+
+/*
+ * Sets the scalar type and value of `item` from its unquoted scalar
+ * value slice.
+ */
+static void kv_set_unquoted_scalar(argpar_kv_item_t * const item)
+{
+    const argpar_slice_t value = item->value;
+    const char * const end = value.ptr + value.len;
+    const char first_ch = value.ptr[0];
+    char *conv_end;
+
+    if (slice_eq(value, "null") || slice_eq(value, "NULL") || slice_eq(value, "nul")) {
+        item->scalar_type = ARGPAR_KV_SCALAR_TYPE_NULL;
         goto end;
     }
 
-    orig_arg = iter->user.argv[iter->i];
-    next_orig_arg = iter->i < (iter->user.argc - 1) ? iter->user.argv[iter->i + 1] : NULL;
+    if (slice_eq(value, "true") || slice_eq(value, "TRUE") || slice_eq(value, "yes") ||
+        slice_eq(value, "YES")) {
+        item->scalar_type = ARGPAR_KV_SCALAR_TYPE_BOOL;
+        item->bool_val = true;
+        goto end;
+    }
 
-    if (strcmp(orig_arg, "-") == 0 || strcmp(orig_arg, "--") == 0 || orig_arg[0] != '-') {
-        /* Non-option argument */
-        const argpar_item_non_opt_t * const non_opt_item =
-            create_non_opt_item(orig_arg, iter->i, iter->non_opt_index);
+    if (slice_eq(value, "false") || slice_eq(value, "FALSE") || slice_eq(value, "no") ||
+        slice_eq(value, "NO")) {
+        item->scalar_type = ARGPAR_KV_SCALAR_TYPE_BOOL;
+        item->bool_val = false;
+        goto end;
+    }
 
-        if (!non_opt_item) {
-            status = ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY;
+    /*
+     * Numbers: an unquoted scalar never contains a character which
+     * strtoll() or strtod() could consume beyond its end.
+     */
+    if (!((first_ch >= '0' && first_ch <= '9') || first_ch == '+' || first_ch == '-' ||
+          first_ch == '.')) {
+        item->scalar_type = ARGPAR_KV_SCALAR_TYPE_STRING;
+        goto end;
+    }
+
+    errno = 0;
+
+    if (first_ch == '+') {
+        if (value.len > 1 && value.ptr[1] != '-' && value.ptr[1] != '+') {
+            item->uint_val = strtoull(value.ptr + 1, &conv_end, 0);
+            if (conv_end == end && errno == 0) {
+                item->scalar_type = ARGPAR_KV_SCALAR_TYPE_UNSIGNED_INT;
+                goto end;
+            }
+        }
+    } else {
+        item->int_val = strtoll(value.ptr, &conv_end, 0);
+        if (conv_end == end && errno == 0) {
+            item->scalar_type = ARGPAR_KV_SCALAR_TYPE_SIGNED_INT;
             goto end;
         }
+    }
 
-        iter->non_opt_index++;
-        iter->i++;
-        *item = &non_opt_item->base;
-        status = ARGPAR_ITER_NEXT_STATUS_OK;
+    errno = 0;
+    item->real_val = strtod(value.ptr, &conv_end);
+    if (conv_end == end && errno == 0) {
+        item->scalar_type = ARGPAR_KV_SCALAR_TYPE_REAL;
         goto end;
     }
 
-    /* Option argument */
-    parse_orig_arg_opt_ret = parse_orig_arg_opt(orig_arg, next_orig_arg, iter->user.descrs, iter,
-                                                nc_error, (argpar_item_t **) item);
-    switch (parse_orig_arg_opt_ret) {
-    case PARSE_ORIG_ARG_OPT_RET_OK:
-        status = ARGPAR_ITER_NEXT_STATUS_OK;
-        break;
-    case PARSE_ORIG_ARG_OPT_RET_ERROR:
-        if (error) {
-            ARGPAR_ASSERT(*error);
-            (*nc_error)->orig_index = iter->i;
+    item->scalar_type = ARGPAR_KV_SCALAR_TYPE_STRING;
+
+end:
+    return;
+}
+
+/*
+ * Parses the value at the current position of `iter`, setting `*item`
+ * accordingly.
+ *
+ * Returns `false` on syntax error.
+ */
+static bool kv_parse_value(argpar_kv_iter_t * const iter, argpar_kv_item_t * const item)
+{
+    bool ret = true;
+
+    switch (*iter->pos) {
+    case '[':
+    case '{':
+        if (iter->depth == ARGPAR_KV_MAX_DEPTH) {
+            ret = false;
+            goto end;
         }
-        status = ARGPAR_ITER_NEXT_STATUS_ERROR;
+
+        item->type = *iter->pos == '[' ? ARGPAR_KV_ITEM_TYPE_ARRAY_BEGIN :
+                                         ARGPAR_KV_ITEM_TYPE_MAP_BEGIN;
+        iter->containers[iter->depth] = *iter->pos;
+        iter->depth++;
+        iter->pos++;
+        iter->state = KV_ITER_STATE_FIRST_ENTRY;
+        goto end;
+    case '"':
+        /* Double-quoted string */
+        iter->pos++;
+        item->value.ptr = iter->pos;
+
+        while (*iter->pos != '"') {
+            if (*iter->pos == '\0') {
+                /* Unterminated string */
+                ret = false;
+                goto end;
+            }
+
+            if (*iter->pos == '\\') {
+                item->value_has_escapes = true;
+                iter->pos++;
+
+                if (*iter->pos == '\0') {
+                    ret = false;
+                    goto end;
+                }
+            }
+
+            iter->pos++;
+        }
+
+        item->type = ARGPAR_KV_ITEM_TYPE_SCALAR;
+        item->scalar_type = ARGPAR_KV_SCALAR_TYPE_STRING;
+        item->value.len = iter->pos - item->value.ptr;
+        iter->pos++;
         break;
-    case PARSE_ORIG_ARG_OPT_RET_ERROR_MEMORY:
-        status = ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY;
+    default:
+        /* Unquoted scalar */
+        item->value.ptr = iter->pos;
+
+        while (!kv_is_unquoted_scalar_end_ch(*iter->pos)) {
+            iter->pos++;
+        }
+
+        item->value.len = iter->pos - item->value.ptr;
+        if (item->value.len == 0) {
+            ret = false;
+            goto end;
+        }
+
+        item->type = ARGPAR_KV_ITEM_TYPE_SCALAR;
+        kv_set_unquoted_scalar(item);
         break;
+    }
+
+    iter->state = KV_ITER_STATE_AFTER_ENTRY;
+
+end:
+    return ret;
+}
+
+ARGPAR_HIDDEN void argpar_kv_iter_init(argpar_kv_iter_t * const iter, const char * const arg)
+{
+    ARGPAR_ASSERT(iter);
+    ARGPAR_ASSERT(arg);
+    iter->arg = arg;
+    iter->pos = arg;
+    iter->state = KV_ITER_STATE_FIRST_ENTRY;
+    iter->depth = 0;
+}
+
+ARGPAR_HIDDEN argpar_kv_iter_next_status_t argpar_kv_iter_next(argpar_kv_iter_t * const iter,
+                                                               argpar_kv_item_t * const item)
+{
+    argpar_kv_iter_next_status_t status = ARGPAR_KV_ITER_NEXT_STATUS_OK;
+    const char container = iter->depth == 0 ? '\0' : iter->containers[iter->depth - 1];
+
+    ARGPAR_ASSERT(item);
+
+    switch (iter->state) {
+    case KV_ITER_STATE_END:
+        status = ARGPAR_KV_ITER_NEXT_STATUS_END;
+        goto end;
+    case KV_ITER_STATE_ERROR:
+        goto error;
     default:
-        abort();
+        break;
+    }
+
+    memset(item, 0, sizeof(*item));
+    kv_skip_ws(iter);
+
+    if (iter->state == KV_ITER_STATE_AFTER_ENTRY) {
+        if (*iter->pos == ',') {
+            iter->pos++;
+            iter->state = KV_ITER_STATE_ENTRY;
+            kv_skip_ws(iter);
+        } else if (*iter->pos != '\0' && *iter->pos != ']' && *iter->pos != '}') {
+            goto error;
+        }
     }
 
+    if (iter->state != KV_ITER_STATE_ENTRY) {
+        /* End of argument, array, or map? */
+        if (*iter->pos == '\0') {
+            if (container != '\0') {
+                /* Unterminated array or map */
+                goto error;
+            }
+
+            iter->state = KV_ITER_STATE_END;
+            status = ARGPAR_KV_ITER_NEXT_STATUS_END;
+            goto end;
+        } else if (*iter->pos == ']' || *iter->pos == '}') {
+            if (container != (*iter->pos == ']' ? '[' : '{')) {
+                goto error;
+            }
+
+            item->type = *iter->pos == ']' ? ARGPAR_KV_ITEM_TYPE_ARRAY_END :
+                                             ARGPAR_KV_ITEM_TYPE_MAP_END;
+            iter->depth--;
+            iter->pos++;
+            iter->state = KV_ITER_STATE_AFTER_ENTRY;
+            goto end;
+        }
+    }
+
+    /* Entry: key (not within an array) */
+    if (container != '[') {
+        if (!kv_is_key_first_ch(*iter->pos)) {
+            goto error;
+        }
+
+        item->key.ptr = iter->pos;
+
+        while (kv_is_key_ch(*iter->pos)) {
+            iter->pos++;
+        }
+
+        item->key.len = iter->pos - item->key.ptr;
+        kv_skip_ws(iter);
+
+        if (*iter->pos != '=') {
+            goto error;
+        }
+
+        iter->pos++;
+        kv_skip_ws(iter);
+    }
+
+    /* Entry: value */
+    if (!kv_parse_value(iter, item)) {
+        goto error;
+    }
+
+    goto end;
+
+error:
+    iter->state = KV_ITER_STATE_ERROR;
+    status = ARGPAR_KV_ITER_NEXT_STATUS_ERROR;
+
 end:
     return status;
 }
 
-ARGPAR_HIDDEN unsigned int argpar_iter_ingested_orig_args(const argpar_iter_t * const iter)
+ARGPAR_HIDDEN size_t argpar_kv_iter_offset(const argpar_kv_iter_t * const iter)
 {
-    return iter->i;
+    ARGPAR_ASSERT(iter);
+    return iter->pos - iter->arg;
 }
@@ -8,6 +8,8 @@
 #define ARGPAR_ARGPAR_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -56,6 +58,14 @@ The argpar parser supports:
     --security enable --time=18.56
     @endcode
 
+  <li>
+    Negated long options, for option descriptors having the
+    #ARGPAR_OPT_DESCR_FLAG_NEGATABLE flag:
+
+    @code{.unparsed}
+    --color --no-color
+    @endcode
+
   <li>
     Non-option arguments (anything else, including
     <code>-</code> and <code>\--</code>).
@@ -119,6 +129,59 @@ argpar_iter_next() produces the following items, in this order:
 
 typedef struct argpar_opt_descr argpar_opt_descr_t;
 
+/*!
+@name String slice API
+@{
+*/
+
+/*!
+@brief
+    String slice
+
+A string slice points to \p len characters within some existing string
+(for example, an original argument) without owning them: the
+characters are \em not necessarily followed by a null character.
+*/
+typedef struct argpar_slice
+{
+    /// First character of the slice
+    const char *ptr;
+
+    /// Number of characters of the slice
+    size_t len;
+} argpar_slice_t;
+
+/*!
+@brief
+    Copies the characters of the slice \p slice to \p buf, removing each
+    escape character \p escape_ch (keeping the character which follows
+    it), and then appends a null character.
+
+For example, with <code>'\\'</code> as \p escape_ch, this function
+copies <code>say \\"hi\\" \\\\o/</code> as
+<code>say "hi" \\o/</code>.
+
+This function never allocates memory.
+
+@param[in] slice
+    Slice to copy and unescape.
+@param[in] escape_ch
+    Escape character.
+@param[out] buf
+    Destination buffer, of which the size is at least
+    <code>slice.len + 1</code>.
+
+@returns
+    Number of characters written to \p buf, excluding the terminating
+    null character.
+
+@pre
+    \p buf is not \c NULL.
+*/
+size_t argpar_slice_unescape(argpar_slice_t slice, char escape_ch, char *buf) ARGPAR_NOEXCEPT;
+
+/// @}
+
 /*!
 @name Item API
 @{
@@ -185,6 +248,9 @@ const argpar_opt_descr_t *argpar_item_opt_descr(const argpar_item_t *item) ARGPA
     Returns the argument of the option parsing item \p item, or
     \c NULL if none.
 
+The returned string points within one of the entries of the original
+arguments (in \p argv, as passed to argpar_iter_create()).
+
 @param[in] item
     Option parsing item of which to get the argument.
 
@@ -198,6 +264,183 @@ const argpar_opt_descr_t *argpar_item_opt_descr(const argpar_item_t *item) ARGPA
 */
 const char *argpar_item_opt_arg(const argpar_item_t *item) ARGPAR_NOEXCEPT;
 
+/*!
+@brief
+    Returns whether or not the option parsing item \p item is the
+    negated form (<code>\--no-NAME</code>) of its option.
+
+argpar_iter_next() only produces negated option items for option
+descriptors having the #ARGPAR_OPT_DESCR_FLAG_NEGATABLE flag.
+
+@param[in] item
+    Option parsing item of which to get whether or not it's negated.
+
+@returns
+    \c true if \p item is negated.
+
+@pre
+    \p item is not \c NULL.
+@pre
+    \p item has the type #ARGPAR_ITEM_TYPE_OPT.
+*/
+bool argpar_item_opt_is_negated(const argpar_item_t *item) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the namespace prefix of the option descriptor of the
+    option parsing item \p item, or \c NULL if the descriptor isn't
+    part of a namespace.
+
+See argpar_iter_add_namespace().
+
+@param[in] item
+    Option parsing item of which to get the namespace prefix.
+
+@returns
+    Namespace prefix of \p item, as passed to
+    argpar_iter_add_namespace(), or \c NULL if none.
+
+@pre
+    \p item is not \c NULL.
+@pre
+    \p item has the type #ARGPAR_ITEM_TYPE_OPT.
+*/
+const char *argpar_item_opt_namespace(const argpar_item_t *item) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the index, within the choices of its option descriptor (see
+    argpar_opt_descr::choices), of the argument of the option parsing
+    item \p item.
+
+@param[in] item
+    Option parsing item of which to get the index of the choice.
+
+@returns
+    Index of the choice of \p item.
+
+@pre
+    \p item is not \c NULL.
+@pre
+    \p item has the type #ARGPAR_ITEM_TYPE_OPT.
+@pre
+    The option descriptor of \p item has choices.
+*/
+unsigned int argpar_item_opt_choice(const argpar_item_t *item) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the number of elements of the list argument of the option
+    parsing item \p item.
+
+The option descriptor of \p item has a list delimiter (see
+argpar_opt_descr::list_delim): this function splits the argument of
+\p item on each list delimiter which the list escape character (see
+argpar_opt_descr::list_escape), if any, doesn't escape.
+
+An empty argument has no elements. Otherwise, the number of elements
+is the number of unescaped list delimiters plus one: this function
+counts empty elements.
+
+This function scans the argument on each call: it never modifies
+\p item, which may be borrowed or owned by a parsing result, and never
+copies the argument.
+
+@param[in] item
+    Option parsing item of which to get the number of list argument
+    elements.
+
+@returns
+    Number of list argument elements of \p item.
+
+@pre
+    \p item is not \c NULL.
+@pre
+    \p item has the type #ARGPAR_ITEM_TYPE_OPT.
+@pre
+    The option descriptor of \p item has a list delimiter.
+
+@sa
+    argpar_item_opt_arg_list_iter_init() -- Initializes an iterator of
+    the list argument elements of an option parsing item.
+*/
+unsigned int argpar_item_opt_arg_list_count(const argpar_item_t *item) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    List argument element iterator.
+
+Initialize such a structure with argpar_item_opt_arg_list_iter_init().
+
+All the members are internal: don't access them directly.
+*/
+typedef struct argpar_list_iter
+{
+    /* Internal: beginning of the next element, or `NULL` if done */
+    const char *pos;
+
+    /* Internal: list delimiter */
+    char delim;
+
+    /* Internal: list escape character, or `'\0'` */
+    char escape_ch;
+} argpar_list_iter_t;
+
+/*!
+@brief
+    Initializes the list argument element iterator \p iter to iterate
+    the elements of the list argument of the option parsing item
+    \p item.
+
+\p item must exist for the lifetime of \p iter.
+
+@param[in] item
+    Option parsing item of which to iterate the list argument elements.
+@param[out] iter
+    List argument element iterator to initialize.
+
+@pre
+    \p item is not \c NULL.
+@pre
+    \p item has the type #ARGPAR_ITEM_TYPE_OPT.
+@pre
+    The option descriptor of \p item has a list delimiter.
+@pre
+    \p iter is not \c NULL.
+
+@sa
+    argpar_list_iter_next() -- Returns the next element of a list
+    argument element iterator.
+*/
+void argpar_item_opt_arg_list_iter_init(const argpar_item_t *item,
+                                        argpar_list_iter_t *iter) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Sets \p *elem to the next element of the list argument element
+    iterator \p iter and advances \p iter.
+
+\p *elem is a slice of the original argument: it includes any list
+escape character. Use argpar_slice_unescape() with the list escape
+character of the option descriptor to copy it without them.
+
+@param[in] iter
+    List argument element iterator from which to get the next element.
+@param[out] elem
+    If this function returns \c true, \p *elem is the next element
+    of \p iter.
+
+@returns
+    \c true if \p iter had a next element, or \c false if there are no
+    more elements.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    \p elem is not \c NULL.
+*/
+bool argpar_list_iter_next(argpar_list_iter_t *iter, argpar_slice_t *elem) ARGPAR_NOEXCEPT;
+
 /*!
 @brief
     Returns the complete original argument, pointing to one of the
@@ -331,6 +574,25 @@ typedef enum argpar_error_type
 
     /// Unexpected option argument error
     ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG,
+
+    /*!
+    @brief
+        Invalid choice option argument error
+
+    The argument of an option of which the descriptor has choices
+    (see argpar_opt_descr::choices) isn't one of them.
+    */
+    ARGPAR_ERROR_TYPE_INVALID_CHOICE,
+
+    /*!
+    @brief
+        Invalid option argument error
+
+    argpar_parse_into() can't convert the argument of an option to the
+    type of its binding (see argpar_opt_descr::binding), or the
+    converted value is out of range.
+    */
+    ARGPAR_ERROR_TYPE_INVALID_OPT_ARG,
 } argpar_error_type_t;
 
 /*!
@@ -400,6 +662,41 @@ part (<code>\--mireille</code> in the last example).
 */
 const char *argpar_error_unknown_opt_name(const argpar_error_t *error) ARGPAR_NOEXCEPT;
 
+/*!
+@brief
+    Returns the name of the unknown option for which the parsing error
+    described by \p error occurred, without any <code>-</code> or
+    <code>\--</code> prefix, as a slice of the original argument.
+
+Unlike the string which argpar_error_unknown_opt_name() returns, the
+returned slice remains valid as long as the original arguments do,
+even after you destroy \p error or its argument parsing iterator.
+
+@param[in] error
+    Parsing error of which to get the name of the unknown option.
+@param[out] is_short
+    @parblock
+    If not \c NULL, this function sets \p *is_short to:
+
+    - \c true if the unknown option is a short option (its name is a
+      single character).
+    - \c false if it's a long option.
+    @endparblock
+
+@returns
+    Name of the unknown option of \p error, within the original
+    arguments.
+
+@pre
+    \p error is not \c NULL.
+@pre
+    The type of \p error, as returned by
+    \link argpar_error_type(const argpar_error_t *) argpar_error_type()\endlink,
+    is #ARGPAR_ERROR_TYPE_UNKNOWN_OPT.
+*/
+argpar_slice_t argpar_error_unknown_opt_name_slice(const argpar_error_t *error,
+                                                   bool *is_short) ARGPAR_NOEXCEPT;
+
 /*!
 @brief
     Returns the descriptor of the option for which the parsing error
@@ -426,107 +723,656 @@ const char *argpar_error_unknown_opt_name(const argpar_error_t *error) ARGPAR_NO
 @pre
     The type of \p error, as returned by
     \link argpar_error_type(const argpar_error_t *) argpar_error_type()\endlink,
-    is #ARGPAR_ERROR_TYPE_MISSING_OPT_ARG or
-    #ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG.
+    is #ARGPAR_ERROR_TYPE_MISSING_OPT_ARG,
+    #ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG,
+    #ARGPAR_ERROR_TYPE_INVALID_CHOICE, or
+    #ARGPAR_ERROR_TYPE_INVALID_OPT_ARG.
 */
 const argpar_opt_descr_t *argpar_error_opt_descr(const argpar_error_t *error,
                                                  bool *is_short) ARGPAR_NOEXCEPT;
 
 /*!
 @brief
-    Destroys the parsing error \p error.
+    Returns the invalid option argument for which the parsing error
+    described by \p error occurred.
+
+The returned string points within one of the entries of the original
+arguments (in \p argv, as passed to argpar_iter_create()).
 
 @param[in] error
-    Parsing error to destroy (may be \c NULL).
-*/
-void argpar_error_destroy(const argpar_error_t *error) ARGPAR_NOEXCEPT;
+    Parsing error of which to get the invalid option argument.
 
-/// @}
+@returns
+    Invalid option argument of \p error.
 
-/*!
-@name Iterator API
-@{
+@pre
+    \p error is not \c NULL.
+@pre
+    The type of \p error, as returned by
+    \link argpar_error_type(const argpar_error_t *) argpar_error_type()\endlink,
+    is #ARGPAR_ERROR_TYPE_INVALID_CHOICE.
 */
+const char *argpar_error_invalid_choice_arg(const argpar_error_t *error) ARGPAR_NOEXCEPT;
 
 /*!
 @brief
-    Option descriptor
+    Returns the invalid option argument for which the parsing error
+    described by \p error occurred.
 
-argpar_iter_create() accepts an array of instances of such a type,
-terminated with #ARGPAR_OPT_DESCR_SENTINEL, as its \p descrs parameter.
+The returned string points within one of the entries of the original
+arguments (in \p argv, as passed to argpar_parse_into()).
 
-The typical usage is, for example:
+@param[in] error
+    Parsing error of which to get the invalid option argument.
 
-@code
-const argpar_opt_descr_t descrs[] = {
-    { 0, 'd', NULL, false },
-    { 1, '\0', "squeeze", true },
-    { 2, 'm', "meow", true },
-    ARGPAR_OPT_DESCR_SENTINEL,
-};
-@endcode
+@returns
+    Invalid option argument of \p error.
+
+@pre
+    \p error is not \c NULL.
+@pre
+    The type of \p error, as returned by
+    \link argpar_error_type(const argpar_error_t *) argpar_error_type()\endlink,
+    is #ARGPAR_ERROR_TYPE_INVALID_OPT_ARG or
+    #ARGPAR_ERROR_TYPE_INVALID_CHOICE.
 */
-typedef struct argpar_opt_descr
-{
-    /// Numeric ID, to uniquely identify this descriptor
-    const int id;
+const char *argpar_error_invalid_opt_arg(const argpar_error_t *error) ARGPAR_NOEXCEPT;
 
-    /// Short option character, or <code>'\0'</code>
-    const char short_name;
+/*!
+@brief
+    Returns the choice, amongst the choices of the option descriptor
+    of \p error, which is the nearest to the invalid option argument
+    for which the parsing error described by \p error occurred, or
+    \c NULL if none is near enough.
 
-    /// Long option name (without the <code>\--</code> prefix), or \c NULL
-    const char * const long_name;
+For example, with the choices <code>ctf</code>, <code>text</code>, and
+<code>json</code>, this function returns <code>json</code> for the
+invalid argument <code>jsno</code>, but \c NULL for
+<code>xml</code>.
 
-    /// \c true if this option has an argument
-    const bool with_arg;
-} argpar_opt_descr_t;
+@param[in] error
+    Parsing error of which to get the suggested choice.
+
+@returns
+    Suggested choice of \p error, or \c NULL if none.
+
+@pre
+    \p error is not \c NULL.
+@pre
+    The type of \p error, as returned by
+    \link argpar_error_type(const argpar_error_t *) argpar_error_type()\endlink,
+    is #ARGPAR_ERROR_TYPE_INVALID_CHOICE.
+*/
+const char *argpar_error_invalid_choice_suggestion(const argpar_error_t *error) ARGPAR_NOEXCEPT;
 
 /*!
 @brief
-    Sentinel for an option descriptor array
+    Destroys the parsing error \p error.
+
+@param[in] error
+    Parsing error to destroy (may be \c NULL).
+*/
+void argpar_error_destroy(const argpar_error_t *error) ARGPAR_NOEXCEPT;
+
+/// @}
+
+/*!
+@name Binding API
+@{
+
+A binding describes where and how argpar_parse_into() writes the value
+of an option (see argpar_opt_descr::binding), or of the non-option
+arguments, into a caller's structure.
 
 The typical usage is, for example:
 
 @code
+struct config {
+    bool color;
+    unsigned int verbosity;
+    const char *output;
+    int jobs;
+    argpar_arg_list_t inputs;
+};
+
 const argpar_opt_descr_t descrs[] = {
-    { 0, 'd', NULL, false },
-    { 1, '\0', "squeeze", true },
-    { 2, 'm', "meow", true },
+    { .id = 0, .long_name = "color",
+      .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE,
+      .binding = ARGPAR_BIND_FLAG(struct config, color) },
+    { .id = 1, .short_name = 'v',
+      .binding = ARGPAR_BIND_COUNTER(struct config, verbosity) },
+    { .id = 2, .short_name = 'o', .long_name = "output", .with_arg = true,
+      .binding = ARGPAR_BIND_STR(struct config, output) },
+    { .id = 3, .short_name = 'j', .long_name = "jobs", .with_arg = true,
+      .binding = ARGPAR_BIND_INT(struct config, jobs) },
     ARGPAR_OPT_DESCR_SENTINEL,
 };
+
+const argpar_binding_t inputs_binding = ARGPAR_BIND_APPEND(struct config, inputs);
+struct config config = { .color = true, .output = "out.txt", .jobs = 1 };
+
+status = argpar_parse_into(argc - 1, &argv[1], descrs, &inputs_binding,
+                           &config, &error);
 @endcode
 */
-#define ARGPAR_OPT_DESCR_SENTINEL                                                                  \
-    {                                                                                              \
-        -1, '\0', NULL, false                                                                      \
-    }
 
 /*!
-@struct argpar_iter
-
 @brief
-    Opaque argpar iterator type
-
-argpar_iter_create() returns a pointer to such a type.
+    Kind of a binding.
 */
-typedef struct argpar_iter argpar_iter_t;
+typedef enum argpar_binding_kind
+{
+    /// No binding: argpar_parse_into() ignores the option
+    ARGPAR_BINDING_KIND_NONE = 0,
+
+    /*!
+    @brief
+        Flag: \c bool or integer member which argpar_parse_into() sets
+        to 1, or to 0 for a negated option item (see
+        argpar_item_opt_is_negated()).
+
+    The option has no argument.
+    */
+    ARGPAR_BINDING_KIND_FLAG,
+
+    /*!
+    @brief
+        Counter: unsigned integer member which argpar_parse_into()
+        increments for each occurrence, or resets to 0 for a negated
+        option item.
+
+    The option has no argument.
+    */
+    ARGPAR_BINDING_KIND_COUNTER,
+
+    /*!
+    @brief
+        String: <code>const char *</code> member which
+        argpar_parse_into() sets to the option argument (last
+        occurrence wins), or the non-option argument.
+
+    The string points within one of the entries of the original
+    arguments.
+    */
+    ARGPAR_BINDING_KIND_STR,
+
+    /*!
+    @brief
+        Signed integer: \c signed \c char, \c short, \c int,
+        \c long, or <code>long long</code> member which
+        argpar_parse_into() sets to the option argument, converted with
+        <code>strtoll()</code> (base&nbsp;0).
+
+    For example, <code>42</code>, <code>+42</code>, <code>-0x2a</code>,
+    and <code>052</code> are valid arguments, but not
+    <code>0x-2a</code>. argpar::Value of the C++ API accepts the same
+    integer arguments.
+
+    An argument which starts with a whitespace or which is out of the
+    range of the member is invalid.
+    */
+    ARGPAR_BINDING_KIND_INT,
+
+    /*!
+    @brief
+        Unsigned integer: unsigned integer member which
+        argpar_parse_into() sets to the option argument, converted with
+        <code>strtoull()</code> (base&nbsp;0).
+
+    An argument which starts with a whitespace, which is negative, or
+    which is out of the range of the member is invalid.
+    */
+    ARGPAR_BINDING_KIND_UINT,
+
+    /*!
+    @brief
+        Real number: \c float or \c double member which
+        argpar_parse_into() sets to the option argument, converted with
+        <code>strtof()</code> or <code>strtod()</code>.
+
+    An argument which starts with a whitespace or which is out of the
+    range of the member is invalid.
+    */
+    ARGPAR_BINDING_KIND_REAL,
+
+    /*!
+    @brief
+        Choice: \c int or \c unsigned \c int member which
+        argpar_parse_into() sets to the index of the choice of the
+        option argument (see argpar_opt_descr::choices).
+    */
+    ARGPAR_BINDING_KIND_CHOICE,
+
+    /*!
+    @brief
+        Append: #argpar_arg_list_t member to which argpar_parse_into()
+        appends the option argument or the non-option argument.
+
+    Release the resources of such a member with argpar_arg_list_fini().
+    */
+    ARGPAR_BINDING_KIND_APPEND,
+} argpar_binding_kind_t;
 
 /*!
 @brief
-    Creates and returns an argument parsing iterator to parse the
-    original arguments \p argv of which the count is \p argc using the
-    option descriptors \p descrs.
+    Binding
+*/
+typedef struct argpar_binding
+{
+    /// Kind
+    argpar_binding_kind_t kind;
 
-This function initializes the returned structure, but doesn't actually
-start parsing the arguments.
+    /// Offset of the member within the target structure
+    size_t offset;
 
-argpar considers \em all the elements of \p argv, including the first
-one, so that you would typically pass <code>(argc - 1)</code> as \p argc
-and <code>\&argv[1]</code> as \p argv from what <code>main()</code>
-receives, or ignore the parsing item of the first call to
-argpar_iter_next().
+    /// Size of the member
+    size_t size;
+} argpar_binding_t;
 
-\p *argv and \p *descrs must \em not change for all of:
+/* Internal: binding of the member `_member` of `_type` with the kind `_kind` */
+#define ARGPAR_BIND_(_kind, _type, _member)                                                        \
+    {                                                                                              \
+        (_kind), offsetof(_type, _member), sizeof(((_type *) 0)->_member)                          \
+    }
+
+/// No binding (#ARGPAR_BINDING_KIND_NONE)
+#define ARGPAR_BIND_NONE                                                                           \
+    {                                                                                              \
+        ARGPAR_BINDING_KIND_NONE, 0, 0                                                             \
+    }
+
+/// Flag binding (#ARGPAR_BINDING_KIND_FLAG) of the member \p _member of \p _type
+#define ARGPAR_BIND_FLAG(_type, _member) ARGPAR_BIND_(ARGPAR_BINDING_KIND_FLAG, _type, _member)
+
+/// Counter binding (#ARGPAR_BINDING_KIND_COUNTER) of the member \p _member of \p _type
+#define ARGPAR_BIND_COUNTER(_type, _member)                                                        \
+    ARGPAR_BIND_(ARGPAR_BINDING_KIND_COUNTER, _type, _member)
+
+/// String binding (#ARGPAR_BINDING_KIND_STR) of the member \p _member of \p _type
+#define ARGPAR_BIND_STR(_type, _member) ARGPAR_BIND_(ARGPAR_BINDING_KIND_STR, _type, _member)
+
+/// Signed integer binding (#ARGPAR_BINDING_KIND_INT) of the member \p _member of \p _type
+#define ARGPAR_BIND_INT(_type, _member) ARGPAR_BIND_(ARGPAR_BINDING_KIND_INT, _type, _member)
+
+/// Unsigned integer binding (#ARGPAR_BINDING_KIND_UINT) of the member \p _member of \p _type
+#define ARGPAR_BIND_UINT(_type, _member) ARGPAR_BIND_(ARGPAR_BINDING_KIND_UINT, _type, _member)
+
+/// Real number binding (#ARGPAR_BINDING_KIND_REAL) of the member \p _member of \p _type
+#define ARGPAR_BIND_REAL(_type, _member) ARGPAR_BIND_(ARGPAR_BINDING_KIND_REAL, _type, _member)
+
+/// Choice binding (#ARGPAR_BINDING_KIND_CHOICE) of the member \p _member of \p _type
+#define ARGPAR_BIND_CHOICE(_type, _member)                                                         \
+    ARGPAR_BIND_(ARGPAR_BINDING_KIND_CHOICE, _type, _member)
+
+/// Append binding (#ARGPAR_BINDING_KIND_APPEND) of the member \p _member of \p _type
+#define ARGPAR_BIND_APPEND(_type, _member)                                                         \
+    ARGPAR_BIND_(ARGPAR_BINDING_KIND_APPEND, _type, _member)
+
+/*!
+@brief
+    Argument list, the type of a member having an
+    #ARGPAR_BINDING_KIND_APPEND binding.
+
+Initialize such a structure to all zeros.
+*/
+typedef struct argpar_arg_list
+{
+    /*!
+    @brief
+        Arguments, each one pointing within one of the entries of the
+        original arguments.
+    */
+    const char **args;
+
+    /// Number of arguments in \link argpar_arg_list::args args\endlink
+    unsigned int count;
+
+    /// Capacity of \link argpar_arg_list::args args\endlink
+    unsigned int capacity;
+} argpar_arg_list_t;
+
+/*!
+@brief
+    Releases the resources of the argument list \p list and resets it
+    to all zeros.
+
+@param[in] list
+    Argument list to finalize.
+
+@pre
+    \p list is not \c NULL.
+*/
+void argpar_arg_list_fini(argpar_arg_list_t *list) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Return type of argpar_parse_into().
+
+Error status enumerators have a negative value.
+*/
+typedef enum argpar_parse_into_status
+{
+    /// Success
+    ARGPAR_PARSE_INTO_STATUS_OK,
+
+    /// Parsing error
+    ARGPAR_PARSE_INTO_STATUS_ERROR = -1,
+
+    /// Memory error
+    ARGPAR_PARSE_INTO_STATUS_ERROR_MEMORY = -12,
+} argpar_parse_into_status_t;
+
+/*!
+@brief
+    Parses \em all the original arguments \p argv of which the count
+    is \p argc using the option descriptors \p descrs, writing the
+    value of each option and non-option argument into the structure
+    \p target according to its binding.
+
+This function is equivalent to calling argpar_iter_next() until the
+end and writing each item to \p target, but without creating any
+item:
+
+- For an option, it follows the binding of its descriptor (see
+  argpar_opt_descr::binding), ignoring an option without any binding.
+
+- For a non-option argument, it follows \p non_opt_binding,
+  ignoring the non-option argument if \p non_opt_binding is \c NULL.
+
+\p target keeps any value which this function doesn't write, so
+initialize it with your defaults.
+
+On error, \p target may contain some of the parsed values.
+
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse, of which the count is \p argc.
+@param[in] descrs
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+@param[in] non_opt_binding
+    @parblock
+    Binding of non-option arguments, or \c NULL to ignore them.
+
+    The kind must be #ARGPAR_BINDING_KIND_STR or
+    #ARGPAR_BINDING_KIND_APPEND.
+    @endparblock
+@param[in] target
+    Structure to fill.
+@param[out] error
+    @parblock
+    When this function returns #ARGPAR_PARSE_INTO_STATUS_ERROR,
+    if this parameter is not \c NULL, \p *error contains details about
+    the error.
+
+    Destroy \p *error with argpar_error_destroy().
+    @endparblock
+
+@returns
+    Status code.
+
+@pre
+    \p argv is not \c NULL.
+@pre
+    The first \p argc elements of \p argv are not \c NULL.
+@pre
+    \p descrs is not \c NULL.
+@pre
+    \p target is not \c NULL.
+*/
+argpar_parse_into_status_t argpar_parse_into(unsigned int argc, const char * const *argv,
+                                             const argpar_opt_descr_t *descrs,
+                                             const argpar_binding_t *non_opt_binding,
+                                             void *target,
+                                             const argpar_error_t **error) ARGPAR_NOEXCEPT;
+
+/// @}
+
+/*!
+@name Iterator API
+@{
+*/
+
+/*!
+@brief
+    Option descriptor flags, as found in the \link argpar_opt_descr::flags
+    flags\endlink member of #argpar_opt_descr_t.
+
+You may combine the enumerators with the bitwise OR operator.
+*/
+typedef enum argpar_opt_descr_flag
+{
+    /*!
+    @brief
+        The long option also has a negated form.
+
+    With this flag, argpar_iter_next() parses
+    <code>\--no-NAME</code>, where \c NAME is the long option name of
+    the descriptor, as an option item for this same descriptor for
+    which argpar_item_opt_is_negated() returns \c true.
+
+    A descriptor having this flag must have a long option name and
+    no argument.
+
+    argpar_iter_next() always gives precedence to a descriptor of which
+    the long option name is exactly <code>no-NAME</code>, if any.
+    */
+    ARGPAR_OPT_DESCR_FLAG_NEGATABLE = 1U << 0,
+
+    /*!
+    @brief
+        The option opens a scope.
+
+    argpar_parse() starts a new segment (see #argpar_segment_t) at
+    each option item for a descriptor having this flag.
+
+    argpar_iter_next() ignores this flag.
+    */
+    ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER = 1U << 1,
+
+    /*!
+    @brief
+        The position of the option doesn't matter.
+
+    argpar_fingerprint() hashes the option items for a descriptor
+    having this flag regardless of their position amongst the other
+    items.
+
+    argpar_iter_next() ignores this flag.
+    */
+    ARGPAR_OPT_DESCR_FLAG_ORDER_INSENSITIVE = 1U << 2,
+} argpar_opt_descr_flag_t;
+
+/*!
+@brief
+    Option descriptor
+
+argpar_iter_create() accepts an array of instances of such a type,
+terminated with #ARGPAR_OPT_DESCR_SENTINEL, as its \p descrs parameter.
+
+Use ARGPAR_OPT_DESCR() to initialize an option descriptor from its
+first four members only, setting the other ones to zero, and designated
+initializers to set the other members.
+
+The typical usage is, for example:
+
+@code
+const argpar_opt_descr_t descrs[] = {
+    ARGPAR_OPT_DESCR(0, 'd', NULL, false),
+    ARGPAR_OPT_DESCR(1, '\0', "squeeze", true),
+    ARGPAR_OPT_DESCR(2, 'm', "meow", true),
+    { .id = 3, .long_name = "color", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE },
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+@endcode
+*/
+typedef struct argpar_opt_descr
+{
+    /// Numeric ID, to uniquely identify this descriptor
+    const int id;
+
+    /// Short option character, or <code>'\0'</code>
+    const char short_name;
+
+    /// Long option name (without the <code>\--</code> prefix), or \c NULL
+    const char * const long_name;
+
+    /// \c true if this option has an argument
+    const bool with_arg;
+
+    /// Flags (bitwise OR of #argpar_opt_descr_flag enumerators), or 0
+    const unsigned int flags;
+
+    /*!
+    @brief
+        List delimiter, or <code>'\0'</code> if the argument of this
+        option isn't a list.
+
+    For example, with <code>','</code>, the argument of
+    <code>\--fields=a,b,c</code> has three elements: use
+    argpar_item_opt_arg_list_count() and
+    argpar_item_opt_arg_list_iter_init() to access them.
+
+    This option must have an argument.
+    */
+    const char list_delim;
+
+    /*!
+    @brief
+        List escape character, or <code>'\0'</code> if none.
+
+    Within a list argument, this character escapes the next one,
+    for example to escape a list delimiter.
+    */
+    const char list_escape;
+
+    /*!
+    @brief
+        Choices: \c NULL-terminated array of the accepted arguments of
+        this option, or \c NULL to accept any argument.
+
+    argpar_iter_next() validates the argument of this option, returning
+    an #ARGPAR_ERROR_TYPE_INVALID_CHOICE error if it's not one of
+    those choices, and sets the index of the matching choice which
+    argpar_item_opt_choice() returns.
+
+    argpar_iter_create() builds a hash table for each set of choices,
+    having about two slots per choice, so that such a validation only
+    costs a few probes.
+
+    This option must have an argument and at most 16,777,216 choices.
+    */
+    const char * const *choices;
+
+    /*!
+    @brief
+        Binding, used by argpar_parse_into() only.
+
+    Use one of the \c ARGPAR_BIND_ macros to set this member, for
+    example ARGPAR_BIND_FLAG().
+    */
+    const argpar_binding_t binding;
+} argpar_opt_descr_t;
+
+/*!
+@brief
+    Sentinel for an option descriptor array
+
+The typical usage is, for example:
+
+@code
+const argpar_opt_descr_t descrs[] = {
+    ARGPAR_OPT_DESCR(0, 'd', NULL, false),
+    ARGPAR_OPT_DESCR(1, '\0', "squeeze", true),
+    ARGPAR_OPT_DESCR(2, 'm', "meow", true),
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+@endcode
+*/
+#define ARGPAR_OPT_DESCR_SENTINEL ARGPAR_OPT_DESCR(-1, '\0', NULL, false)
+
+/*!
+@brief
+    Initializer of an option descriptor having the numeric ID \p _id,
+    the short option character \p _short_name, the long option name
+    \p _long_name, and an argument if \p _with_arg is \c true.
+
+The other members of the option descriptor are zero.
+
+Unlike a positional initializer which omits the trailing members,
+this initializer doesn't trigger missing field initializer warnings,
+in C as well as in C++.
+*/
+#define ARGPAR_OPT_DESCR(_id, _short_name, _long_name, _with_arg)                                  \
+    {                                                                                              \
+        (_id), (_short_name), (_long_name), (_with_arg), 0, '\0', '\0', NULL, ARGPAR_BIND_NONE     \
+    }
+
+/*!
+@struct argpar_iter
+
+@brief
+    Opaque argpar iterator type
+
+argpar_iter_create() returns a pointer to such a type.
+*/
+typedef struct argpar_iter argpar_iter_t;
+
+/*!
+@brief
+    User allocator (see argpar_iter_create_with_allocator() and
+    argpar_parse_with_allocator()).
+
+An allocator makes argpar allocate all the memory of an argument
+parsing iterator, of its items and errors, and of a batch parsing
+result with your own functions instead of the C library, for example
+to use a per-request memory arena.
+*/
+typedef struct argpar_allocator
+{
+    /*!
+    @brief
+        Reallocates \p ptr to \p size bytes and returns the new
+        address, or returns \c NULL on memory error, like the
+        <code>realloc()</code> function of the C library.
+
+    If \p ptr is \c NULL, this function allocates a new memory block.
+
+    The returned memory block must be suitably aligned for any type.
+
+    \p data is #data.
+    */
+    void *(*realloc_func)(void *ptr, size_t size, void *data);
+
+    /*!
+    @brief
+        Frees \p ptr (never \c NULL).
+
+    \p data is #data.
+    */
+    void (*free_func)(void *ptr, void *data);
+
+    /// User data to pass to #realloc_func and #free_func.
+    void *data;
+} argpar_allocator_t;
+
+/*!
+@brief
+    Creates and returns an argument parsing iterator to parse the
+    original arguments \p argv of which the count is \p argc using the
+    option descriptors \p descrs.
+
+This function initializes the returned structure, but doesn't actually
+start parsing the arguments.
+
+argpar considers \em all the elements of \p argv, including the first
+one, so that you would typically pass <code>(argc - 1)</code> as \p argc
+and <code>\&argv[1]</code> as \p argv from what <code>main()</code>
+receives, or ignore the parsing item of the first call to
+argpar_iter_next().
+
+\p *argv and \p *descrs must \em not change for all of:
 
 - The lifetime of the returned iterator (until you call
   argpar_iter_destroy()).
@@ -568,6 +1414,40 @@ argpar_iter_next().
 argpar_iter_t *argpar_iter_create(unsigned int argc, const char * const *argv,
                                   const argpar_opt_descr_t *descrs) ARGPAR_NOEXCEPT;
 
+/*!
+@brief
+    Like argpar_iter_create(), but makes the returned argument parsing
+    iterator allocate its memory, as well as its items and errors, with
+    the allocator \p allocator.
+
+argpar_iter_destroy(), argpar_item_destroy(), and
+argpar_error_destroy() free memory with \p allocator.
+
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse (see argpar_iter_create()).
+@param[in] descrs
+    Option descriptor array (see argpar_iter_create()).
+@param[in] allocator
+    @parblock
+    Allocator, or \c NULL to use the C library.
+
+    \p allocator must remain valid and unchanged as long as the returned
+    iterator, its items, and its errors exist.
+    @endparblock
+
+@returns
+    New argument parsing iterator, or \c NULL on memory error.
+
+@pre
+    Same preconditions as argpar_iter_create().
+*/
+argpar_iter_t *
+argpar_iter_create_with_allocator(unsigned int argc, const char * const *argv,
+                                  const argpar_opt_descr_t *descrs,
+                                  const argpar_allocator_t *allocator) ARGPAR_NOEXCEPT;
+
 /*!
 @brief
     Destroys the argument parsing iterator \p iter.
@@ -594,6 +1474,13 @@ typedef enum argpar_iter_next_status
     /// End of iteration (no more original arguments to parse)
     ARGPAR_ITER_NEXT_STATUS_END,
 
+    /*!
+    @brief
+        End of iteration at the first non-option argument (see
+        argpar_iter_set_stop_at_non_opt()).
+    */
+    ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT,
+
     /// Parsing error
     ARGPAR_ITER_NEXT_STATUS_ERROR = -1,
 
@@ -609,6 +1496,10 @@ typedef enum argpar_iter_next_status
 If there are no more original arguments to parse, this function returns
 #ARGPAR_ITER_NEXT_STATUS_END.
 
+If \p iter stops at the first non-option argument (see
+argpar_iter_set_stop_at_non_opt()), this function returns
+#ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT when it reaches one.
+
 @param[in] iter
     Argument parsing iterator from which to get the next parsing item.
 @param[out] item
@@ -637,6 +1528,48 @@ If there are no more original arguments to parse, this function returns
 argpar_iter_next_status_t argpar_iter_next(argpar_iter_t *iter, const argpar_item_t **item,
                                            const argpar_error_t **error) ARGPAR_NOEXCEPT;
 
+/*!
+@brief
+    Like argpar_iter_next(), but sets \p *item to an item which the
+    argument parsing iterator \p iter owns instead of creating a new
+    one.
+
+This function never allocates memory on success, and only allocates
+on parsing error to grow a temporary buffer for a long unknown option
+name: use it to parse original arguments without one allocation per
+item, and to report errors without allocating, for example when
+completing partially typed options.
+
+The item or error which this function produces remains valid until
+the next call to argpar_iter_next() or argpar_iter_borrow_next() with
+\p iter, or until you destroy \p iter. Don't destroy it with
+argpar_item_destroy() or argpar_error_destroy().
+
+@param[in] iter
+    Argument parsing iterator from which to get the next parsing item.
+@param[out] item
+    @parblock
+    On success, \p *item is the next parsing item of \p iter, borrowed
+    from \p iter.
+    @endparblock
+@param[out] error
+    @parblock
+    When this function returns #ARGPAR_ITER_NEXT_STATUS_ERROR,
+    if this parameter is not \c NULL, \p *error contains details about
+    the error, borrowed from \p iter.
+    @endparblock
+
+@returns
+    Status code.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    \p item is not \c NULL.
+*/
+argpar_iter_next_status_t argpar_iter_borrow_next(argpar_iter_t *iter, const argpar_item_t **item,
+                                                  const argpar_error_t **error) ARGPAR_NOEXCEPT;
+
 /*
  * Returns the number of ingested elements from `argv`, as passed to
  * argpar_iter_create() to create `*iter`, that were required to produce
@@ -661,6 +1594,1868 @@ argpar_iter_next_status_t argpar_iter_next(argpar_iter_t *iter, const argpar_ite
 */
 unsigned int argpar_iter_ingested_orig_args(const argpar_iter_t *iter) ARGPAR_NOEXCEPT;
 
+/*!
+@brief
+    Size, in bytes, of a flag bitset for option descriptor IDs
+    from 0 to <code>_id_count - 1</code>.
+
+See argpar_iter_set_flag_sink().
+*/
+#define ARGPAR_FLAG_BITSET_SIZE(_id_count) (((_id_count) + 7) / 8)
+
+/*!
+@brief
+    Returns whether or not the bit of the option descriptor ID \p _id is
+    set within the flag bitset \p _bitset (<code>unsigned char *</code>
+    type).
+
+See argpar_iter_set_flag_sink().
+*/
+#define ARGPAR_FLAG_BITSET_IS_SET(_bitset, _id) (((_bitset)[(_id) / 8] >> ((_id) % 8)) & 1)
+
+/*!
+@brief
+    Makes the argument parsing iterator \p iter record the options
+    without an argument into the flag bitset \p bitset and the
+    counter array \p counters instead of producing items for them.
+
+Most options without an argument (see argpar_opt_descr::with_arg)
+only set a flag or increment a counter. After calling this function
+with a non-<code>NULL</code> \p bitset or \p counters,
+argpar_iter_next() doesn't produce an item for such an option,
+including for each option within a short option group such as
+<code>-vvvcq</code>. Instead, for the option descriptor ID \c id,
+it:
+
+- Sets the bit \c id of \p bitset (bit <code>id % 8</code> of
+  <code>bitset[id / 8]</code>), or clears it for a negated option (see
+  #ARGPAR_OPT_DESCR_FLAG_NEGATABLE).
+
+- Increments <code>counters[id]</code>, or resets it to 0 for a
+  negated option.
+
+argpar_iter_next() then only produces items for options with an
+argument and for non-option arguments.
+
+This function doesn't initialize \p bitset and \p counters.
+
+@param[in] iter
+    Argument parsing iterator of which to set the flag sink.
+@param[in] bitset
+    @parblock
+    Flag bitset, or \c NULL if none.
+
+    Use ARGPAR_FLAG_BITSET_SIZE() to get its size and
+    ARGPAR_FLAG_BITSET_IS_SET() to test a bit.
+    @endparblock
+@param[in] counters
+    Counter array, indexed by option descriptor ID, or \c NULL if none.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    If \p bitset or \p counters is not \c NULL, the ID of each option
+    descriptor without an argument, as passed to argpar_iter_create()
+    to create \p iter, is a valid index of it.
+@pre
+    You didn't call argpar_iter_next() with \p iter yet.
+*/
+void argpar_iter_set_flag_sink(argpar_iter_t *iter, unsigned char *bitset,
+                               unsigned int *counters) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Sets whether or not the argument parsing iterator \p iter stops
+    at the first non-option argument, like POSIX
+    <code>getopt()</code> does when the \c POSIXLY_CORRECT environment
+    variable is set.
+
+With \p stop set to \c true, argpar_iter_next() returns
+#ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT instead of producing an item
+for the first non-option argument, and for any subsequent call.
+argpar_iter_ingested_orig_args() then returns the index of this
+non-option argument within \p argv (as passed to argpar_iter_create()
+to create \p iter): you may hand off the remaining original arguments
+as is, for example to execute another program.
+
+In this mode, argpar_iter_next() ingests a <code>\--</code> original
+argument, ending the iteration without handing it off. For example,
+with the original arguments
+<code>-v -- ls -l</code>, argpar_iter_ingested_orig_args() returns 2
+after argpar_iter_next() returns
+#ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT.
+
+This mode is disabled by default.
+
+@param[in] iter
+    Argument parsing iterator of which to set the mode.
+@param[in] stop
+    \c true to make \p iter stop at the first non-option argument.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    You didn't call argpar_iter_next() with \p iter yet.
+*/
+void argpar_iter_set_stop_at_non_opt(argpar_iter_t *iter, bool stop) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Sets whether or not the argument parsing iterator \p iter keeps a
+    cache of its most recently used option descriptors.
+
+Without an index, argpar_iter_next() finds the option descriptor of an
+option by scanning the option descriptors (as passed to
+argpar_iter_create()) in order. Real command lines, however, often
+repeat a few options (<code>-v -v -v</code>,
+<code>\--param=a \--param=b</code>).
+
+With \p enable set to \c true, \p iter keeps the last eight option
+descriptors it found, keyed by short option name or by long option
+name hash, and consults them before scanning: finding a repeated
+option doesn't depend on the number or order of option descriptors,
+and this cache costs no setup nor any allocation.
+
+The cache only contains scan results, therefore argpar_iter_next()
+still finds the \em first option descriptor of a given name in the
+presence of duplicate entries.
+
+This mode is disabled by default. It has no effect with the
+#ARGPAR_LOOKUP_STRATEGY_HASH lookup strategy (see
+argpar_iter_set_lookup_strategy()), including with an iterator which
+argpar_iter_create_with_image() creates.
+
+@param[in] iter
+    Argument parsing iterator of which to set the mode.
+@param[in] enable
+    \c true to make \p iter keep a lookup cache.
+
+@pre
+    \p iter is not \c NULL.
+*/
+void argpar_iter_set_lookup_cache(argpar_iter_t *iter, bool enable) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Strategy with which an argument parsing iterator finds the option
+    descriptor of an option.
+
+Whatever the strategy, argpar_iter_next() finds the \em first option
+descriptor of a given name in the presence of duplicate entries.
+*/
+typedef enum argpar_lookup_strategy
+{
+    /*!
+    @brief
+        Select one of the strategies below from the option descriptors.
+
+    This strategy selects:
+
+    <dl>
+      <dt>Fewer than 24 option descriptors</dt>
+      <dd>#ARGPAR_LOOKUP_STRATEGY_SCAN</dd>
+
+      <dt>Fewer than 64 option descriptors</dt>
+      <dd>
+        #ARGPAR_LOOKUP_STRATEGY_FINGERPRINT or, if most long option
+        names are longer than eight bytes,
+        #ARGPAR_LOOKUP_STRATEGY_HASH.
+      </dd>
+
+      <dt>Otherwise</dt>
+      <dd>#ARGPAR_LOOKUP_STRATEGY_HASH</dd>
+    </dl>
+
+    Those thresholds come from the \c bench-argpar benchmark,
+    including the creation of the iterator.
+    */
+    ARGPAR_LOOKUP_STRATEGY_AUTO,
+
+    /*!
+    @brief
+        Scan the option descriptors in order.
+
+    No setup, but each lookup is linear in the number of option
+    descriptors.
+    */
+    ARGPAR_LOOKUP_STRATEGY_SCAN,
+
+    /*!
+    @brief
+        Scan compact per-descriptor fingerprints (short option name,
+        long option name length and first eight bytes).
+
+    One allocation of 13&nbsp;bytes per option descriptor; each lookup
+    is still linear, but compares the fingerprints of 16 option
+    descriptors at once and only compares the long option names
+    longer than eight bytes.
+    */
+    ARGPAR_LOOKUP_STRATEGY_FINGERPRINT,
+
+    /*!
+    @brief
+        Probe a short option name table and a long option name hash
+        table.
+
+    One allocation of a 1&nbsp;KiB short option name table and of a
+    long option name hash table having between two and four slots per
+    option descriptor; each lookup takes constant time.
+    */
+    ARGPAR_LOOKUP_STRATEGY_HASH,
+} argpar_lookup_strategy_t;
+
+/*!
+@brief
+    Return type of argpar_iter_set_lookup_strategy().
+
+Error status enumerators have a negative value.
+*/
+typedef enum argpar_iter_set_lookup_strategy_status
+{
+    /// Success
+    ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK,
+
+    /// Memory error
+    ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_ERROR_MEMORY = -12,
+} argpar_iter_set_lookup_strategy_status_t;
+
+/*!
+@brief
+    Sets the strategy with which the argument parsing iterator \p iter
+    finds the option descriptor of an option to \p strategy.
+
+argpar_iter_create() and argpar_iter_create_with_allocator() select
+the strategy with #ARGPAR_LOOKUP_STRATEGY_AUTO: call this function
+to override this choice, for example if \p iter parses very few or
+very many original arguments. Use argpar_iter_lookup_strategy() to
+get the selected strategy.
+
+This function releases the tables of the previous strategy, if any,
+and creates the ones of the new strategy.
+
+This function has no effect with an iterator which
+argpar_iter_create_with_image() creates, which always uses
+#ARGPAR_LOOKUP_STRATEGY_HASH with the tables of its image.
+
+@param[in] iter
+    Argument parsing iterator of which to set the lookup strategy.
+@param[in] strategy
+    Lookup strategy to use.
+
+@returns
+    @parblock
+    Status code.
+
+    On memory error, \p iter uses #ARGPAR_LOOKUP_STRATEGY_SCAN.
+    @endparblock
+
+@pre
+    \p iter is not \c NULL.
+*/
+argpar_iter_set_lookup_strategy_status_t
+argpar_iter_set_lookup_strategy(argpar_iter_t *iter,
+                                argpar_lookup_strategy_t strategy) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the strategy with which the argument parsing iterator
+    \p iter finds the option descriptor of an option.
+
+@param[in] iter
+    Argument parsing iterator of which to get the lookup strategy.
+
+@returns
+    Lookup strategy of \p iter (never #ARGPAR_LOOKUP_STRATEGY_AUTO).
+
+@pre
+    \p iter is not \c NULL.
+*/
+argpar_lookup_strategy_t argpar_iter_lookup_strategy(const argpar_iter_t *iter) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Return type of argpar_iter_add_namespace().
+
+Error status enumerators have a negative value.
+*/
+typedef enum argpar_iter_add_namespace_status
+{
+    /// Success
+    ARGPAR_ITER_ADD_NAMESPACE_STATUS_OK,
+
+    /// Memory error
+    ARGPAR_ITER_ADD_NAMESPACE_STATUS_ERROR_MEMORY = -12,
+} argpar_iter_add_namespace_status_t;
+
+/*!
+@brief
+    Adds a namespace having the prefix \p prefix and the option
+    descriptors \p descrs to the argument parsing iterator \p iter.
+
+A namespace makes argpar_iter_next() route a long option of the form
+<code>\--PREFIX.NAME</code> (for example,
+<code>\--sink.ctf.fs.path=/x</code>) to the option descriptor of
+\p descrs having the long option name \c NAME, where \c PREFIX is
+everything before the \em last <code>.</code>. The resulting option
+item is like any other, except that argpar_item_opt_namespace()
+returns \p prefix.
+
+This function compiles \p descrs into a hash table of its long option
+names, and argpar_iter_next() finds the namespace of an option with
+a hash table of the namespace prefixes: finding a namespaced option
+costs two hash table probes, whatever the number of namespaces.
+
+The option descriptors passed to argpar_iter_create() have precedence
+over namespaced ones. argpar_iter_next() ignores the short option
+names of \p descrs.
+
+A negatable option descriptor (see #ARGPAR_OPT_DESCR_FLAG_NEGATABLE)
+of \p descrs has the negated form <code>\--PREFIX.no-NAME</code>.
+
+@param[in] iter
+    Argument parsing iterator to which to add a namespace.
+@param[in] prefix
+    @parblock
+    Namespace prefix.
+
+    \p prefix must remain valid and unchanged as long as \p iter and
+    its items exist.
+    @endparblock
+@param[in] descrs
+    @parblock
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+
+    \p descrs must remain valid and unchanged as long as \p iter and
+    its items exist.
+    @endparblock
+
+@returns
+    Status code.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    \p prefix is not \c NULL and not empty.
+@pre
+    \p iter has no namespace having the prefix \p prefix.
+@pre
+    \p descrs is not \c NULL.
+@pre
+    No long option name of \p descrs contains <code>.</code>.
+*/
+argpar_iter_add_namespace_status_t
+argpar_iter_add_namespace(argpar_iter_t *iter, const char *prefix,
+                          const argpar_opt_descr_t *descrs) ARGPAR_NOEXCEPT;
+
+/*!
+@struct argpar_descr_image
+
+@brief
+    Opaque loaded option descriptor image type
+
+argpar_descr_image_open() returns a pointer to such a type.
+
+An option descriptor image is a precompiled option descriptor set
+(names, IDs, flags, choices, as well as the hash tables of the long
+names, short names, and choices) which argpar_descr_image_write()
+serializes to a position-independent memory block, typically to save
+it as a file.
+
+Then, on subsequent program runs, argpar_descr_image_open() loads such
+an image, for example a read-only <code>mmap()</code> mapping of this
+file, and argpar_iter_create_with_image() creates argument parsing
+iterators which use its hash tables in place: the long option names
+and choices remain within the image data. This avoids assembling a
+large option descriptor array (for example, from plugin metadata) and
+compiling it on each program run.
+
+The typical usage is, for example:
+
+@code
+const argpar_descr_image_t *image;
+
+switch (argpar_descr_image_open(data, size, metadata_hash, NULL, &image)) {
+case ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK:
+    break;
+case ARGPAR_DESCR_IMAGE_OPEN_STATUS_STALE:
+case ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID:
+    // Rebuild the descriptors and rewrite the image file with
+    // argpar_descr_image_write(), then open it again
+    ...
+default:
+    // Handle memory error
+    ...
+}
+
+iter = argpar_iter_create_with_image(argc, argv, image);
+@endcode
+
+An image is only valid for the ABI (byte order and type sizes) of the
+program which wrote it: argpar_descr_image_open() reports an image
+having another ABI as stale.
+*/
+typedef struct argpar_descr_image argpar_descr_image_t;
+
+/*!
+@brief
+    Writes the option descriptor image of \p descrs, having the user
+    key \p key, to \p buf.
+
+This function compiles \p descrs (see argpar_iter_create()) and, if
+\p buf_size is large enough, writes the resulting image to \p buf.
+Call this function with a \c NULL \p buf first to get the required
+size.
+
+The image doesn't contain the bindings of \p descrs (see
+argpar_opt_descr::binding): argpar_descr_image_descrs() returns
+descriptors without bindings.
+
+@param[in] descrs
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+@param[in] key
+    @parblock
+    User key, for example a hash of the inputs from which you create
+    \p descrs.
+
+    argpar_descr_image_open() reports an image of which the key
+    doesn't match as stale.
+    @endparblock
+@param[out] buf
+    Buffer, aligned on 8 bytes, to which to write the image, or \c NULL
+    to only get the required size.
+@param[in] buf_size
+    Size of \p buf (bytes).
+
+@returns
+    Size of the image (bytes, always a multiple of 8), or 0 on memory
+    error or if the image would exceed 4 GiB.
+
+    This function only writes to \p buf if \p buf_size is greater than
+    or equal to this value.
+
+@pre
+    \p descrs is not \c NULL.
+*/
+size_t argpar_descr_image_write(const argpar_opt_descr_t *descrs, unsigned long long key,
+                                void *buf, size_t buf_size) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Return type of argpar_descr_image_open().
+
+Error status enumerators have a negative value.
+*/
+typedef enum argpar_descr_image_open_status
+{
+    /// Success
+    ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK,
+
+    /*!
+    @brief
+        The image is valid, but its key, its format version, or its ABI
+        doesn't match: write it again.
+    */
+    ARGPAR_DESCR_IMAGE_OPEN_STATUS_STALE,
+
+    /*!
+    @brief
+        The data isn't a valid image (truncated, corrupted, or
+        misaligned): write it again.
+    */
+    ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID,
+
+    /// Memory error
+    ARGPAR_DESCR_IMAGE_OPEN_STATUS_ERROR_MEMORY = -12,
+} argpar_descr_image_open_status_t;
+
+/*!
+@brief
+    Loads the option descriptor image \p data, having the user key
+    \p key, and sets \p *image to the resulting loaded image.
+
+This function validates the whole image (including its checksum) and
+materializes its option descriptors, without copying their names nor
+rebuilding any hash table.
+
+@param[in] data
+    @parblock
+    Image data, as written by argpar_descr_image_write(), aligned on
+    8 bytes (for example, a <code>mmap()</code> mapping).
+
+    \p data must remain valid and unchanged as long as \p *image, as
+    well as the iterators, the items, and the errors created from it,
+    exist.
+    @endparblock
+@param[in] size
+    Size of \p data (bytes).
+@param[in] key
+    Expected user key (see argpar_descr_image_write()).
+@param[in] allocator
+    @parblock
+    Allocator of \p *image and of the iterators created from it, or
+    \c NULL to use the C library.
+
+    \p allocator must remain valid and unchanged as long as \p *image
+    and the iterators, items, and errors created from it exist.
+    @endparblock
+@param[out] image
+    @parblock
+    On success, \p *image is the loaded image.
+
+    Otherwise, \p *image is \c NULL.
+
+    Destroy \p *image with argpar_descr_image_destroy().
+    @endparblock
+
+@returns
+    Status code.
+
+@pre
+    \p data is not \c NULL.
+@pre
+    \p image is not \c NULL.
+*/
+argpar_descr_image_open_status_t
+argpar_descr_image_open(const void *data, size_t size, unsigned long long key,
+                        const argpar_allocator_t *allocator,
+                        const argpar_descr_image_t **image) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL, of the loaded image \p image.
+
+The option descriptors are in the same order as the ones passed to
+argpar_descr_image_write(), without bindings.
+
+@param[in] image
+    Loaded option descriptor image of which to get the option
+    descriptors.
+
+@returns
+    Option descriptors of \p image, valid as long as \p image exists.
+
+@pre
+    \p image is not \c NULL.
+*/
+const argpar_opt_descr_t *
+argpar_descr_image_descrs(const argpar_descr_image_t *image) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Destroys the loaded option descriptor image \p image.
+
+@param[in] image
+    Loaded option descriptor image to destroy (may be \c NULL).
+*/
+void argpar_descr_image_destroy(const argpar_descr_image_t *image) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Like argpar_iter_create(), but uses the option descriptors (see
+    argpar_descr_image_descrs()) and the hash tables of the loaded
+    option descriptor image \p image.
+
+The returned argument parsing iterator allocates its memory, as well
+as its items and errors, with the allocator of \p image (see
+argpar_descr_image_open()).
+
+argpar_item_opt_descr() and argpar_error_opt_descr() return
+descriptors of \p image.
+
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse (see argpar_iter_create()).
+@param[in] image
+    @parblock
+    Loaded option descriptor image.
+
+    \p image must remain valid as long as the returned iterator, its
+    items, and its errors exist.
+    @endparblock
+
+@returns
+    New argument parsing iterator, or \c NULL on memory error.
+
+@pre
+    \p argc is greater than 0.
+@pre
+    \p argv is not \c NULL.
+@pre
+    The first \p argc elements of \p argv are not \c NULL.
+@pre
+    \p image is not \c NULL.
+*/
+argpar_iter_t *argpar_iter_create_with_image(unsigned int argc, const char * const *argv,
+                                             const argpar_descr_image_t *image) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Number of buckets of a latency histogram path (see
+    #argpar_histogram_path_stats_t).
+*/
+#define ARGPAR_HISTOGRAM_BUCKET_COUNT 32
+
+/*!
+@brief
+    Path of an argpar_iter_next() call, as recorded in a latency
+    histogram (see argpar_iter_get_histogram()).
+*/
+typedef enum argpar_histogram_path
+{
+    /// Non-option argument
+    ARGPAR_HISTOGRAM_PATH_NON_OPT,
+
+    /// Short option, possibly within a short option group
+    ARGPAR_HISTOGRAM_PATH_SHORT_OPT,
+
+    /// Long option
+    ARGPAR_HISTOGRAM_PATH_LONG_OPT,
+
+    /// Parsing or memory error
+    ARGPAR_HISTOGRAM_PATH_ERROR,
+} argpar_histogram_path_t;
+
+/*!
+@brief
+    Number of argpar_iter_next() call paths (see
+    #argpar_histogram_path_t).
+*/
+#define ARGPAR_HISTOGRAM_PATH_COUNT 4
+
+/*!
+@brief
+    Latency statistics of the argpar_iter_next() calls of a given path.
+
+The unit of the latencies is \link argpar_histogram::unit the unit of
+the histogram\endlink.
+*/
+typedef struct argpar_histogram_path_stats
+{
+    /// Number of calls
+    unsigned long long call_count;
+
+    /// Total latency
+    unsigned long long total;
+
+    /// Maximum latency
+    unsigned long long max;
+
+    /*!
+    @brief
+        Number of calls per latency bucket.
+
+    Bucket 0 counts the calls having a latency of 0, and
+    bucket <em>i</em> &gt; 0 counts the calls having a latency within
+    [2<sup><em>i</em>&nbsp;&minus;&nbsp;1</sup>,
+    2<sup><em>i</em></sup>). The last bucket also counts all the longer
+    calls.
+    */
+    unsigned long long buckets[ARGPAR_HISTOGRAM_BUCKET_COUNT];
+} argpar_histogram_path_stats_t;
+
+/*!
+@brief
+    Latency histogram of the argpar_iter_next() calls of an argument
+    parsing iterator (see argpar_iter_get_histogram()).
+*/
+typedef struct argpar_histogram
+{
+    /*!
+    @brief
+        Unit of the latencies: <code>cycles</code> (time-stamp counter)
+        or <code>ns</code> (monotonic clock).
+    */
+    const char *unit;
+
+    /// Statistics per call path (see #argpar_histogram_path_t)
+    argpar_histogram_path_stats_t paths[ARGPAR_HISTOGRAM_PATH_COUNT];
+} argpar_histogram_t;
+
+/*!
+@brief
+    Returns the latency histogram of the argpar_iter_next() calls
+    with the argument parsing iterator \p iter, or \c NULL if this
+    build of argpar doesn't record histograms.
+
+argpar only records latency histograms when you build it with the
+\c ARGPAR_ENABLE_HISTOGRAM macro defined (the
+<code>\--enable-histogram</code> option of the \c configure script):
+this diagnostic build reads the time-stamp counter (x86) or the
+monotonic clock (other architectures) twice per argpar_iter_next()
+call. A regular build doesn't have this overhead.
+
+The returned histogram reflects all the argpar_iter_next() calls made
+so far, except the ones which ended the iteration. A call which skips
+options without an argument because of a flag sink (see
+argpar_iter_set_flag_sink()) counts as the path of the item it
+eventually produces.
+
+Print the histogram with argpar_histogram_print().
+
+@param[in] iter
+    Argument parsing iterator of which to get the latency histogram.
+
+@returns
+    @parblock
+    Latency histogram of \p iter, or \c NULL if this build of argpar
+    doesn't record histograms.
+
+    The returned histogram remains valid as long as \p iter exists.
+    @endparblock
+
+@pre
+    \p iter is not \c NULL.
+*/
+const argpar_histogram_t *argpar_iter_get_histogram(const argpar_iter_t *iter) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Prints the latency histogram \p histogram to \p stream in a
+    human-readable form.
+
+This function prints, for each call path having at least one call,
+the call count, the mean and maximum latencies, and one bar per
+nonempty latency bucket.
+
+@param[in] histogram
+    Latency histogram to print.
+@param[in] stream
+    Stream to which to print \p histogram.
+
+@pre
+    \p histogram is not \c NULL.
+@pre
+    \p stream is not \c NULL.
+*/
+void argpar_histogram_print(const argpar_histogram_t *histogram, FILE *stream) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Type of an iterator event (see #argpar_event_t).
+*/
+typedef enum argpar_event_type
+{
+    /// Iterator creation (see argpar_iter_set_event_sink())
+    ARGPAR_EVENT_TYPE_ITER_CREATE,
+
+    /// Successful argpar_iter_next() call
+    ARGPAR_EVENT_TYPE_ITER_NEXT,
+
+    /// Failed argpar_iter_next() call
+    ARGPAR_EVENT_TYPE_ERROR,
+} argpar_event_type_t;
+
+/*!
+@brief
+    Iterator event, as passed to an event sink function (see
+    argpar_iter_set_event_sink()).
+*/
+typedef struct argpar_event
+{
+    /// Type
+    argpar_event_type_t type;
+
+    /// Argument parsing iterator
+    const argpar_iter_t *iter;
+
+    /*!
+    @brief
+        Number of original arguments, as passed to argpar_iter_create()
+        to create #iter.
+    */
+    unsigned int argc;
+
+    /*!
+    @brief
+        Original argument index.
+
+    Depending on #type:
+
+    <dl>
+      <dt>#ARGPAR_EVENT_TYPE_ITER_CREATE</dt>
+      <dd>0.</dd>
+
+      <dt>#ARGPAR_EVENT_TYPE_ITER_NEXT</dt>
+      <dd>
+        Index of the original argument of #item, or the number of
+        ingested original arguments (see
+        argpar_iter_ingested_orig_args()) if #item is \c NULL.
+      </dd>
+
+      <dt>#ARGPAR_EVENT_TYPE_ERROR</dt>
+      <dd>
+        Index of the original argument which caused the error.
+      </dd>
+    </dl>
+    */
+    unsigned int orig_index;
+
+    /*!
+    @brief
+        Status which argpar_iter_next() returns (unused for an
+        #ARGPAR_EVENT_TYPE_ITER_CREATE event).
+    */
+    argpar_iter_next_status_t status;
+
+    /*!
+    @brief
+        Produced item if #status is #ARGPAR_ITER_NEXT_STATUS_OK, or
+        \c NULL otherwise.
+    */
+    const argpar_item_t *item;
+
+    /*!
+    @brief
+        Error if #status is #ARGPAR_ITER_NEXT_STATUS_ERROR, or \c NULL
+        otherwise.
+    */
+    const argpar_error_t *error;
+} argpar_event_t;
+
+/*!
+@brief
+    Event sink function type (see argpar_iter_set_event_sink()).
+
+@param[in] event
+    @parblock
+    Event to consume.
+
+    \p event, as well as its item and error, are only valid during
+    this call.
+    @endparblock
+@param[in] data
+    User data, as passed to argpar_iter_set_event_sink().
+*/
+typedef void (*argpar_event_sink_func_t)(const argpar_event_t *event, void *data);
+
+/*!
+@brief
+    Sets the event sink of the argument parsing iterator \p iter to
+    the function \p func with the user data \p data.
+
+From this call, argpar calls \p func with \p data for each
+iterator event:
+
+- This function immediately emits an
+  #ARGPAR_EVENT_TYPE_ITER_CREATE event.
+
+- Each argpar_iter_next() call which doesn't return
+  #ARGPAR_ITER_NEXT_STATUS_ERROR or
+  #ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY emits an
+  #ARGPAR_EVENT_TYPE_ITER_NEXT event.
+
+- Each argpar_iter_next() call which returns
+  #ARGPAR_ITER_NEXT_STATUS_ERROR or
+  #ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY emits an
+  #ARGPAR_EVENT_TYPE_ERROR event, even if you don't request the
+  error object.
+
+An event sink doesn't change what argpar_iter_next() produces.
+
+See the <code>argpar/argpar-ctf.h</code> header for an event sink
+which writes the events into a
+<a href="https://diamon.org/ctf/v1.8.3/">CTF</a> trace.
+
+@param[in] iter
+    Argument parsing iterator of which to set the event sink.
+@param[in] func
+    Event sink function, or \c NULL to remove the event sink.
+@param[in] data
+    User data to pass to \p func.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    You didn't call argpar_iter_next() with \p iter yet.
+*/
+void argpar_iter_set_event_sink(argpar_iter_t *iter, argpar_event_sink_func_t func,
+                                void *data) ARGPAR_NOEXCEPT;
+
+/// @}
+
+/*!
+@name Batch parsing API
+@{
+
+argpar_parse() parses all the original arguments at once, placing
+all the resulting items into a single contiguous array of a parsing
+result, and splitting them into segments.
+
+A segment is a contiguous range of items which starts with an option
+item for a scope opener descriptor (see
+#ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER), called the \em opener of the
+segment, and which ends right before the next opener item or with the
+last item. The only segment which may not have an opener is the first
+one, for any item preceding the first opener item.
+
+This makes it possible to process position-dependent options, for
+example:
+
+@verbatim
+--verbose --component=src.ctf.fs --path=/trace --component=sink.text.pretty --color
+@endverbatim
+
+where the options following a <code>\--component</code> option apply
+to this component, without buffering and grouping the items yourself:
+
+@code
+for (i = 0; i < argpar_parse_result_segment_count(result); i++) {
+    const argpar_segment_t * const seg = argpar_parse_result_segment(result, i);
+    unsigned int j;
+
+    for (j = seg->first_index; j <= seg->last_index; j++) {
+        const argpar_item_t * const item = argpar_parse_result_item(result, j);
+
+        // ...
+    }
+}
+@endcode
+*/
+
+/// Value of argpar_segment::opener_index for a segment without an opener
+#define ARGPAR_SEGMENT_NO_OPENER ((unsigned int) -1)
+
+/*!
+@brief
+    Segment of the items of a parsing result.
+
+An instance of this type is never empty.
+*/
+typedef struct argpar_segment
+{
+    /*!
+    @brief
+        Index of the opener item within the parsing result, or
+        #ARGPAR_SEGMENT_NO_OPENER if this segment has no opener.
+
+    If this segment has an opener, then the value of this member is
+    equal to \link argpar_segment::first_index first_index\endlink.
+    */
+    unsigned int opener_index;
+
+    /// Index of the first item of this segment within the parsing result
+    unsigned int first_index;
+
+    /// Index of the last item of this segment within the parsing result
+    unsigned int last_index;
+} argpar_segment_t;
+
+/*!
+@struct argpar_parse_result
+
+@brief
+    Opaque parsing result type.
+
+argpar_parse() creates an instance of this type.
+
+Destroy a parsing result with argpar_parse_result_destroy().
+*/
+typedef struct argpar_parse_result argpar_parse_result_t;
+
+/*!
+@brief
+    Return type of argpar_parse().
+
+Error status enumerators have a negative value.
+*/
+typedef enum argpar_parse_status
+{
+    /// Success
+    ARGPAR_PARSE_STATUS_OK,
+
+    /// Parsing error
+    ARGPAR_PARSE_STATUS_ERROR = -1,
+
+    /// Memory error
+    ARGPAR_PARSE_STATUS_ERROR_MEMORY = -12,
+} argpar_parse_status_t;
+
+/*!
+@brief
+    argpar_parse() flags.
+
+You may combine the enumerators with the bitwise OR operator.
+*/
+typedef enum argpar_parse_flag
+{
+    /*!
+    @brief
+        Also compute the GNU-style permutation of the items: all the
+        option items, in order, followed with all the non-option
+        items, in order.
+
+    Get the permuted items with argpar_parse_result_permuted_item()
+    and the number of option items with
+    argpar_parse_result_opt_count().
+
+    argpar_parse() doesn't reorder \p argv, and the permutation doesn't
+    change the original and non-option indexes of the items.
+    */
+    ARGPAR_PARSE_FLAG_PERMUTE = 1U << 0,
+} argpar_parse_flag_t;
+
+/*!
+@brief
+    Parses \em all the original arguments \p argv of which the count
+    is \p argc using the option descriptors \p descrs, and sets
+    \p *result to the resulting items and segments.
+
+This function produces the same items as calling argpar_iter_next()
+until the end, but with a few allocations for all of them instead of
+one allocation per item.
+
+With the #ARGPAR_PARSE_FLAG_PERMUTE flag, this function also computes
+the permutation of the items during the same pass.
+
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse, of which the count is \p argc.
+@param[in] descrs
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+@param[in] flags
+    Flags (#argpar_parse_flag_t enumerators), or 0.
+@param[out] result
+    @parblock
+    On success, \p *result is a new parsing result.
+
+    Destroy \p *result with argpar_parse_result_destroy().
+    @endparblock
+@param[out] error
+    @parblock
+    When this function returns #ARGPAR_PARSE_STATUS_ERROR,
+    if this parameter is not \c NULL, \p *error contains details about
+    the error.
+
+    Destroy \p *error with argpar_error_destroy().
+    @endparblock
+
+@returns
+    Status code.
+
+@pre
+    \p argv is not \c NULL.
+@pre
+    The first \p argc elements of \p argv are not \c NULL.
+@pre
+    \p descrs is not \c NULL.
+@pre
+    \p result is not \c NULL.
+*/
+argpar_parse_status_t argpar_parse(unsigned int argc, const char * const *argv,
+                                   const argpar_opt_descr_t *descrs, unsigned int flags,
+                                   const argpar_parse_result_t **result,
+                                   const argpar_error_t **error) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Like argpar_parse(), but allocates all the memory, including the
+    returned result and error, with the allocator \p allocator.
+
+argpar_parse_result_destroy() and argpar_error_destroy() free memory
+with \p allocator.
+
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse (see argpar_parse()).
+@param[in] descrs
+    Option descriptor array (see argpar_parse()).
+@param[in] flags
+    Flags (see argpar_parse()).
+@param[in] allocator
+    @parblock
+    Allocator, or \c NULL to use the C library.
+
+    \p allocator must remain valid and unchanged as long as
+    \p *result and \p *error exist.
+    @endparblock
+@param[out] result
+    On success, \p *result is the parsing result.
+@param[out] error
+    On parsing error, if not \c NULL, \p *error contains details
+    about the error.
+
+@returns
+    Status code.
+
+@pre
+    Same preconditions as argpar_parse().
+*/
+argpar_parse_status_t
+argpar_parse_with_allocator(unsigned int argc, const char * const *argv,
+                            const argpar_opt_descr_t *descrs, unsigned int flags,
+                            const argpar_allocator_t *allocator,
+                            const argpar_parse_result_t **result,
+                            const argpar_error_t **error) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the number of items of the parsing result \p result.
+
+@param[in] result
+    Parsing result of which to get the number of items.
+
+@returns
+    Number of items of \p result.
+
+@pre
+    \p result is not \c NULL.
+*/
+unsigned int
+argpar_parse_result_item_count(const argpar_parse_result_t *result) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the item at index \p index of the parsing result
+    \p result.
+
+\p result owns the returned item: don't call argpar_item_destroy()
+with it.
+
+@param[in] result
+    Parsing result of which to get the item at index \p index.
+@param[in] index
+    Index of the item to get.
+
+@returns
+    Item of \p result at index \p index.
+
+@pre
+    \p result is not \c NULL.
+@pre
+    \p index is less than argpar_parse_result_item_count().
+*/
+const argpar_item_t *argpar_parse_result_item(const argpar_parse_result_t *result,
+                                              unsigned int index) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the number of segments of the parsing result \p result.
+
+This is zero when \p result has no items.
+
+@param[in] result
+    Parsing result of which to get the number of segments.
+
+@returns
+    Number of segments of \p result.
+
+@pre
+    \p result is not \c NULL.
+*/
+unsigned int
+argpar_parse_result_segment_count(const argpar_parse_result_t *result) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the segment at index \p index of the parsing result
+    \p result.
+
+\p result owns the returned segment.
+
+@param[in] result
+    Parsing result of which to get the segment at index \p index.
+@param[in] index
+    Index of the segment to get.
+
+@returns
+    Segment of \p result at index \p index.
+
+@pre
+    \p result is not \c NULL.
+@pre
+    \p index is less than argpar_parse_result_segment_count().
+*/
+const argpar_segment_t *argpar_parse_result_segment(const argpar_parse_result_t *result,
+                                                    unsigned int index) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the item at index \p index of the permutation of the
+    parsing result \p result.
+
+The permutation contains all the option items of \p result, in order,
+followed with all its non-option items, in order.
+
+\p result owns the returned item: don't call argpar_item_destroy()
+with it.
+
+@param[in] result
+    Parsing result of which to get the permuted item at index
+    \p index.
+@param[in] index
+    Index of the permuted item to get.
+
+@returns
+    Item of \p result at index \p index of its permutation.
+
+@pre
+    \p result is not \c NULL.
+@pre
+    You passed the #ARGPAR_PARSE_FLAG_PERMUTE flag to argpar_parse() to
+    create \p result.
+@pre
+    \p index is less than argpar_parse_result_item_count().
+*/
+const argpar_item_t *argpar_parse_result_permuted_item(const argpar_parse_result_t *result,
+                                                       unsigned int index) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the number of option items of the parsing result
+    \p result, that is, the index of the first non-option item within
+    its permutation, if any.
+
+@param[in] result
+    Parsing result of which to get the number of option items.
+
+@returns
+    Number of option items of \p result.
+
+@pre
+    \p result is not \c NULL.
+@pre
+    You passed the #ARGPAR_PARSE_FLAG_PERMUTE flag to argpar_parse() to
+    create \p result.
+*/
+unsigned int argpar_parse_result_opt_count(const argpar_parse_result_t *result) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Destroys the parsing result \p result, including all its items
+    and segments.
+
+@param[in] result
+    Parsing result to destroy (may be \c NULL).
+*/
+void argpar_parse_result_destroy(const argpar_parse_result_t *result) ARGPAR_NOEXCEPT;
+
+/*!
+@struct argpar_reparser
+
+@brief
+    Opaque incremental reparser type
+
+argpar_reparser_create() returns a pointer to such a type.
+
+An incremental reparser parses \em all the original arguments at once,
+like argpar_parse(), but keeps the results of its last parse (the
+items and, for each original argument, the parsing state at its
+beginning) as well as copies of the original arguments.
+
+When you call argpar_reparser_parse() again, the reparser finds the
+first original argument which changed since the last parse and
+resumes parsing from the last safe boundary before it: an original
+argument which isn't the argument of a preceding option
+(<code>\--output</code> in <code>\--output /x</code>). It reuses the
+items before this boundary as is.
+
+This makes parsing an interactive command line on each keystroke (for
+syntax highlighting or completion) cost a time proportional to the
+edit, usually only affecting the last original argument, instead of to
+the whole command line (except for comparing the original arguments
+with the retained copies).
+
+The typical usage is, for example:
+
+@code
+argpar_reparser_t *reparser = argpar_reparser_create(descrs);
+
+// On each keystroke
+status = argpar_reparser_parse(reparser, argc, argv, &error);
+
+for (i = 0; i < argpar_reparser_item_count(reparser); i++) {
+    highlight_item(argpar_reparser_item(reparser, i));
+}
+@endcode
+*/
+typedef struct argpar_reparser argpar_reparser_t;
+
+/*!
+@brief
+    Creates and returns an incremental reparser using the option
+    descriptors \p descrs.
+
+@param[in] descrs
+    @parblock
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+
+    \p descrs must remain valid and unchanged as long as the returned
+    reparser exists.
+    @endparblock
+
+@returns
+    New incremental reparser, or \c NULL on memory error.
+
+@pre
+    \p descrs is not \c NULL.
+
+@sa
+    argpar_reparser_destroy() -- Destroys an incremental reparser.
+*/
+argpar_reparser_t *argpar_reparser_create(const argpar_opt_descr_t *descrs) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Like argpar_reparser_create(), but makes the returned incremental
+    reparser allocate all its memory, including its errors, with the
+    allocator \p allocator.
+
+@param[in] descrs
+    Option descriptor array (see argpar_reparser_create()).
+@param[in] allocator
+    @parblock
+    Allocator, or \c NULL to use the C library.
+
+    \p allocator must remain valid and unchanged as long as the
+    returned reparser and its errors exist.
+    @endparblock
+
+@returns
+    New incremental reparser, or \c NULL on memory error.
+
+@pre
+    Same preconditions as argpar_reparser_create().
+*/
+argpar_reparser_t *
+argpar_reparser_create_with_allocator(const argpar_opt_descr_t *descrs,
+                                      const argpar_allocator_t *allocator) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Parses \em all the original arguments \p argv of which the count
+    is \p argc with the incremental reparser \p reparser, reusing the
+    results of its last parse up to the last safe boundary before the
+    first changed original argument.
+
+This function produces the same items as argpar_parse() (without
+flags). Get them with argpar_reparser_item_count() and
+argpar_reparser_item(): on parsing error, those are the items before
+the error.
+
+\p reparser keeps copies of the original arguments: \p argv only needs
+to remain valid during this call.
+
+@param[in] reparser
+    Incremental reparser.
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse, of which the count is \p argc.
+@param[out] error
+    @parblock
+    When this function returns #ARGPAR_PARSE_STATUS_ERROR,
+    if this parameter is not \c NULL, \p *error contains details about
+    the error.
+
+    Destroy \p *error with argpar_error_destroy(). The strings of
+    \p *error, except the unknown option name, are only valid until
+    the next call to this function with \p reparser or until you
+    destroy \p reparser.
+    @endparblock
+
+@returns
+    Status code.
+
+    On memory error, the next call to this function parses all the
+    original arguments again.
+
+@pre
+    \p reparser is not \c NULL.
+@pre
+    \p argv is not \c NULL if \p argc is greater than 0.
+@pre
+    The first \p argc elements of \p argv are not \c NULL.
+*/
+argpar_parse_status_t argpar_reparser_parse(argpar_reparser_t *reparser, unsigned int argc,
+                                            const char * const *argv,
+                                            const argpar_error_t **error) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the number of items of the last parse of the incremental
+    reparser \p reparser.
+
+@param[in] reparser
+    Incremental reparser of which to get the number of items.
+
+@returns
+    Number of items of the last parse of \p reparser.
+
+@pre
+    \p reparser is not \c NULL.
+*/
+unsigned int argpar_reparser_item_count(const argpar_reparser_t *reparser) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the item at the index \p index of the last parse of the
+    incremental reparser \p reparser.
+
+@param[in] reparser
+    Incremental reparser of which to get an item.
+@param[in] index
+    Index of the item to get.
+
+@returns
+    @parblock
+    Item at the index \p index, valid until the next call to
+    argpar_reparser_parse() with \p reparser or until you destroy
+    \p reparser.
+
+    Don't destroy this item with argpar_item_destroy().
+    @endparblock
+
+@pre
+    \p reparser is not \c NULL.
+@pre
+    \p index is less than argpar_reparser_item_count().
+*/
+const argpar_item_t *argpar_reparser_item(const argpar_reparser_t *reparser,
+                                          unsigned int index) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the number of leading original arguments of which the last
+    parse of the incremental reparser \p reparser reused the items
+    instead of parsing them again.
+
+@param[in] reparser
+    Incremental reparser of which to get the number of reused original
+    arguments.
+
+@returns
+    Number of reused original arguments of the last parse of
+    \p reparser.
+
+@pre
+    \p reparser is not \c NULL.
+*/
+unsigned int argpar_reparser_reused_orig_args(const argpar_reparser_t *reparser) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Destroys the incremental reparser \p reparser.
+
+@param[in] reparser
+    Incremental reparser to destroy (may be \c NULL).
+*/
+void argpar_reparser_destroy(const argpar_reparser_t *reparser) ARGPAR_NOEXCEPT;
+
+/// @}
+
+/*!
+@name Fingerprint API
+@{
+
+argpar_fingerprint() parses all the original arguments and computes a
+128-bit hash of the resulting items, so that command lines which only
+differ in spelling have the same fingerprint, for example:
+
+- <code>-o x</code>, <code>-ox</code>, <code>\--output x</code>, and
+  <code>\--output=x</code>, for a descriptor having the short option
+  name \c o and the long option name \c output.
+
+- <code>-v -o x</code> and <code>-o x -v</code>, for a descriptor
+  having the short option name \c v and the
+  #ARGPAR_OPT_DESCR_FLAG_ORDER_INSENSITIVE flag.
+*/
+
+/*!
+@brief
+    128-bit hash, such as a command-line fingerprint (see
+    argpar_fingerprint()).
+*/
+typedef struct argpar_hash128
+{
+    /// Most significant 64 bits
+    unsigned long long high;
+
+    /// Least significant 64 bits
+    unsigned long long low;
+} argpar_hash128_t;
+
+/*!
+@brief
+    Return type of argpar_fingerprint().
+
+Error status enumerators have a negative value.
+*/
+typedef enum argpar_fingerprint_status
+{
+    /// Success
+    ARGPAR_FINGERPRINT_STATUS_OK,
+
+    /// Parsing error
+    ARGPAR_FINGERPRINT_STATUS_ERROR = -1,
+
+    /// Memory error
+    ARGPAR_FINGERPRINT_STATUS_ERROR_MEMORY = -12,
+} argpar_fingerprint_status_t;
+
+/*!
+@brief
+    Parses the original arguments \p argv of which the count is
+    \p argc using the option descriptors \p descrs, and sets
+    \p *fingerprint to the fingerprint of the resulting items.
+
+The fingerprint is the 128-bit FNV-1a hash of the normalized form of
+the items, which only contains:
+
+- For an option item: the ID of its descriptor, whether or not it's
+  the negated form, and its argument, if any.
+
+- For a non-option item: its argument.
+
+This function hashes the items of which the option descriptor doesn't
+have the #ARGPAR_OPT_DESCR_FLAG_ORDER_INSENSITIVE flag, including all
+the non-option items, in order. It hashes each other item on its own
+and then adds the sum of those hashes to the fingerprint: the position
+of such an item doesn't matter, but the number of its occurrences
+does.
+
+The fingerprint doesn't depend on the platform: it only depends on
+the original arguments and on the IDs and flags of the option
+descriptors.
+
+This function doesn't create any item: its only allocations are the
+ones of argpar_iter_create().
+
+@param[in] argc
+    Number of original arguments to parse in \p argv.
+@param[in] argv
+    Original arguments to parse, of which the count is \p argc.
+@param[in] descrs
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+@param[out] fingerprint
+    @parblock
+    <strong>On success</strong>, \p *fingerprint is the fingerprint
+    of the command line.
+
+    Otherwise, this function doesn't modify \p *fingerprint.
+    @endparblock
+@param[out] error
+    @parblock
+    When this function returns #ARGPAR_FINGERPRINT_STATUS_ERROR,
+    if this parameter is not \c NULL, \p *error contains details about
+    the error.
+
+    Destroy \p *error with argpar_error_destroy().
+    @endparblock
+
+@returns
+    Status code.
+
+@pre
+    \p argv is not \c NULL.
+@pre
+    The first \p argc elements of \p argv are not \c NULL.
+@pre
+    \p descrs is not \c NULL.
+@pre
+    \p fingerprint is not \c NULL.
+*/
+argpar_fingerprint_status_t argpar_fingerprint(unsigned int argc, const char * const *argv,
+                                               const argpar_opt_descr_t *descrs,
+                                               argpar_hash128_t *fingerprint,
+                                               const argpar_error_t **error) ARGPAR_NOEXCEPT;
+
+/// @}
+
+/*!
+@name Key-value argument API
+@{
+
+A key-value argument iterator walks a structured option argument (as
+returned by argpar_item_opt_arg()), for example:
+
+@code{.unparsed}
+path="/x",begin=12,names=[a,b],range={lo=-3,hi=+7.5}
+@endcode
+
+The grammar is:
+
+- A key-value argument is a comma-separated sequence of
+  <code>KEY=VALUE</code> entries (possibly none).
+
+- A key starts with an ASCII letter or <code>_</code>, followed by
+  any number of ASCII letters, digits, or <code>_</code>,
+  <code>-</code>, <code>.</code>, and <code>:</code> characters.
+
+- A value is one of:
+
+  - A double-quoted string, in which <code>\\</code> escapes the
+    next character: <code>"a \\"b\\" \\\\c"</code>.
+
+  - An array: <code>[</code>, a comma-separated sequence of values, and
+    <code>]</code>.
+
+  - A map: <code>{</code>, a comma-separated sequence of
+    <code>KEY=VALUE</code> entries, and <code>}</code>.
+
+  - An unquoted scalar: a sequence of characters other than
+    whitespaces and <code>"</code>, <code>,</code>, <code>=</code>,
+    <code>[</code>, <code>]</code>, <code>{</code>, and
+    <code>}</code>.
+
+    See #argpar_kv_scalar_type to learn how argpar_kv_iter_next()
+    determines the scalar type of an unquoted scalar.
+
+- Spaces and tabs may surround any token.
+
+Initialize a key-value argument iterator, which you typically allocate
+on the stack, with argpar_kv_iter_init(), and then call
+argpar_kv_iter_next() until it returns #ARGPAR_KV_ITER_NEXT_STATUS_END
+or #ARGPAR_KV_ITER_NEXT_STATUS_ERROR.
+
+argpar_kv_iter_next() produces items which contain slices pointing
+into the original argument: it never allocates memory. If a string
+value contains escape sequences (see
+argpar_kv_item::value_has_escapes), copy and unescape it with
+argpar_slice_unescape(), <code>'\\'</code> being the escape character.
+*/
+
+/// Maximum nesting level of arrays and maps in a key-value argument
+#define ARGPAR_KV_MAX_DEPTH 16
+
+/*!
+@brief
+    Type of a key-value argument item.
+*/
+typedef enum argpar_kv_item_type
+{
+    /// Scalar value
+    ARGPAR_KV_ITEM_TYPE_SCALAR,
+
+    /// Beginning of an array value (<code>[</code>)
+    ARGPAR_KV_ITEM_TYPE_ARRAY_BEGIN,
+
+    /// End of an array value (<code>]</code>)
+    ARGPAR_KV_ITEM_TYPE_ARRAY_END,
+
+    /// Beginning of a map value (<code>{</code>)
+    ARGPAR_KV_ITEM_TYPE_MAP_BEGIN,
+
+    /// End of a map value (<code>}</code>)
+    ARGPAR_KV_ITEM_TYPE_MAP_END,
+} argpar_kv_item_type_t;
+
+/*!
+@brief
+    Type of a key-value argument scalar value.
+
+argpar_kv_iter_next() determines the type of an unquoted scalar as
+follows:
+
+- <code>null</code>, <code>NULL</code>, or <code>nul</code>:
+  #ARGPAR_KV_SCALAR_TYPE_NULL.
+
+- <code>true</code>, <code>TRUE</code>, <code>yes</code>,
+  <code>YES</code>, <code>false</code>, <code>FALSE</code>,
+  <code>no</code>, or <code>NO</code>: #ARGPAR_KV_SCALAR_TYPE_BOOL.
+
+- A decimal, hexadecimal (<code>0x</code> prefix), or octal
+  (<code>0</code> prefix) integer which fits a <code>long long</code>,
+  possibly with a <code>-</code> prefix:
+  #ARGPAR_KV_SCALAR_TYPE_SIGNED_INT.
+
+- Such an integer which fits an <code>unsigned long long</code>,
+  with a <code>+</code> prefix: #ARGPAR_KV_SCALAR_TYPE_UNSIGNED_INT.
+
+- A number which <code>strtod()</code> fully parses, starting with a
+  digit, a <code>+</code> or <code>-</code> sign, or <code>.</code>:
+  #ARGPAR_KV_SCALAR_TYPE_REAL.
+
+- Anything else: #ARGPAR_KV_SCALAR_TYPE_STRING.
+
+A double-quoted string is always #ARGPAR_KV_SCALAR_TYPE_STRING.
+*/
+typedef enum argpar_kv_scalar_type
+{
+    /// Null
+    ARGPAR_KV_SCALAR_TYPE_NULL,
+
+    /// Boolean (see argpar_kv_item::bool_val)
+    ARGPAR_KV_SCALAR_TYPE_BOOL,
+
+    /// Signed integer (see argpar_kv_item::int_val)
+    ARGPAR_KV_SCALAR_TYPE_SIGNED_INT,
+
+    /// Unsigned integer (see argpar_kv_item::uint_val)
+    ARGPAR_KV_SCALAR_TYPE_UNSIGNED_INT,
+
+    /// Real number (see argpar_kv_item::real_val)
+    ARGPAR_KV_SCALAR_TYPE_REAL,
+
+    /// String (see argpar_kv_item::value)
+    ARGPAR_KV_SCALAR_TYPE_STRING,
+} argpar_kv_scalar_type_t;
+
+/*!
+@brief
+    Key-value argument item, as set by argpar_kv_iter_next().
+*/
+typedef struct argpar_kv_item
+{
+    /// Type
+    argpar_kv_item_type_t type;
+
+    /*!
+    @brief
+        Key of the entry.
+
+    \link argpar_slice::ptr ptr\endlink is \c NULL for an array element
+    and for the #ARGPAR_KV_ITEM_TYPE_ARRAY_END and
+    #ARGPAR_KV_ITEM_TYPE_MAP_END types.
+    */
+    argpar_slice_t key;
+
+    /// Scalar type, if the type is #ARGPAR_KV_ITEM_TYPE_SCALAR
+    argpar_kv_scalar_type_t scalar_type;
+
+    /*!
+    @brief
+        Raw value text, if the type is #ARGPAR_KV_ITEM_TYPE_SCALAR.
+
+    For a double-quoted string, this excludes the double quotes, but
+    includes any escape character.
+    */
+    argpar_slice_t value;
+
+    /*!
+    @brief
+        \c true if \link argpar_kv_item::value value\endlink contains
+        at least one escape character.
+    */
+    bool value_has_escapes;
+
+    /// Boolean value (#ARGPAR_KV_SCALAR_TYPE_BOOL scalar type)
+    bool bool_val;
+
+    /// Signed integer value (#ARGPAR_KV_SCALAR_TYPE_SIGNED_INT scalar type)
+    long long int_val;
+
+    /// Unsigned integer value (#ARGPAR_KV_SCALAR_TYPE_UNSIGNED_INT scalar type)
+    unsigned long long uint_val;
+
+    /// Real value (#ARGPAR_KV_SCALAR_TYPE_REAL scalar type)
+    double real_val;
+} argpar_kv_item_t;
+
+/*!
+@brief
+    Key-value argument iterator.
+
+Initialize such a structure with argpar_kv_iter_init().
+
+All the members are internal: don't access them directly.
+*/
+typedef struct argpar_kv_iter
+{
+    /* Internal: complete argument */
+    const char *arg;
+
+    /* Internal: current position within `arg` */
+    const char *pos;
+
+    /* Internal: parsing state */
+    int state;
+
+    /* Internal: current nesting level */
+    unsigned int depth;
+
+    /* Internal: container types (`[` or `{`) */
+    char containers[ARGPAR_KV_MAX_DEPTH];
+} argpar_kv_iter_t;
+
+/*!
+@brief
+    Initializes the key-value argument iterator \p iter to iterate the
+    argument \p arg.
+
+\p arg must not change for the lifetime of \p iter and of the items
+which argpar_kv_iter_next() produces from it.
+
+@param[out] iter
+    Key-value argument iterator to initialize.
+@param[in] arg
+    Key-value argument to iterate.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    \p arg is not \c NULL.
+*/
+void argpar_kv_iter_init(argpar_kv_iter_t *iter, const char *arg) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Return type of argpar_kv_iter_next().
+*/
+typedef enum argpar_kv_iter_next_status
+{
+    /// Success
+    ARGPAR_KV_ITER_NEXT_STATUS_OK,
+
+    /// End of iteration
+    ARGPAR_KV_ITER_NEXT_STATUS_END,
+
+    /// Syntax error (see argpar_kv_iter_offset())
+    ARGPAR_KV_ITER_NEXT_STATUS_ERROR = -1,
+} argpar_kv_iter_next_status_t;
+
+/*!
+@brief
+    Sets \p *item to the next item of the key-value argument iterator
+    \p iter and advances \p iter.
+
+Once this function returns #ARGPAR_KV_ITER_NEXT_STATUS_END or
+#ARGPAR_KV_ITER_NEXT_STATUS_ERROR, it keeps returning the same status.
+
+@param[in] iter
+    Key-value argument iterator from which to get the next item.
+@param[out] item
+    On success, \p *item is the next item of \p iter.
+
+@returns
+    Status code.
+
+@pre
+    \p iter is not \c NULL.
+@pre
+    \p item is not \c NULL.
+*/
+argpar_kv_iter_next_status_t argpar_kv_iter_next(argpar_kv_iter_t *iter,
+                                                 argpar_kv_item_t *item) ARGPAR_NOEXCEPT;
+
+/*!
+@brief
+    Returns the current character offset, within the argument which
+    you passed to argpar_kv_iter_init(), of the key-value argument
+    iterator \p iter.
+
+When argpar_kv_iter_next() returns #ARGPAR_KV_ITER_NEXT_STATUS_ERROR,
+this is the offset of the offending character.
+
+@param[in] iter
+    Key-value argument iterator of which to get the current offset.
+
+@returns
+    Current character offset of \p iter.
+
+@pre
+    \p iter is not \c NULL.
+*/
+size_t argpar_kv_iter_offset(const argpar_kv_iter_t *iter) ARGPAR_NOEXCEPT;
+
 /// @}
 
 /// @}
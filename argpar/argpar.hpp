@@ -0,0 +1,1437 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+#ifndef ARGPAR_ARGPAR_HPP
+#define ARGPAR_ARGPAR_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "argpar.h"
+
+/*!
+@file
+
+C++20 API.
+
+This header-only API wraps the iterator API of argpar into a
+coroutine-based generator: argpar::parse() returns a lazy input range
+of lightweight item views, which you may iterate with a range-based
+<code>for</code> loop or compose with C++20 range adaptors, without
+materializing a container of items.
+
+Example:
+
+@code
+const std::span<const char * const> args {argv + 1, argv + argc};
+
+for (const auto item : argpar::parse(args, descrs) |
+                       std::views::filter([](const argpar::Item item) {
+                           return item.isOpt();
+                       })) {
+    // Use item.descr() and item.arg()...
+}
+@endcode
+
+A full parse makes three allocations, whatever the number of items:
+the coroutine frame, the argument parsing iterator, and its temporary
+buffer (see argpar_iter_borrow_next()).
+
+Both argpar::parse() and argpar::ParseResult accept a
+<code>std::pmr::memory_resource</code> from which to allocate all
+their memory, including the one of the C&nbsp;core (see
+argpar_allocator_t), for example a per-request
+<code>std::pmr::monotonic_buffer_resource</code>.
+
+argpar::tryParse() is like argpar::parse(), but produces a parsing
+error as an argpar::Expected value holding a by-value argpar::Error
+instead of throwing: reporting such an error doesn't allocate memory.
+
+argpar::Opts declares typed options as a compile-time list, generating
+the option descriptor table at compile time and converting each option
+argument to the declared type:
+
+@code
+using MyOpts = argpar::Opts<argpar::Flag<'v', "verbose">,
+                            argpar::Value<std::int64_t, 'j', "jobs">>;
+
+const auto result = MyOpts::parse(args);
+
+if (result.get<"verbose">()) {
+    // ...
+}
+
+const std::int64_t jobs = result.get<"jobs">().value_or(1);
+@endcode
+*/
+
+namespace argpar {
+namespace internal {
+
+/*
+ * Size of the header which precedes each memory block of
+ * pmrRealloc(): the C core doesn't pass the size of a block to free,
+ * whereas std::pmr::memory_resource::deallocate() needs it.
+ */
+constexpr std::size_t pmrHeaderSize = alignof(std::max_align_t);
+
+/* `realloc_func` of an allocator which wraps a memory resource */
+inline void *pmrRealloc(void * const ptr, const std::size_t size, void * const data) noexcept
+{
+    const auto res = static_cast<std::pmr::memory_resource *>(data);
+    char *block;
+
+    try {
+        block = static_cast<char *>(res->allocate(size + pmrHeaderSize, pmrHeaderSize));
+    } catch (...) {
+        return nullptr;
+    }
+
+    std::memcpy(block, &size, sizeof(size));
+
+    if (ptr) {
+        const auto oldBlock = static_cast<char *>(ptr) - pmrHeaderSize;
+        std::size_t oldSize;
+
+        std::memcpy(&oldSize, oldBlock, sizeof(oldSize));
+        std::memcpy(block + pmrHeaderSize, ptr, std::min(oldSize, size));
+        res->deallocate(oldBlock, oldSize + pmrHeaderSize, pmrHeaderSize);
+    }
+
+    return block + pmrHeaderSize;
+}
+
+/* `free_func` of an allocator which wraps a memory resource */
+inline void pmrFree(void * const ptr, void * const data) noexcept
+{
+    const auto block = static_cast<char *>(ptr) - pmrHeaderSize;
+    std::size_t size;
+
+    std::memcpy(&size, block, sizeof(size));
+    static_cast<std::pmr::memory_resource *>(data)->deallocate(block, size + pmrHeaderSize,
+                                                               pmrHeaderSize);
+}
+
+/*
+ * Returns a new allocator, allocated from the memory resource `res`,
+ * which wraps `res`, or an empty pointer if `res` is `nullptr`.
+ *
+ * The objects of the C core keep a pointer to their allocator: its
+ * address must not change when moving its owner.
+ */
+inline std::shared_ptr<const argpar_allocator_t>
+makePmrAllocator(std::pmr::memory_resource * const res)
+{
+    if (!res) {
+        return {};
+    }
+
+    return std::allocate_shared<argpar_allocator_t>(std::pmr::polymorphic_allocator<> {res},
+                                                    argpar_allocator_t {pmrRealloc, pmrFree, res});
+}
+
+using IterPtr = std::unique_ptr<argpar_iter_t, void (*)(argpar_iter_t *)>;
+
+/*
+ * Creates an argument parsing iterator with `allocator` (may be
+ * `nullptr`), throwing `std::bad_alloc` on memory error.
+ */
+inline IterPtr createIter(const std::span<const char * const> argv,
+                          const argpar_opt_descr_t * const descrs,
+                          const argpar_allocator_t * const allocator)
+{
+    IterPtr iter {argpar_iter_create_with_allocator(static_cast<unsigned int>(argv.size()),
+                                                    argv.data(), descrs, allocator),
+                  argpar_iter_destroy};
+
+    if (!iter) {
+        throw std::bad_alloc {};
+    }
+
+    return iter;
+}
+
+} /* namespace internal */
+
+/*!
+@brief
+    View of a parsing item (see argpar_item_t).
+
+An item view is only valid until the generator which produced it
+advances.
+*/
+class Item final
+{
+public:
+    /// Builds a view of the parsing item \p item.
+    explicit Item(const argpar_item_t * const item) noexcept : _mItem {item}
+    {
+    }
+
+    /// Type of the item.
+    argpar_item_type_t type() const noexcept
+    {
+        return argpar_item_type(_mItem);
+    }
+
+    /// Whether or not this is an option item.
+    bool isOpt() const noexcept
+    {
+        return this->type() == ARGPAR_ITEM_TYPE_OPT;
+    }
+
+    /// Whether or not this is a non-option item.
+    bool isNonOpt() const noexcept
+    {
+        return this->type() == ARGPAR_ITEM_TYPE_NON_OPT;
+    }
+
+    /*!
+    @brief
+        Option descriptor of this option item.
+
+    @pre
+        This is an option item.
+    */
+    const argpar_opt_descr_t& descr() const noexcept
+    {
+        return *argpar_item_opt_descr(_mItem);
+    }
+
+    /*!
+    @brief
+        Argument of this item.
+
+    For an option item, this is its argument, or \c nullptr if none
+    (see argpar_item_opt_arg()). For a non-option item, this is the
+    complete original argument (see argpar_item_non_opt_arg()).
+    */
+    const char *arg() const noexcept
+    {
+        return this->isOpt() ? argpar_item_opt_arg(_mItem) : argpar_item_non_opt_arg(_mItem);
+    }
+
+    /*!
+    @brief
+        Whether or not this option item is the negated form of its
+        option (see argpar_item_opt_is_negated()).
+
+    @pre
+        This is an option item.
+    */
+    bool isNegated() const noexcept
+    {
+        return argpar_item_opt_is_negated(_mItem);
+    }
+
+    /*!
+    @brief
+        Index of this non-option item amongst all the original
+        arguments (see argpar_item_non_opt_orig_index()).
+
+    @pre
+        This is a non-option item.
+    */
+    unsigned int origIndex() const noexcept
+    {
+        return argpar_item_non_opt_orig_index(_mItem);
+    }
+
+    /*!
+    @brief
+        Index of this non-option item amongst the other non-option
+        items (see argpar_item_non_opt_non_opt_index()).
+
+    @pre
+        This is a non-option item.
+    */
+    unsigned int nonOptIndex() const noexcept
+    {
+        return argpar_item_non_opt_non_opt_index(_mItem);
+    }
+
+    /// Wrapped parsing item.
+    const argpar_item_t *libObjPtr() const noexcept
+    {
+        return _mItem;
+    }
+
+private:
+    const argpar_item_t *_mItem;
+};
+
+/*!
+@brief
+    Parsing error, by value.
+
+Unlike an #argpar_error_t, such an error doesn't own any memory: its
+unknown option name, option descriptor, and invalid option argument
+are views of the original arguments and option descriptors, so that
+it remains valid as long as they do.
+*/
+class Error final
+{
+public:
+    /// Builds a parsing error from the details of \p error.
+    explicit Error(const argpar_error_t * const error) noexcept :
+        _mType {argpar_error_type(error)}, _mOrigIndex {argpar_error_orig_index(error)}
+    {
+        switch (_mType) {
+        case ARGPAR_ERROR_TYPE_UNKNOWN_OPT:
+        {
+            const auto name = argpar_error_unknown_opt_name_slice(error, &_mIsShort);
+
+            _mUnknownOptName = {name.ptr, name.len};
+            return;
+        }
+        case ARGPAR_ERROR_TYPE_INVALID_CHOICE:
+            _mChoiceSuggestion = argpar_error_invalid_choice_suggestion(error);
+            _mInvalidOptArg = argpar_error_invalid_opt_arg(error);
+            break;
+        case ARGPAR_ERROR_TYPE_INVALID_OPT_ARG:
+            _mInvalidOptArg = argpar_error_invalid_opt_arg(error);
+            break;
+        default:
+            break;
+        }
+
+        _mDescr = argpar_error_opt_descr(error, &_mIsShort);
+    }
+
+    /// Type of the error.
+    argpar_error_type_t type() const noexcept
+    {
+        return _mType;
+    }
+
+    /// Index of the original argument which caused the error.
+    unsigned int origIndex() const noexcept
+    {
+        return _mOrigIndex;
+    }
+
+    /*!
+    @brief
+        Name of the unknown option, \em without its <code>-</code> or
+        <code>\--</code> prefix (see isShort()), within the original
+        argument.
+
+    @pre
+        type() returns #ARGPAR_ERROR_TYPE_UNKNOWN_OPT.
+    */
+    std::string_view unknownOptName() const noexcept
+    {
+        return _mUnknownOptName;
+    }
+
+    /*!
+    @brief
+        Descriptor of the option which caused the error, or \c nullptr
+        for an unknown option.
+    */
+    const argpar_opt_descr_t *descr() const noexcept
+    {
+        return _mDescr;
+    }
+
+    /// Whether or not a short option caused the error.
+    bool isShort() const noexcept
+    {
+        return _mIsShort;
+    }
+
+    /*!
+    @brief
+        Invalid option argument, within the original arguments, for an
+        #ARGPAR_ERROR_TYPE_INVALID_CHOICE or
+        #ARGPAR_ERROR_TYPE_INVALID_OPT_ARG error, or \c nullptr.
+    */
+    const char *invalidOptArg() const noexcept
+    {
+        return _mInvalidOptArg;
+    }
+
+    /*!
+    @brief
+        Suggested choice for an #ARGPAR_ERROR_TYPE_INVALID_CHOICE error,
+        or \c nullptr (see argpar_error_invalid_choice_suggestion()).
+    */
+    const char *choiceSuggestion() const noexcept
+    {
+        return _mChoiceSuggestion;
+    }
+
+    /// Builds and returns an English message describing this error.
+    std::string message() const
+    {
+        switch (_mType) {
+        case ARGPAR_ERROR_TYPE_UNKNOWN_OPT:
+            return std::string {"Unknown option `"} + (_mIsShort ? "-" : "--") +
+                   std::string {_mUnknownOptName} + '`';
+        case ARGPAR_ERROR_TYPE_MISSING_OPT_ARG:
+            return "Missing option argument";
+        case ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG:
+            return "Unexpected option argument";
+        case ARGPAR_ERROR_TYPE_INVALID_CHOICE:
+            return std::string {"Invalid choice `"} + _mInvalidOptArg + '`';
+        case ARGPAR_ERROR_TYPE_INVALID_OPT_ARG:
+            return std::string {"Invalid option argument `"} + _mInvalidOptArg + '`';
+        }
+
+        return "Parsing error";
+    }
+
+private:
+    argpar_error_type_t _mType;
+    unsigned int _mOrigIndex;
+    std::string_view _mUnknownOptName;
+    const argpar_opt_descr_t *_mDescr = nullptr;
+    bool _mIsShort = false;
+    const char *_mInvalidOptArg = nullptr;
+    const char *_mChoiceSuggestion = nullptr;
+};
+
+/*!
+@brief
+    Parsing error exception, as thrown when advancing a generator which
+    argpar::parse() returns or when building an argpar::ParseResult.
+*/
+class ParseError final : public std::runtime_error
+{
+public:
+    /// Builds a parsing error exception for \p error.
+    explicit ParseError(const Error& error) : std::runtime_error {error.message()}, _mError {error}
+    {
+    }
+
+    /// Parsing error.
+    const Error& error() const noexcept
+    {
+        return _mError;
+    }
+
+    /// Type of the error.
+    argpar_error_type_t type() const noexcept
+    {
+        return _mError.type();
+    }
+
+    /// Index of the original argument which caused the error.
+    unsigned int origIndex() const noexcept
+    {
+        return _mError.origIndex();
+    }
+
+private:
+    Error _mError;
+};
+
+/*!
+@brief
+    Either a \p ValT value or a parsing error (argpar::Error), like
+    C++23's <code>std::expected</code>.
+*/
+template <typename ValT>
+class Expected final
+{
+public:
+    Expected(const ValT& val) noexcept(std::is_nothrow_copy_constructible_v<ValT>) :
+        _mVal {std::in_place_index<0>, val}
+    {
+    }
+
+    Expected(const Error& error) noexcept : _mVal {std::in_place_index<1>, error}
+    {
+    }
+
+    /// Whether or not this contains a value.
+    bool hasValue() const noexcept
+    {
+        return _mVal.index() == 0;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return this->hasValue();
+    }
+
+    /*!
+    @brief
+        Contained value.
+
+    @throws argpar::ParseError
+        This contains an error.
+    */
+    const ValT& value() const
+    {
+        if (!this->hasValue()) {
+            throw ParseError {this->error()};
+        }
+
+        return **this;
+    }
+
+    /*!
+    @brief
+        Contained value.
+
+    @pre
+        hasValue() returns \c true.
+    */
+    const ValT& operator*() const noexcept
+    {
+        return std::get<0>(_mVal);
+    }
+
+    const ValT *operator->() const noexcept
+    {
+        return &std::get<0>(_mVal);
+    }
+
+    /*!
+    @brief
+        Contained error.
+
+    @pre
+        hasValue() returns \c false.
+    */
+    const Error& error() const noexcept
+    {
+        return std::get<1>(_mVal);
+    }
+
+private:
+    std::variant<ValT, Error> _mVal;
+};
+
+/*!
+@brief
+    Move-only, lazy input range of \p ValT values which a coroutine
+    produces with <code>co_yield</code>.
+*/
+template <typename ValT>
+class Generator final : public std::ranges::view_base
+{
+public:
+    class promise_type final
+    {
+    public:
+        /*
+         * Allocates the coroutine frame from the first memory
+         * resource amongst the parameters of the coroutine, or from
+         * the new/delete memory resource if none, storing the memory
+         * resource after the frame.
+         */
+        template <typename... ArgTs>
+        static void *operator new(const std::size_t size, const ArgTs&...args)
+        {
+            std::pmr::memory_resource *res = nullptr;
+
+            (
+                [&res](const auto& arg) {
+                    if constexpr (std::is_convertible_v<decltype(arg),
+                                                        std::pmr::memory_resource *>) {
+                        if (!res) {
+                            res = arg;
+                        }
+                    }
+                }(args),
+                ...);
+
+            if (!res) {
+                res = std::pmr::new_delete_resource();
+            }
+
+            const auto frame = static_cast<char *>(
+                res->allocate(_resOffset(size) + sizeof(res), alignof(std::max_align_t)));
+
+            std::memcpy(frame + _resOffset(size), &res, sizeof(res));
+            return frame;
+        }
+
+        static void operator delete(void * const ptr, const std::size_t size) noexcept
+        {
+            const auto frame = static_cast<char *>(ptr);
+            std::pmr::memory_resource *res;
+
+            std::memcpy(&res, frame + _resOffset(size), sizeof(res));
+            res->deallocate(frame, _resOffset(size) + sizeof(res), alignof(std::max_align_t));
+        }
+
+        Generator get_return_object() noexcept
+        {
+            return Generator {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always yield_value(const ValT& val) noexcept
+        {
+            /* `val` lives in the coroutine frame until it resumes */
+            _mVal = std::addressof(val);
+            return {};
+        }
+
+        void return_void() const noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            _mExc = std::current_exception();
+        }
+
+        /* Rethrows the pending exception of the coroutine, if any */
+        void rethrowIfExc()
+        {
+            if (_mExc) {
+                std::rethrow_exception(std::exchange(_mExc, nullptr));
+            }
+        }
+
+        const ValT& val() const noexcept
+        {
+            return *_mVal;
+        }
+
+    private:
+        /* Offset of the memory resource within a frame of `size` bytes */
+        static constexpr std::size_t _resOffset(const std::size_t size) noexcept
+        {
+            return (size + alignof(std::pmr::memory_resource *) - 1) &
+                   ~(alignof(std::pmr::memory_resource *) - 1);
+        }
+
+        const ValT *_mVal = nullptr;
+        std::exception_ptr _mExc;
+    };
+
+    class Iterator final
+    {
+    public:
+        using value_type = ValT;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() noexcept = default;
+
+        explicit Iterator(const std::coroutine_handle<promise_type> handle) noexcept :
+            _mHandle {handle}
+        {
+        }
+
+        Iterator& operator++()
+        {
+            _mHandle.resume();
+            _mHandle.promise().rethrowIfExc();
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        const ValT& operator*() const noexcept
+        {
+            return _mHandle.promise().val();
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept
+        {
+            return !_mHandle || _mHandle.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> _mHandle;
+    };
+
+    Generator(Generator&& other) noexcept : _mHandle {std::exchange(other._mHandle, nullptr)}
+    {
+    }
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+        std::swap(_mHandle, other._mHandle);
+        return *this;
+    }
+
+    ~Generator()
+    {
+        if (_mHandle) {
+            _mHandle.destroy();
+        }
+    }
+
+    /*!
+    @brief
+        Starts the coroutine and returns an iterator to its first value.
+
+    Call this only once.
+    */
+    Iterator begin()
+    {
+        _mHandle.resume();
+        _mHandle.promise().rethrowIfExc();
+        return Iterator {_mHandle};
+    }
+
+    std::default_sentinel_t end() const noexcept
+    {
+        return {};
+    }
+
+private:
+    explicit Generator(const std::coroutine_handle<promise_type> handle) noexcept :
+        _mHandle {handle}
+    {
+    }
+
+    std::coroutine_handle<promise_type> _mHandle;
+};
+
+/*
+ * GCC doesn't see that the coroutine frame deallocation function
+ * matches the allocation one with the parameters of the coroutine.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+/*!
+@brief
+    Returns a generator of the items of the original arguments \p argv
+    using the option descriptors \p descrs.
+
+The generator parses the next original argument when you advance it.
+The items are views of the borrowed items of the underlying argument
+parsing iterator (see argpar_iter_borrow_next()): they're only valid
+until the generator advances.
+
+When advancing the generator:
+
+- On parsing error, it throws argpar::ParseError.
+- On memory error, it throws <code>std::bad_alloc</code>.
+
+@param[in] argv
+    Original arguments, which must remain valid and unchanged as long
+    as the returned generator and its items exist.
+@param[in] descrs
+    @parblock
+    Option descriptor array, terminated with
+    #ARGPAR_OPT_DESCR_SENTINEL.
+
+    \p descrs must remain valid and unchanged as long as the returned
+    generator and its items exist.
+    @endparblock
+@param[in] res
+    @parblock
+    Memory resource from which to allocate the coroutine frame and the
+    underlying argument parsing iterator, or \c nullptr to use the
+    global <code>operator new</code> and the C library.
+
+    \p res must outlive the returned generator.
+    @endparblock
+*/
+inline Generator<Item> parse(const std::span<const char * const> argv,
+                             const argpar_opt_descr_t * const descrs,
+                             std::pmr::memory_resource * const res = nullptr)
+{
+    const auto allocator = internal::makePmrAllocator(res);
+    const auto iter = internal::createIter(argv, descrs, allocator.get());
+
+    while (true) {
+        const argpar_item_t *item = nullptr;
+        const argpar_error_t *error = nullptr;
+
+        switch (argpar_iter_borrow_next(iter.get(), &item, &error)) {
+        case ARGPAR_ITER_NEXT_STATUS_OK:
+            co_yield Item {item};
+            break;
+        case ARGPAR_ITER_NEXT_STATUS_ERROR:
+            throw ParseError {Error {error}};
+        case ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY:
+            throw std::bad_alloc {};
+        default:
+            co_return;
+        }
+    }
+}
+
+/*!
+@brief
+    Like argpar::parse(), but the returned generator produces a parsing
+    error as its last element instead of throwing.
+
+Reporting a parsing error this way never allocates memory (unless the
+unknown option name is very long), making error-heavy parsing, for
+example to complete partially typed options, as cheap as parsing valid
+original arguments.
+*/
+inline Generator<Expected<Item>> tryParse(const std::span<const char * const> argv,
+                                          const argpar_opt_descr_t * const descrs,
+                                          std::pmr::memory_resource * const res = nullptr)
+{
+    const auto allocator = internal::makePmrAllocator(res);
+    const auto iter = internal::createIter(argv, descrs, allocator.get());
+
+    while (true) {
+        const argpar_item_t *item = nullptr;
+        const argpar_error_t *error = nullptr;
+
+        switch (argpar_iter_borrow_next(iter.get(), &item, &error)) {
+        case ARGPAR_ITER_NEXT_STATUS_OK:
+            co_yield Item {item};
+            break;
+        case ARGPAR_ITER_NEXT_STATUS_ERROR:
+            co_yield Error {error};
+            co_return;
+        case ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY:
+            throw std::bad_alloc {};
+        default:
+            co_return;
+        }
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#    pragma GCC diagnostic pop
+#endif
+
+/*!
+@brief
+    Allocator-aware result of a batch parsing (see argpar_parse()).
+
+All the memory of a parsing result, including the one of the C core,
+comes from its memory resource: with a
+<code>std::pmr::monotonic_buffer_resource</code>, releasing the
+resource releases everything at once.
+*/
+class ParseResult final
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    /*!
+    @brief
+        Parses all the original arguments \p argv using the option
+        descriptors \p descrs and the batch parsing flags \p flags (see
+        #argpar_parse_flag_t), allocating from \p alloc.
+
+    @throws argpar::ParseError
+        Parsing error.
+    @throws std::bad_alloc
+        Memory error.
+    */
+    explicit ParseResult(const std::span<const char * const> argv,
+                         const argpar_opt_descr_t * const descrs, const unsigned int flags = 0,
+                         const allocator_type alloc = {}) :
+        _mAllocator {internal::makePmrAllocator(alloc.resource())},
+        _mItems {alloc}, _mPermutedItems {alloc}, _mSegments {alloc}
+    {
+        const argpar_parse_result_t *result = nullptr;
+        const argpar_error_t *error = nullptr;
+
+        switch (argpar_parse_with_allocator(static_cast<unsigned int>(argv.size()), argv.data(),
+                                            descrs, flags, _mAllocator.get(), &result, &error)) {
+        case ARGPAR_PARSE_STATUS_OK:
+            break;
+        case ARGPAR_PARSE_STATUS_ERROR:
+        {
+            const Error byValError {error};
+
+            argpar_error_destroy(error);
+            throw ParseError {byValError};
+        }
+        default:
+            throw std::bad_alloc {};
+        }
+
+        _mResult.reset(result);
+
+        const auto itemCount = argpar_parse_result_item_count(result);
+        const auto segCount = argpar_parse_result_segment_count(result);
+
+        _mItems.reserve(itemCount);
+
+        for (unsigned int i = 0; i < itemCount; ++i) {
+            _mItems.emplace_back(argpar_parse_result_item(result, i));
+        }
+
+        if (flags & ARGPAR_PARSE_FLAG_PERMUTE) {
+            _mPermutedItems.reserve(itemCount);
+
+            for (unsigned int i = 0; i < itemCount; ++i) {
+                _mPermutedItems.emplace_back(argpar_parse_result_permuted_item(result, i));
+            }
+        }
+
+        _mSegments.reserve(segCount);
+
+        for (unsigned int i = 0; i < segCount; ++i) {
+            _mSegments.push_back(*argpar_parse_result_segment(result, i));
+        }
+    }
+
+    /// Memory resource of this result.
+    allocator_type get_allocator() const noexcept
+    {
+        return _mItems.get_allocator();
+    }
+
+    /// Items, in the order of the original arguments.
+    const std::pmr::vector<Item>& items() const noexcept
+    {
+        return _mItems;
+    }
+
+    /*!
+    @brief
+        Items in GNU order (options first), or an empty vector without
+        the #ARGPAR_PARSE_FLAG_PERMUTE flag (see
+        argpar_parse_result_permuted_item()).
+    */
+    const std::pmr::vector<Item>& permutedItems() const noexcept
+    {
+        return _mPermutedItems;
+    }
+
+    /// Segments (see argpar_parse_result_segment()).
+    const std::pmr::vector<argpar_segment_t>& segments() const noexcept
+    {
+        return _mSegments;
+    }
+
+    /// Wrapped parsing result.
+    const argpar_parse_result_t *libObjPtr() const noexcept
+    {
+        return _mResult.get();
+    }
+
+private:
+    struct _ResultDeleter final
+    {
+        void operator()(const argpar_parse_result_t * const result) const noexcept
+        {
+            argpar_parse_result_destroy(result);
+        }
+    };
+
+    /* Allocator of `_mResult`: must outlive it */
+    std::shared_ptr<const argpar_allocator_t> _mAllocator;
+
+    std::unique_ptr<const argpar_parse_result_t, _ResultDeleter> _mResult;
+    std::pmr::vector<Item> _mItems;
+    std::pmr::vector<Item> _mPermutedItems;
+    std::pmr::vector<argpar_segment_t> _mSegments;
+};
+
+/*!
+@brief
+    Invalid option argument, as thrown when argpar::Opts::parse() fails
+    to convert an option argument to the declared type of its option.
+*/
+class InvalidOptArgError final : public std::runtime_error
+{
+public:
+    explicit InvalidOptArgError(const argpar_opt_descr_t& descr, const char * const arg) :
+        std::runtime_error {std::string {"Invalid option argument `"} + arg + '`'},
+        _mDescr {&descr}, _mArg {arg}
+    {
+    }
+
+    /// Descriptor of the option.
+    const argpar_opt_descr_t& descr() const noexcept
+    {
+        return *_mDescr;
+    }
+
+    /// Invalid option argument (within the original arguments).
+    const char *arg() const noexcept
+    {
+        return _mArg;
+    }
+
+private:
+    const argpar_opt_descr_t *_mDescr;
+    const char *_mArg;
+};
+
+namespace internal {
+
+/*
+ * Fixed-length string usable as a template argument (`"jobs"`), of
+ * which `LenV` includes the terminating null character.
+ */
+template <std::size_t LenV>
+struct FixedStr final
+{
+    constexpr FixedStr(const char (&str)[LenV]) noexcept
+    {
+        std::copy_n(str, LenV, data);
+    }
+
+    /* Null-terminated string, or `nullptr` if empty */
+    constexpr const char *cStr() const noexcept
+    {
+        return LenV == 1 ? nullptr : data;
+    }
+
+    template <std::size_t OtherLenV>
+    constexpr bool operator==(const FixedStr<OtherLenV>& other) const noexcept
+    {
+        return std::string_view {data, LenV - 1} == std::string_view {other.data, OtherLenV - 1};
+    }
+
+    char data[LenV];
+};
+
+/*
+ * Converts the integer string `str` to the integral type `ValT`,
+ * returning `std::nullopt` if it's not a complete and valid
+ * representation of such a value.
+ *
+ * The grammar is the one of strtoll() and strtoull() with base 0, like
+ * for the #ARGPAR_BINDING_KIND_INT and #ARGPAR_BINDING_KIND_UINT
+ * bindings, without leading whitespaces: an optional `+` or `-` sign
+ * (`-` only for a signed type) followed with a hexadecimal (`0x` or
+ * `0X` prefix), octal (`0` prefix), or decimal number.
+ */
+template <typename ValT>
+std::optional<ValT> convertIntArg(const std::string_view str) noexcept
+{
+    auto first = str.data();
+    const auto last = str.data() + str.size();
+    bool isNeg = false;
+    int base = 10;
+    std::uintmax_t mag;
+
+    if (first != last && (*first == '+' || *first == '-')) {
+        isNeg = *first == '-';
+        ++first;
+    }
+
+    if (std::is_unsigned_v<ValT> && isNeg) {
+        return std::nullopt;
+    }
+
+    if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+        first += 2;
+        base = 16;
+    } else if (last - first > 1 && first[0] == '0') {
+        ++first;
+        base = 8;
+    }
+
+    /* std::from_chars() accepts a `-` sign itself */
+    if (first == last || *first == '-') {
+        return std::nullopt;
+    }
+
+    const auto res = std::from_chars(first, last, mag, base);
+
+    if (res.ec != std::errc {} || res.ptr != last) {
+        return std::nullopt;
+    }
+
+    constexpr auto max = static_cast<std::uintmax_t>(std::numeric_limits<ValT>::max());
+
+    if constexpr (std::is_signed_v<ValT>) {
+        if (isNeg) {
+            /* Magnitude of the minimum value: `max + 1` */
+            if (mag > max + 1) {
+                return std::nullopt;
+            }
+
+            return mag == 0 ? ValT {0} : static_cast<ValT>(-static_cast<ValT>(mag - 1) - 1);
+        }
+    }
+
+    if (mag > max) {
+        return std::nullopt;
+    }
+
+    return static_cast<ValT>(mag);
+}
+
+/*
+ * Converts the real number string `str` to the floating point type
+ * `ValT`, returning `std::nullopt` if it's not a complete and valid
+ * representation of such a value.
+ *
+ * The grammar is the one of strtod() and strtof(), like for the
+ * #ARGPAR_BINDING_KIND_REAL binding, without leading whitespaces: an
+ * optional `+` or `-` sign followed with a hexadecimal (`0x` or `0X`
+ * prefix) or decimal number, an infinity, or a NaN.
+ */
+template <typename ValT>
+std::optional<ValT> convertRealArg(const std::string_view str) noexcept
+{
+    auto first = str.data();
+    const auto last = str.data() + str.size();
+    bool isNeg = false;
+    auto fmt = std::chars_format::general;
+    ValT val;
+
+    if (first != last && (*first == '+' || *first == '-')) {
+        isNeg = *first == '-';
+        ++first;
+    }
+
+    if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+        first += 2;
+        fmt = std::chars_format::hex;
+    }
+
+    /* std::from_chars() accepts a `-` sign itself */
+    if (first == last || *first == '-') {
+        return std::nullopt;
+    }
+
+    const auto res = std::from_chars(first, last, val, fmt);
+
+    if (res.ec != std::errc {} || res.ptr != last) {
+        return std::nullopt;
+    }
+
+    return isNeg ? -val : val;
+}
+
+/*
+ * Converts the option argument `arg` to `ValT`, returning
+ * `std::nullopt` if it's not a complete and valid representation of
+ * such a value.
+ *
+ * See convertIntArg() and convertRealArg() for the grammars of
+ * numbers.
+ *
+ * Throws `std::bad_alloc` on memory error.
+ */
+template <typename ValT>
+std::optional<ValT> convertArg(const char * const arg)
+{
+    if constexpr (std::is_same_v<ValT, const char *> || std::is_same_v<ValT, std::string_view> ||
+                  std::is_same_v<ValT, std::string>) {
+        return ValT {arg};
+    } else {
+        static_assert(std::is_arithmetic_v<ValT> && !std::is_same_v<ValT, bool>,
+                      "Unsupported option value type");
+
+        const std::string_view str {arg};
+
+        if constexpr (std::is_integral_v<ValT>) {
+            return convertIntArg<ValT>(str);
+        } else {
+            return convertRealArg<ValT>(str);
+        }
+    }
+}
+
+} /* namespace internal */
+
+/*!
+@brief
+    Flag option (no argument) of which the value is \c true if it
+    occurs, for argpar::Opts.
+
+\p ShortNameV is the short name, or <code>'\0'</code> if none, and
+\p LongNameV is the long name, or <code>""</code> if none.
+*/
+template <char ShortNameV, internal::FixedStr LongNameV = "">
+struct Flag final
+{
+    using Val = bool;
+
+    static constexpr char shortName = ShortNameV;
+    static constexpr auto longName = LongNameV;
+    static constexpr bool withArg = false;
+
+    static void apply(Val& val, const argpar_item_t *) noexcept
+    {
+        val = true;
+    }
+};
+
+/*!
+@brief
+    Counter option (no argument) of which the value is its number of
+    occurrences (for example, 3 for <code>-vvv</code>), for
+    argpar::Opts.
+
+See argpar::Flag for \p ShortNameV and \p LongNameV.
+*/
+template <char ShortNameV, internal::FixedStr LongNameV = "">
+struct Counter final
+{
+    using Val = unsigned int;
+
+    static constexpr char shortName = ShortNameV;
+    static constexpr auto longName = LongNameV;
+    static constexpr bool withArg = false;
+
+    static void apply(Val& val, const argpar_item_t *) noexcept
+    {
+        ++val;
+    }
+};
+
+/*!
+@brief
+    Option with an argument which argpar::Opts converts to \p ValT (last
+    occurrence wins).
+
+\p ValT is an arithmetic type (except \c bool), <code>const char
+*</code>, <code>std::string_view</code> (both within the original
+arguments), or <code>std::string</code>.
+
+An integer argument has the grammar of <code>strtoll()</code> with
+base&nbsp;0, like for #ARGPAR_BINDING_KIND_INT, for example
+<code>42</code>, <code>+42</code>, <code>-0x2a</code>, or
+<code>052</code>, without leading whitespaces.
+
+A real number argument has the grammar of <code>strtod()</code>, like
+for #ARGPAR_BINDING_KIND_REAL, for example <code>2.5</code>,
+<code>+1.5</code>, <code>-1e3</code>, or <code>0x1p3</code>, without
+leading whitespaces.
+
+See argpar::Flag for \p ShortNameV and \p LongNameV.
+*/
+template <typename ValT, char ShortNameV, internal::FixedStr LongNameV = "">
+struct Value final
+{
+    using Val = std::optional<ValT>;
+
+    static constexpr char shortName = ShortNameV;
+    static constexpr auto longName = LongNameV;
+    static constexpr bool withArg = true;
+
+    static void apply(Val& val, const argpar_item_t * const item)
+    {
+        const auto arg = argpar_item_opt_arg(item);
+
+        val = internal::convertArg<ValT>(arg);
+
+        if (!val) {
+            throw InvalidOptArgError {*argpar_item_opt_descr(item), arg};
+        }
+    }
+};
+
+/*!
+@brief
+    Compile-time list of typed options (argpar::Flag, argpar::Counter,
+    and argpar::Value).
+
+The numeric ID of each generated option descriptor is the index of its
+option within \p OptTs: once the iterator resolves an option name,
+argpar::Opts::parse() calls the handler of its option through a
+constant table instead of a runtime <code>switch</code>, and
+argpar::Opts::Result::get() finds the value of an option at compile
+time.
+*/
+template <typename... OptTs>
+class Opts final
+{
+    static_assert(sizeof...(OptTs) > 0, "Empty option list");
+
+    template <std::size_t... IndexVs>
+    static constexpr std::array<argpar_opt_descr_t, sizeof...(OptTs) + 1>
+    _makeDescrs(std::index_sequence<IndexVs...>) noexcept
+    {
+        return {{
+            ARGPAR_OPT_DESCR(static_cast<int>(IndexVs), OptTs::shortName, OptTs::longName.cStr(),
+                             OptTs::withArg)...,
+            ARGPAR_OPT_DESCR_SENTINEL,
+        }};
+    }
+
+public:
+    /*!
+    @brief
+        Result of argpar::Opts::parse(): value of each option and
+        non-option arguments.
+    */
+    class Result final
+    {
+        friend class Opts;
+
+    public:
+        /*!
+        @brief
+            Value of the option having the long name \p NameV:
+
+            <dl>
+              <dt>argpar::Flag</dt>
+              <dd>\c bool</dd>
+
+              <dt>argpar::Counter</dt>
+              <dd><code>unsigned int</code></dd>
+
+              <dt>argpar::Value</dt>
+              <dd><code>std::optional</code> of its value type, empty if
+              the option doesn't occur</dd>
+            </dl>
+        */
+        template <internal::FixedStr NameV>
+        const auto& get() const noexcept
+        {
+            return std::get<Opts::_longNameIndex(NameV)>(_mVals);
+        }
+
+        /// Value of the option having the short name \p ShortNameV.
+        template <char ShortNameV>
+        const auto& get() const noexcept
+        {
+            return std::get<Opts::_shortNameIndex(ShortNameV)>(_mVals);
+        }
+
+        /// Non-option arguments, in order.
+        const std::vector<const char *>& nonOpts() const noexcept
+        {
+            return _mNonOpts;
+        }
+
+    private:
+        Result() = default;
+
+        std::tuple<typename OptTs::Val...> _mVals {};
+        std::vector<const char *> _mNonOpts;
+    };
+
+    /*!
+    @brief
+        Option descriptors (numeric ID is the index of the option within
+        \p OptTs), terminated with #ARGPAR_OPT_DESCR_SENTINEL.
+    */
+    static constexpr std::array<argpar_opt_descr_t, sizeof...(OptTs) + 1> descrs =
+        _makeDescrs(std::index_sequence_for<OptTs...> {});
+
+    /*!
+    @brief
+        Parses the original arguments \p argv.
+
+    @throws argpar::ParseError
+        Parsing error.
+    @throws argpar::InvalidOptArgError
+        Invalid option argument for its declared type.
+    @throws std::bad_alloc
+        Memory error.
+    */
+    static Result parse(const std::span<const char * const> argv)
+    {
+        const auto iter = internal::createIter(argv, descrs.data(), nullptr);
+        Result result;
+
+        while (true) {
+            const argpar_item_t *item = nullptr;
+            const argpar_error_t *error = nullptr;
+
+            switch (argpar_iter_borrow_next(iter.get(), &item, &error)) {
+            case ARGPAR_ITER_NEXT_STATUS_OK:
+                if (argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT) {
+                    _handlers[argpar_item_opt_descr(item)->id](result, item);
+                } else {
+                    result._mNonOpts.push_back(argpar_item_non_opt_arg(item));
+                }
+
+                break;
+            case ARGPAR_ITER_NEXT_STATUS_ERROR:
+                throw ParseError {Error {error}};
+            case ARGPAR_ITER_NEXT_STATUS_ERROR_MEMORY:
+                throw std::bad_alloc {};
+            default:
+                return result;
+            }
+        }
+    }
+
+private:
+    using _Handler = void (*)(Result&, const argpar_item_t *);
+
+    /* Handler of the option at the index `IndexV` */
+    template <std::size_t IndexV>
+    static void _handle(Result& result, const argpar_item_t * const item)
+    {
+        std::tuple_element_t<IndexV, std::tuple<OptTs...>>::apply(std::get<IndexV>(result._mVals),
+                                                                  item);
+    }
+
+    template <std::size_t... IndexVs>
+    static constexpr std::array<_Handler, sizeof...(OptTs)>
+    _makeHandlers(std::index_sequence<IndexVs...>) noexcept
+    {
+        return {_handle<IndexVs>...};
+    }
+
+    /* Index of the option having the long name `name` */
+    template <std::size_t LenV>
+    static consteval std::size_t _longNameIndex(const internal::FixedStr<LenV> name)
+    {
+        std::size_t index = 0;
+
+        for (const bool found : {(OptTs::longName == name)...}) {
+            if (found) {
+                return index;
+            }
+
+            ++index;
+        }
+
+        throw "Unknown long option name";
+    }
+
+    /* Index of the option having the short name `shortName` */
+    static consteval std::size_t _shortNameIndex(const char shortName)
+    {
+        std::size_t index = 0;
+
+        for (const char optShortName : {OptTs::shortName...}) {
+            if (shortName != '\0' && optShortName == shortName) {
+                return index;
+            }
+
+            ++index;
+        }
+
+        throw "Unknown short option name";
+    }
+
+    static constexpr std::array<_Handler, sizeof...(OptTs)> _handlers =
+        _makeHandlers(std::index_sequence_for<OptTs...> {});
+};
+
+} /* namespace argpar */
+
+#endif /* ARGPAR_ARGPAR_HPP */
@@ -0,0 +1,822 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+/*
+ * Comparative benchmark of argpar, getopt_long(), and argp_parse().
+ *
+ * Each workload generates option descriptors and an original argument
+ * array, and then parses the same arguments with each available
+ * parser, writing one JSON object per line (workload and parser) to
+ * the standard output:
+ *
+ *     {"workload":"mixed-64","parser":"argpar","descr_count":64,...}
+ *
+ * For each run, the benchmark reports:
+ *
+ * • Throughput: nanoseconds per run and original arguments per second.
+ *
+ * • Allocations: number of allocations and allocated bytes per run,
+ *   when the benchmark can interpose malloc() (glibc).
+ *
+ * • Instructions retired per run, when perf_event_open() is available,
+ *   or `null`.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef HAVE_GETOPT_H
+#    include <getopt.h>
+#endif
+
+#ifdef HAVE_ARGP_H
+#    include <argp.h>
+#endif
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include "argpar/argpar.h"
+
+/* Workload parameters */
+struct workload
+{
+    /* Name */
+    const char *name;
+
+    /* Number of option descriptors */
+    unsigned int descr_count;
+
+    /* Number of original arguments (excluding the program name) */
+    unsigned int argc;
+
+    /*
+     * Percentage of original arguments which are short option groups
+     * (`-abc`) rather than single options.
+     */
+    unsigned int short_group_pct;
+
+    /*
+     * Percentage of long options with an argument of which the form
+     * is `--name=arg` rather than `--name arg`.
+     */
+    unsigned int long_eq_pct;
+};
+
+static const struct workload workloads[] = {
+    {"small", 8, 16, 0, 50},
+    {"short-groups", 16, 64, 80, 0},
+    {"long-eq", 16, 64, 0, 100},
+    {"long-space", 16, 64, 0, 0},
+    {"mixed-64", 64, 256, 30, 50},
+    {"many-descrs", 256, 256, 20, 50},
+    {"long-argv", 32, 4096, 30, 50},
+};
+
+/*
+ * Generated data of a workload, shared by all the parsers.
+ *
+ * Option descriptor `i` has:
+ *
+ * • The short name `short_names[i]`, or none if `i` is at least the
+ *   length of `short_names`.
+ *
+ * • The long name `opt-i`.
+ *
+ * • An argument if `i % 4 == 3`.
+ */
+struct workload_data
+{
+    argpar_opt_descr_t *descrs;
+    char **long_names;
+
+    /* Generated original arguments, including a program name */
+    char **argv;
+    unsigned int argc;
+};
+
+static const char short_names[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+#define SHORT_NAME_COUNT (sizeof(short_names) - 1)
+
+/* Allocation counting, when enabled with `alloc_stats.enabled` */
+static struct
+{
+    bool enabled;
+    unsigned long long count;
+    unsigned long long bytes;
+} alloc_stats;
+
+#ifdef __GLIBC__
+/*
+ * Interpose the allocation functions of the C library to count
+ * allocations, forwarding to the glibc implementations.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static void count_alloc(const size_t size)
+{
+    if (alloc_stats.enabled) {
+        alloc_stats.count++;
+        alloc_stats.bytes += size;
+    }
+}
+
+void *malloc(const size_t size)
+{
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(const size_t nmemb, const size_t size)
+{
+    count_alloc(nmemb * size);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void * const ptr, const size_t size)
+{
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void * const ptr)
+{
+    __libc_free(ptr);
+}
+
+#    define ALLOC_STATS_AVAILABLE 1
+#else
+#    define ALLOC_STATS_AVAILABLE 0
+#endif
+
+/* Instruction counter file descriptor, or -1 if not available */
+static int insn_fd = -1;
+
+/*
+ * Opens the instruction counter of the current thread, if possible.
+ */
+static void open_insn_counter(void)
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    insn_fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+/*
+ * Resets and enables the instruction counter, if available.
+ */
+static void start_insn_counter(void)
+{
+#ifdef HAVE_LINUX_PERF_EVENT_H
+    if (insn_fd >= 0) {
+        ioctl(insn_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(insn_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/*
+ * Disables the instruction counter and returns its value, or -1 if
+ * not available.
+ */
+static long long stop_insn_counter(void)
+{
+    long long count = -1;
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+    if (insn_fd >= 0) {
+        uint64_t value;
+
+        ioctl(insn_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        if (read(insn_fd, &value, sizeof(value)) == (ssize_t) sizeof(value)) {
+            count = (long long) value;
+        }
+    }
+#endif
+
+    return count;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/* Returns the next value of the xorshift PRNG `*state` */
+static uint32_t next_rand(uint32_t * const state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static bool descr_has_arg(const unsigned int i)
+{
+    return i % 4 == 3;
+}
+
+static char *xstrdup(const char * const str)
+{
+    const size_t size = strlen(str) + 1;
+    char * const copy = malloc(size);
+
+    if (!copy) {
+        abort();
+    }
+
+    memcpy(copy, str, size);
+    return copy;
+}
+
+/*
+ * Returns the index of a random option descriptor of `workload` having a
+ * short name and no argument.
+ */
+static unsigned int rand_short_flag(const struct workload * const workload,
+                                    uint32_t * const rand_state)
+{
+    const unsigned int count =
+        workload->descr_count < SHORT_NAME_COUNT ? workload->descr_count : SHORT_NAME_COUNT;
+    unsigned int i;
+
+    do {
+        i = next_rand(rand_state) % count;
+    } while (descr_has_arg(i));
+
+    return i;
+}
+
+/*
+ * Generates the option descriptors and original arguments of
+ * `workload` into `data`.
+ */
+static void gen_workload_data(const struct workload * const workload,
+                              struct workload_data * const data)
+{
+    uint32_t rand_state = 0x9e3779b9U ^ workload->descr_count ^ (workload->argc << 8);
+    unsigned int i;
+
+    data->descrs = calloc(workload->descr_count + 1, sizeof(*data->descrs));
+    data->long_names = calloc(workload->descr_count, sizeof(*data->long_names));
+    /* Program name, up to one extra option argument, and `NULL` */
+    data->argv = calloc(workload->argc + 3, sizeof(*data->argv));
+
+    if (!data->descrs || !data->long_names || !data->argv) {
+        abort();
+    }
+
+    for (i = 0; i < workload->descr_count; i++) {
+        char buf[32];
+
+        snprintf(buf, sizeof(buf), "opt-%u", i);
+        data->long_names[i] = xstrdup(buf);
+
+        {
+            /* Option descriptor members are `const`: copy the whole */
+            const argpar_opt_descr_t descr =
+                ARGPAR_OPT_DESCR((int) i, i < SHORT_NAME_COUNT ? short_names[i] : '\0',
+                                 data->long_names[i], descr_has_arg(i));
+
+            memcpy(&data->descrs[i], &descr, sizeof(descr));
+        }
+    }
+
+    data->argv[0] = xstrdup("bench");
+    data->argc = 1;
+
+    while (data->argc - 1 < workload->argc) {
+        const unsigned int descr_i = next_rand(&rand_state) % workload->descr_count;
+        const unsigned int kind = next_rand(&rand_state) % 100;
+        char buf[64];
+
+        if (kind < 10) {
+            /* Non-option argument */
+            snprintf(buf, sizeof(buf), "file-%u", data->argc);
+        } else if (kind < 10 + workload->short_group_pct * 90 / 100 &&
+                   workload->descr_count >= 4) {
+            /* Short option group of 2 to 5 options without argument */
+            const unsigned int len = 2 + next_rand(&rand_state) % 4;
+            unsigned int j;
+
+            buf[0] = '-';
+
+            for (j = 0; j < len; j++) {
+                buf[j + 1] = short_names[rand_short_flag(workload, &rand_state)];
+            }
+
+            buf[len + 1] = '\0';
+        } else if (descr_i < SHORT_NAME_COUNT && next_rand(&rand_state) % 2 == 0) {
+            /* Single short option */
+            snprintf(buf, sizeof(buf), "-%c", short_names[descr_i]);
+
+            if (descr_has_arg(descr_i)) {
+                data->argv[data->argc] = xstrdup(buf);
+                data->argc++;
+                snprintf(buf, sizeof(buf), "value-%u", data->argc);
+            }
+        } else if (descr_has_arg(descr_i)) {
+            /* Long option with an argument */
+            if (next_rand(&rand_state) % 100 < workload->long_eq_pct) {
+                snprintf(buf, sizeof(buf), "--%s=value-%u", data->long_names[descr_i],
+                         data->argc);
+            } else {
+                snprintf(buf, sizeof(buf), "--%s", data->long_names[descr_i]);
+                data->argv[data->argc] = xstrdup(buf);
+                data->argc++;
+                snprintf(buf, sizeof(buf), "value-%u", data->argc);
+            }
+        } else {
+            /* Long option without an argument */
+            snprintf(buf, sizeof(buf), "--%s", data->long_names[descr_i]);
+        }
+
+        data->argv[data->argc] = xstrdup(buf);
+        data->argc++;
+    }
+}
+
+static void fini_workload_data(const struct workload * const workload,
+                               struct workload_data * const data)
+{
+    unsigned int i;
+
+    for (i = 0; i < workload->descr_count; i++) {
+        free(data->long_names[i]);
+    }
+
+    for (i = 0; i < data->argc; i++) {
+        free(data->argv[i]);
+    }
+
+    free(data->long_names);
+    free(data->descrs);
+    free(data->argv);
+}
+
+/*
+ * Parser under test.
+ *
+ * `prepare` creates the per-parser state once, `run` parses the
+ * original arguments once, returning the number of parsed items (to
+ * check that all the parsers agree), and `destroy` releases the state.
+ */
+struct parser
+{
+    const char *name;
+    void *(*prepare)(const struct workload_data *data, unsigned int descr_count);
+    unsigned int (*run)(void *state, const struct workload_data *data);
+    void (*destroy)(void *state);
+};
+
+/*
+ * Lookup strategy of the argpar runs (see
+ * argpar_iter_set_lookup_strategy()).
+ */
+static argpar_lookup_strategy_t argpar_lookup_strategy = ARGPAR_LOOKUP_STRATEGY_AUTO;
+
+static void *argpar_prepare(const struct workload_data * const data,
+                            const unsigned int descr_count)
+{
+    (void) descr_count;
+    return data->descrs;
+}
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+/*
+ * Latency histogram of the argpar_iter_next() calls of all the argpar
+ * runs of the current workload.
+ */
+static argpar_histogram_t argpar_histogram;
+
+/* Adds the latency histogram `histogram` to `argpar_histogram` */
+static void merge_argpar_histogram(const argpar_histogram_t * const histogram)
+{
+    unsigned int path, i;
+
+    argpar_histogram.unit = histogram->unit;
+
+    for (path = 0; path < ARGPAR_HISTOGRAM_PATH_COUNT; path++) {
+        argpar_histogram_path_stats_t * const dst = &argpar_histogram.paths[path];
+        const argpar_histogram_path_stats_t * const src = &histogram->paths[path];
+
+        dst->call_count += src->call_count;
+        dst->total += src->total;
+
+        if (src->max > dst->max) {
+            dst->max = src->max;
+        }
+
+        for (i = 0; i < ARGPAR_HISTOGRAM_BUCKET_COUNT; i++) {
+            dst->buckets[i] += src->buckets[i];
+        }
+    }
+}
+#endif
+
+static unsigned int argpar_run(void * const state, const struct workload_data * const data)
+{
+    argpar_iter_t * const iter = argpar_iter_create(
+        data->argc - 1, (const char * const *) &data->argv[1], (const argpar_opt_descr_t *) state);
+    const argpar_item_t *item = NULL;
+    unsigned int count = 0;
+
+    if (!iter) {
+        abort();
+    }
+
+    if (argpar_lookup_strategy != ARGPAR_LOOKUP_STRATEGY_AUTO &&
+        argpar_iter_set_lookup_strategy(iter, argpar_lookup_strategy) !=
+            ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK) {
+        abort();
+    }
+
+    while (argpar_iter_next(iter, &item, NULL) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        count++;
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    merge_argpar_histogram(argpar_iter_get_histogram(iter));
+#endif
+
+    argpar_iter_destroy(iter);
+    return count;
+}
+
+static void argpar_destroy(void * const state)
+{
+    (void) state;
+}
+
+#if defined(HAVE_GETOPT_H) || defined(HAVE_ARGP_H)
+/*
+ * Copy of the original argument array, as getopt_long() and
+ * argp_parse() may permute it.
+ */
+static char **argv_copy;
+
+static char **copy_argv(const struct workload_data * const data)
+{
+    memcpy(argv_copy, data->argv, (data->argc + 1) * sizeof(*argv_copy));
+    return argv_copy;
+}
+#endif
+
+#ifdef HAVE_GETOPT_H
+/* getopt_long() state: short option string and long options */
+struct getopt_state
+{
+    char *short_opts;
+    struct option *long_opts;
+};
+
+static void *getopt_prepare(const struct workload_data * const data,
+                            const unsigned int descr_count)
+{
+    struct getopt_state * const state = calloc(1, sizeof(*state));
+    unsigned int short_len = 0;
+    unsigned int i;
+
+    if (!state) {
+        abort();
+    }
+
+    state->short_opts = calloc(descr_count * 2 + 2, 1);
+    state->long_opts = calloc(descr_count + 1, sizeof(*state->long_opts));
+
+    if (!state->short_opts || !state->long_opts) {
+        abort();
+    }
+
+    /* Return non-option arguments in order like argpar */
+    state->short_opts[short_len] = '-';
+    short_len++;
+
+    for (i = 0; i < descr_count; i++) {
+        const argpar_opt_descr_t * const descr = &data->descrs[i];
+
+        if (descr->short_name) {
+            state->short_opts[short_len] = descr->short_name;
+            short_len++;
+
+            if (descr->with_arg) {
+                state->short_opts[short_len] = ':';
+                short_len++;
+            }
+        }
+
+        state->long_opts[i].name = descr->long_name;
+        state->long_opts[i].has_arg = descr->with_arg ? required_argument : no_argument;
+        state->long_opts[i].val = 256 + (int) i;
+    }
+
+    return state;
+}
+
+static unsigned int getopt_run(void * const state, const struct workload_data * const data)
+{
+    const struct getopt_state * const gstate = state;
+    char ** const argv = copy_argv(data);
+    unsigned int count = 0;
+
+    optind = 0;
+    opterr = 0;
+
+    while (getopt_long((int) data->argc, argv, gstate->short_opts, gstate->long_opts, NULL) != -1) {
+        count++;
+    }
+
+    return count;
+}
+
+static void getopt_destroy(void * const state)
+{
+    struct getopt_state * const gstate = state;
+
+    free(gstate->short_opts);
+    free(gstate->long_opts);
+    free(gstate);
+}
+#endif
+
+#ifdef HAVE_ARGP_H
+/* argp_parse() state */
+struct argp_state_data
+{
+    struct argp argp;
+    struct argp_option *options;
+    unsigned int descr_count;
+    unsigned int count;
+};
+
+static error_t argp_parser(const int key, char * const arg, struct argp_state * const state)
+{
+    struct argp_state_data * const sdata = state->input;
+
+    (void) arg;
+
+    /* Skip the special keys (`ARGP_KEY_INIT`, `ARGP_KEY_END`, and so on) */
+    if (key == ARGP_KEY_ARG || (key > 0 && key < 256 + (int) sdata->descr_count)) {
+        sdata->count++;
+        return 0;
+    }
+
+    return ARGP_ERR_UNKNOWN;
+}
+
+static void *argp_prepare(const struct workload_data * const data, const unsigned int descr_count)
+{
+    struct argp_state_data * const state = calloc(1, sizeof(*state));
+    unsigned int i;
+
+    if (!state) {
+        abort();
+    }
+
+    state->options = calloc(descr_count + 1, sizeof(*state->options));
+
+    if (!state->options) {
+        abort();
+    }
+
+    for (i = 0; i < descr_count; i++) {
+        const argpar_opt_descr_t * const descr = &data->descrs[i];
+
+        state->options[i].name = descr->long_name;
+        state->options[i].key = descr->short_name ? descr->short_name : 256 + (int) i;
+        state->options[i].arg = descr->with_arg ? "ARG" : NULL;
+    }
+
+    state->descr_count = descr_count;
+    state->argp.options = state->options;
+    state->argp.parser = argp_parser;
+    return state;
+}
+
+static unsigned int argp_run(void * const state, const struct workload_data * const data)
+{
+    struct argp_state_data * const sdata = state;
+    char ** const argv = copy_argv(data);
+
+    sdata->count = 0;
+
+    if (argp_parse(&sdata->argp, (int) data->argc, argv,
+                   ARGP_IN_ORDER | ARGP_NO_ERRS | ARGP_NO_HELP | ARGP_NO_EXIT, NULL, sdata)) {
+        abort();
+    }
+
+    return sdata->count;
+}
+
+static void argp_destroy(void * const state)
+{
+    struct argp_state_data * const sdata = state;
+
+    free(sdata->options);
+    free(sdata);
+}
+#endif
+
+static const struct parser parsers[] = {
+    {"argpar", argpar_prepare, argpar_run, argpar_destroy},
+#ifdef HAVE_GETOPT_H
+    {"getopt_long", getopt_prepare, getopt_run, getopt_destroy},
+#endif
+#ifdef HAVE_ARGP_H
+    {"argp", argp_prepare, argp_run, argp_destroy},
+#endif
+};
+
+/*
+ * Runs `parser` `iterations` times with the workload `workload` of
+ * which the data is `data`, and prints the results.
+ */
+static void bench_parser(const struct parser * const parser,
+                         const struct workload * const workload,
+                         const struct workload_data * const data, const unsigned int iterations)
+{
+    void * const state = parser->prepare(data, workload->descr_count);
+    unsigned int items;
+    unsigned long long allocs, alloc_bytes;
+    long long insns;
+    uint64_t begin_ns, elapsed_ns;
+    unsigned int i;
+
+    /* Warm up, and count the allocations and instructions of one run */
+    alloc_stats.count = 0;
+    alloc_stats.bytes = 0;
+    alloc_stats.enabled = true;
+    start_insn_counter();
+    items = parser->run(state, data);
+    insns = stop_insn_counter();
+    alloc_stats.enabled = false;
+    allocs = alloc_stats.count;
+    alloc_bytes = alloc_stats.bytes;
+
+    begin_ns = now_ns();
+
+    for (i = 0; i < iterations; i++) {
+        parser->run(state, data);
+    }
+
+    elapsed_ns = now_ns() - begin_ns;
+    printf("{\"workload\":\"%s\",\"parser\":\"%s\",\"descr_count\":%u,\"argc\":%u,"
+           "\"short_group_pct\":%u,\"long_eq_pct\":%u,\"iterations\":%u,\"items\":%u,"
+           "\"ns_per_run\":%.1f,\"args_per_sec\":%.0f,",
+           workload->name, parser->name, workload->descr_count, data->argc - 1,
+           workload->short_group_pct, workload->long_eq_pct, iterations, items,
+           (double) elapsed_ns / iterations,
+           elapsed_ns > 0 ? (double) (data->argc - 1) * iterations * 1e9 / (double) elapsed_ns :
+                            0.);
+
+    if (ALLOC_STATS_AVAILABLE) {
+        printf("\"allocs_per_run\":%llu,\"alloc_bytes_per_run\":%llu,", allocs, alloc_bytes);
+    } else {
+        printf("\"allocs_per_run\":null,\"alloc_bytes_per_run\":null,");
+    }
+
+    if (insns >= 0) {
+        printf("\"instructions_per_run\":%lld}\n", insns);
+    } else {
+        printf("\"instructions_per_run\":null}\n");
+    }
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    /* Latency histogram of the argpar runs to the standard error */
+    if (parser->run == argpar_run) {
+        fprintf(stderr, "%s: argpar_iter_next() latency\n", workload->name);
+        argpar_histogram_print(&argpar_histogram, stderr);
+        memset(&argpar_histogram, 0, sizeof(argpar_histogram));
+    }
+#endif
+
+    parser->destroy(state);
+}
+
+/* Names of the lookup strategies, indexed by `argpar_lookup_strategy_t` */
+static const char * const lookup_strategy_names[] = {
+    "auto",
+    "scan",
+    "fingerprint",
+    "hash",
+    NULL,
+};
+
+int main(const int argc, const char * const * const argv)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'n', "iterations", true),
+        ARGPAR_OPT_DESCR(1, 'w', "workload", true),
+        {.id = 2, .short_name = 's', .long_name = "lookup-strategy", .with_arg = true,
+         .choices = lookup_strategy_names},
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    unsigned int iterations = 2000;
+    const char *workload_name = NULL;
+    argpar_iter_t *iter = argpar_iter_create((unsigned int) argc - 1, &argv[1], descrs);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_iter_next_status_t status;
+    int ret = EXIT_SUCCESS;
+    unsigned int i, j;
+
+    if (!iter) {
+        abort();
+    }
+
+    while ((status = argpar_iter_next(iter, &item, &error)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        if (argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT) {
+            const char * const arg = argpar_item_opt_arg(item);
+
+            switch (argpar_item_opt_descr(item)->id) {
+            case 0:
+                iterations = (unsigned int) strtoul(arg, NULL, 10);
+                break;
+            case 1:
+                workload_name = arg;
+                break;
+            default:
+                argpar_lookup_strategy = (argpar_lookup_strategy_t) argpar_item_opt_choice(item);
+                break;
+            }
+        }
+
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    if (status != ARGPAR_ITER_NEXT_STATUS_END || iterations == 0) {
+        fprintf(stderr,
+                "Usage: %s [--iterations=N] [--workload=NAME] "
+                "[--lookup-strategy=auto|scan|fingerprint|hash]\n",
+                argv[0]);
+        ret = EXIT_FAILURE;
+        goto end;
+    }
+
+    open_insn_counter();
+
+    for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        const struct workload * const workload = &workloads[i];
+        struct workload_data data;
+
+        if (workload_name && strcmp(workload_name, workload->name) != 0) {
+            continue;
+        }
+
+        gen_workload_data(workload, &data);
+
+#if defined(HAVE_GETOPT_H) || defined(HAVE_ARGP_H)
+        argv_copy = calloc(data.argc + 1, sizeof(*argv_copy));
+        if (!argv_copy) {
+            abort();
+        }
+#endif
+
+        for (j = 0; j < sizeof(parsers) / sizeof(parsers[0]); j++) {
+            bench_parser(&parsers[j], workload, &data, iterations);
+        }
+
+#if defined(HAVE_GETOPT_H) || defined(HAVE_ARGP_H)
+        free(argv_copy);
+        argv_copy = NULL;
+#endif
+
+        fini_workload_data(workload, &data);
+    }
+
+end:
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+    return ret;
+}
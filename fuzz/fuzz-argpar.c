@@ -0,0 +1,859 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+/*
+ * Fuzzing harness of the argpar parser, with a performance oracle.
+ *
+ * LLVMFuzzerTestOneInput() decodes an input into option descriptors,
+ * a parsing mode, and original arguments (see decode_input()), parses
+ * them with an iterator (with an explicit lookup strategy and a lookup
+ * cache, if any), an incremental reparser, argpar_parse(), or an
+ * iterator created from a corrupted descriptor image, and
+ * aborts if the parser crashed (sanitizers) or if the number of
+ * allocations or the parsing time exceeds a bound proportional to the
+ * input size (see check_oracle()).
+ *
+ * Build modes:
+ *
+ * libFuzzer:
+ *     Define `ARGPAR_FUZZ_LIBFUZZER` and build with
+ *     `-fsanitize=fuzzer,address`: the harness counts allocations with
+ *     the sanitizer allocator hooks.
+ *
+ * Standalone (default, also for AFL):
+ *     This file provides main(), which runs each input file or each
+ *     file of each input directory once, and then, with
+ *     `--time=SECONDS`, mutates the inputs randomly for this duration
+ *     (`make fuzz-smoke`). Run `fuzz-argpar FILE` under AFL. The
+ *     harness counts allocations by interposing malloc() (glibc).
+ *
+ * The `ARGPAR_FUZZ_MAX_NS_PER_BYTE` environment variable overrides the
+ * default time bound per input byte, for example for slow
+ * instrumented builds.
+ */
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "argpar/argpar.h"
+
+/* Maximum number of decoded option descriptors of an input */
+#define MAX_DECODED_DESCRS 31
+
+/* Maximum number of generated option descriptors of an input */
+#define MAX_GEN_DESCRS (7 * 32)
+
+/* Maximum number of option descriptors of an input */
+#define MAX_DESCRS (MAX_DECODED_DESCRS + MAX_GEN_DESCRS)
+
+/* User key of the descriptor image of an input */
+#define IMAGE_KEY 0xf022ULL
+
+/*
+ * Size of the header of a descriptor image and offset of its checksum
+ * within it (see `struct image_header` in `argpar/argpar.c`)
+ */
+#define IMAGE_HEADER_SIZE 56
+#define IMAGE_CHECKSUM_OFFSET 24
+
+/* Decoded input */
+struct input
+{
+    /* Option descriptors, including the sentinel */
+    argpar_opt_descr_t descrs[MAX_DESCRS + 1];
+
+    /* Long names of the generated option descriptors */
+    char gen_long_names[MAX_GEN_DESCRS][16];
+
+    /* Original arguments, pointing within `buf` */
+    const char **argv;
+    unsigned int argc;
+
+    /* Copy of the input, `\0`-terminated */
+    char *buf;
+
+    /*
+     * Corrupted descriptor image of `descrs` (8-byte aligned) and its
+     * size, in image mode, or `NULL`
+     */
+    char *image;
+    size_t image_size;
+
+    /* Parsing mode (`INPUT_MODE_*` flags) */
+    unsigned int mode;
+};
+
+/*
+ * Mask of the lookup strategy (`argpar_lookup_strategy_t`) to set
+ * explicitly, unless it's `ARGPAR_LOOKUP_STRATEGY_AUTO`
+ */
+#define INPUT_MODE_LOOKUP_STRATEGY_MASK 0x3U
+
+/* Enable the lookup cache of the iterator */
+#define INPUT_MODE_LOOKUP_CACHE (1U << 2)
+
+/* Parse with an incremental reparser instead of an iterator */
+#define INPUT_MODE_REPARSE (1U << 3)
+
+/*
+ * Parse with an iterator created from a corrupted descriptor image
+ * instead of the descriptors themselves
+ */
+#define INPUT_MODE_IMAGE (1U << 4)
+
+/* Parse with argpar_parse() and a permutation instead of an iterator */
+#define INPUT_MODE_BATCH (1U << 5)
+
+/* Stop at the first non-option argument */
+#define INPUT_MODE_STOP_AT_NON_OPT (1U << 6)
+
+/* Use a flag sink */
+#define INPUT_MODE_FLAG_SINK (1U << 7)
+
+/* Allocation counter, updated when `alloc_count_enabled` is true */
+static bool alloc_count_enabled;
+static unsigned long long alloc_count;
+
+static void count_alloc(void)
+{
+    if (alloc_count_enabled) {
+        alloc_count++;
+    }
+}
+
+#ifdef ARGPAR_FUZZ_LIBFUZZER
+int __sanitizer_install_malloc_and_free_hooks(void (*malloc_hook)(const volatile void *, size_t),
+                                              void (*free_hook)(const volatile void *));
+
+static void malloc_hook(const volatile void * const ptr, const size_t size)
+{
+    (void) ptr;
+    (void) size;
+    count_alloc();
+}
+
+static void free_hook(const volatile void * const ptr)
+{
+    (void) ptr;
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv);
+
+int LLVMFuzzerInitialize(int * const argc, char *** const argv)
+{
+    (void) argc;
+    (void) argv;
+    __sanitizer_install_malloc_and_free_hooks(malloc_hook, free_hook);
+    return 0;
+}
+#elif defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(const size_t size)
+{
+    count_alloc();
+    return __libc_malloc(size);
+}
+
+void *calloc(const size_t nmemb, const size_t size)
+{
+    count_alloc();
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void * const ptr, const size_t size)
+{
+    count_alloc();
+    return __libc_realloc(ptr, size);
+}
+#endif
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/*
+ * Returns the checksum of the `size` bytes (multiple of 8) of `data`,
+ * like image_checksum() of `argpar/argpar.c`.
+ */
+static unsigned long long image_checksum(const char * const data, const size_t size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    size_t i;
+
+    for (i = 0; i < size; i += 8) {
+        unsigned long long word;
+
+        memcpy(&word, &data[i], sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * Writes the descriptor image of the decoded input `input`, applies
+ * the patches of its first original argument, and then removes this
+ * argument.
+ *
+ * Each patch is three bytes: the little-endian 16-bit offset (modulo
+ * the image size) of the byte to patch, and the value with which to
+ * XOR it. This function then updates the checksum of the image so that
+ * argpar_descr_image_open() validates the patched tables instead of
+ * rejecting a checksum mismatch.
+ */
+static void make_image(struct input * const input)
+{
+    const char *patches = "";
+    size_t patches_len, i;
+    unsigned long long checksum;
+
+    input->image_size = argpar_descr_image_write(input->descrs, IMAGE_KEY, NULL, 0);
+
+    if (input->image_size < IMAGE_HEADER_SIZE) {
+        abort();
+    }
+
+    /* malloc() returns memory aligned on at least 8 bytes */
+    input->image = malloc(input->image_size);
+
+    if (!input->image ||
+        argpar_descr_image_write(input->descrs, IMAGE_KEY, input->image, input->image_size) !=
+            input->image_size) {
+        abort();
+    }
+
+    if (input->argc > 0) {
+        patches = input->argv[0];
+        input->argc--;
+        memmove((void *) input->argv, &input->argv[1], input->argc * sizeof(*input->argv));
+    }
+
+    patches_len = strlen(patches);
+
+    for (i = 0; i + 3 <= patches_len; i += 3) {
+        const size_t offset = ((size_t) (unsigned char) patches[i] |
+                               ((size_t) (unsigned char) patches[i + 1] << 8)) %
+                              input->image_size;
+
+        input->image[offset] ^= patches[i + 2];
+    }
+
+    checksum = image_checksum(&input->image[IMAGE_HEADER_SIZE],
+                              input->image_size - IMAGE_HEADER_SIZE);
+    memcpy(&input->image[IMAGE_CHECKSUM_OFFSET], &checksum, sizeof(checksum));
+}
+
+/*
+ * Decodes `data` (`size` bytes) into `input`, returning `false` if
+ * it's too short.
+ *
+ * Format:
+ *
+ * • One mode byte: `INPUT_MODE_*` flags.
+ *
+ * • One descriptor count byte: the five lowest bits are the number of
+ *   decoded descriptors (at most `MAX_DECODED_DESCRS`) and the three
+ *   highest bits are the number of generated descriptors divided by
+ *   32.
+ *
+ * • For each decoded descriptor: one byte of which bit 0 means "with
+ *   an argument", bit 1 "negatable", bit 2 "has a short name", bit 3
+ *   "has a long name", and bit 4 "scope opener", followed with the
+ *   short name byte, if any, and then with the `\0`-terminated long
+ *   name, if any.
+ *
+ *   The generated descriptors follow the decoded ones: the long name
+ *   of the generated descriptor `i` is `gen-i`, and it has an argument
+ *   if `i` is odd. They make the iterator reach the descriptor count
+ *   thresholds of `ARGPAR_LOOKUP_STRATEGY_AUTO` with a short input.
+ *
+ * • The original arguments, each one terminated with `\0` (the last
+ *   one may be unterminated).
+ *
+ *   In image mode, the first original argument isn't one: it's a
+ *   sequence of three-byte patches of the descriptor image (see
+ *   make_image()).
+ *
+ * This function fixes the descriptors so that they satisfy the
+ * preconditions of argpar_iter_create() and argpar_parse().
+ */
+static bool decode_input(const uint8_t * const data, const size_t size, struct input * const input)
+{
+    size_t pos = 2;
+    unsigned int descr_count, gen_descr_count;
+    unsigned int i;
+    size_t arg_begin;
+
+    memset(input, 0, sizeof(*input));
+
+    if (size < 2) {
+        return false;
+    }
+
+    input->buf = malloc(size + 1);
+    input->argv = malloc((size + 1) * sizeof(*input->argv));
+
+    if (!input->buf || !input->argv) {
+        abort();
+    }
+
+    memcpy(input->buf, data, size);
+    input->buf[size] = '\0';
+    input->mode = data[0];
+    descr_count = data[1] & 0x1f;
+    gen_descr_count = (data[1] >> 5) * 32;
+
+    for (i = 0; i < descr_count && pos < size; i++) {
+        const uint8_t flags = data[pos];
+        char short_name = '\0';
+        const char *long_name = NULL;
+
+        pos++;
+
+        if ((flags & 0x4) && pos < size) {
+            short_name = (char) data[pos];
+            pos++;
+
+            /* Short names: printable, and not `-` or `=` */
+            if (short_name <= ' ' || short_name > '~' || short_name == '-' ||
+                short_name == '=') {
+                short_name = (char) ('a' + i);
+            }
+        }
+
+        if (flags & 0x8) {
+            long_name = &input->buf[pos];
+            pos += strlen(long_name) + 1;
+
+            /* Long names: not empty, and without `=` */
+            if (strlen(long_name) == 0 || strchr(long_name, '=')) {
+                long_name = NULL;
+            }
+        }
+
+        if (!short_name && !long_name) {
+            /* Not the sentinel */
+            short_name = (char) ('a' + i);
+        }
+
+        {
+            const bool with_arg = flags & 0x1;
+            const argpar_opt_descr_t descr = {
+                .id = (int) i,
+                .short_name = short_name,
+                .long_name = long_name,
+                .with_arg = with_arg,
+                .flags = ((flags & 0x2) && long_name && !with_arg ?
+                              ARGPAR_OPT_DESCR_FLAG_NEGATABLE :
+                              0) |
+                         (flags & 0x10 ? ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER : 0),
+            };
+
+            memcpy(&input->descrs[i], &descr, sizeof(descr));
+        }
+    }
+
+    /* Generated descriptors */
+    descr_count = i;
+
+    for (i = 0; i < gen_descr_count; i++) {
+        char * const long_name = input->gen_long_names[i];
+        const argpar_opt_descr_t descr =
+            ARGPAR_OPT_DESCR((int) (descr_count + i), '\0', long_name, i % 2 == 1);
+
+        snprintf(long_name, sizeof(input->gen_long_names[i]), "gen-%u", i);
+        memcpy(&input->descrs[descr_count + i], &descr, sizeof(descr));
+    }
+
+    /* Original arguments */
+    arg_begin = pos;
+
+    for (; pos <= size; pos++) {
+        if (pos == size || input->buf[pos] == '\0') {
+            if (pos > arg_begin || pos < size) {
+                input->argv[input->argc] = &input->buf[arg_begin];
+                input->argc++;
+            }
+
+            arg_begin = pos + 1;
+        }
+    }
+
+    if (input->mode & INPUT_MODE_IMAGE) {
+        make_image(input);
+    }
+
+    return true;
+}
+
+static void fini_input(struct input * const input)
+{
+    free(input->image);
+    free(input->buf);
+    free((void *) input->argv);
+}
+
+/*
+ * Parses the decoded input `input` with an incremental reparser: all
+ * the original arguments, then all of them except the last one, and
+ * then all of them again (edits at the end of the command line).
+ */
+static void reparse_input(const struct input * const input)
+{
+    argpar_reparser_t * const reparser = argpar_reparser_create(input->descrs);
+    const unsigned int argcs[] = {
+        input->argc,
+        input->argc > 0 ? input->argc - 1 : 0,
+        input->argc,
+    };
+    unsigned int i;
+
+    if (!reparser) {
+        abort();
+    }
+
+    for (i = 0; i < sizeof(argcs) / sizeof(argcs[0]); i++) {
+        const argpar_error_t *error = NULL;
+
+        if (argpar_reparser_parse(reparser, argcs[i], input->argv, &error) ==
+                ARGPAR_PARSE_STATUS_OK &&
+            argpar_reparser_reused_orig_args(reparser) > argcs[i]) {
+            abort();
+        }
+
+        argpar_error_destroy(error);
+    }
+
+    argpar_reparser_destroy(reparser);
+}
+
+/*
+ * Opens the descriptor image of the decoded input `input` and, if it's
+ * valid, parses the original arguments with an iterator created from
+ * it.
+ */
+static void parse_image_input(const struct input * const input)
+{
+    const argpar_descr_image_t *image = NULL;
+    argpar_iter_t *iter;
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+
+    if (argpar_descr_image_open(input->image, input->image_size, IMAGE_KEY, NULL, &image) !=
+        ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK) {
+        goto end;
+    }
+
+    iter = argpar_iter_create_with_image(input->argc, input->argv, image);
+
+    if (!iter) {
+        abort();
+    }
+
+    while (argpar_iter_next(iter, &item, &error) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+
+end:
+    argpar_descr_image_destroy(image);
+}
+
+/*
+ * Parses the decoded input `input` according to its mode.
+ */
+static void parse_input(const struct input * const input)
+{
+    if (input->mode & INPUT_MODE_IMAGE) {
+        parse_image_input(input);
+    } else if (input->mode & INPUT_MODE_BATCH) {
+        const argpar_parse_result_t *result = NULL;
+        const argpar_error_t *error = NULL;
+
+        if (argpar_parse(input->argc, input->argv, input->descrs, ARGPAR_PARSE_FLAG_PERMUTE,
+                         &result, &error) == ARGPAR_PARSE_STATUS_OK) {
+            unsigned int i;
+
+            for (i = 0; i < argpar_parse_result_item_count(result); i++) {
+                (void) argpar_item_type(argpar_parse_result_permuted_item(result, i));
+            }
+        }
+
+        argpar_parse_result_destroy(result);
+        argpar_error_destroy(error);
+    } else if (input->mode & INPUT_MODE_REPARSE) {
+        reparse_input(input);
+    } else {
+        unsigned char bitset[ARGPAR_FLAG_BITSET_SIZE(MAX_DESCRS)] = {0};
+        unsigned int counters[MAX_DESCRS] = {0};
+        argpar_iter_t * const iter = argpar_iter_create(input->argc, input->argv, input->descrs);
+        const argpar_item_t *item = NULL;
+        const argpar_error_t *error = NULL;
+        const argpar_lookup_strategy_t strategy =
+            (argpar_lookup_strategy_t) (input->mode & INPUT_MODE_LOOKUP_STRATEGY_MASK);
+
+        if (!iter) {
+            abort();
+        }
+
+        if (strategy != ARGPAR_LOOKUP_STRATEGY_AUTO &&
+            argpar_iter_set_lookup_strategy(iter, strategy) !=
+                ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK) {
+            abort();
+        }
+
+        argpar_iter_set_lookup_cache(iter, input->mode & INPUT_MODE_LOOKUP_CACHE);
+
+        if (input->mode & INPUT_MODE_FLAG_SINK) {
+            argpar_iter_set_flag_sink(iter, bitset, counters);
+        }
+
+        argpar_iter_set_stop_at_non_opt(iter, input->mode & INPUT_MODE_STOP_AT_NON_OPT);
+
+        while (argpar_iter_next(iter, &item, &error) == ARGPAR_ITER_NEXT_STATUS_OK) {
+            if (argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT) {
+                (void) argpar_item_opt_arg(item);
+            }
+
+            ARGPAR_ITEM_DESTROY_AND_RESET(item);
+        }
+
+        if (error) {
+            (void) argpar_error_orig_index(error);
+        }
+
+        argpar_error_destroy(error);
+        argpar_iter_destroy(iter);
+    }
+}
+
+/*
+ * Aborts if parsing an input of `size` bytes took more than
+ * `elapsed_ns` nanoseconds or made more than `allocs` allocations.
+ *
+ * argpar makes at most one allocation per item, and at most one item
+ * per input byte, plus a few allocations for the iterator, the error,
+ * the growth of its temporary buffer, and the batch parsing result.
+ */
+static void check_oracle(const size_t size, const uint64_t elapsed_ns,
+                         const unsigned long long allocs)
+{
+    static uint64_t max_ns_per_byte;
+    const unsigned long long max_allocs = 2 * (unsigned long long) size + 32;
+    uint64_t max_ns;
+
+    if (max_ns_per_byte == 0) {
+        const char * const env = getenv("ARGPAR_FUZZ_MAX_NS_PER_BYTE");
+
+        max_ns_per_byte = env ? strtoull(env, NULL, 10) : 0;
+
+        if (max_ns_per_byte == 0) {
+            max_ns_per_byte = 20000;
+        }
+    }
+
+    if (allocs > max_allocs) {
+        fprintf(stderr, "Oracle: %llu allocations for %zu input bytes (maximum: %llu)\n",
+                allocs, size, max_allocs);
+        abort();
+    }
+
+    /* Allow 10 ms of scheduling noise */
+    max_ns = max_ns_per_byte * (size + 1) + 10000000ULL;
+
+    if (elapsed_ns > max_ns) {
+        fprintf(stderr, "Oracle: %llu ns for %zu input bytes (maximum: %llu ns)\n",
+                (unsigned long long) elapsed_ns, size, (unsigned long long) max_ns);
+        abort();
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t * const data, const size_t size)
+{
+    struct input input;
+    uint64_t begin_ns, elapsed_ns;
+
+    if (!decode_input(data, size, &input)) {
+        goto end;
+    }
+
+    alloc_count = 0;
+    alloc_count_enabled = true;
+    begin_ns = now_ns();
+    parse_input(&input);
+    elapsed_ns = now_ns() - begin_ns;
+    alloc_count_enabled = false;
+    check_oracle(size, elapsed_ns, alloc_count);
+
+end:
+    fini_input(&input);
+    return 0;
+}
+
+#ifndef ARGPAR_FUZZ_LIBFUZZER
+/* Inputs of the standalone driver */
+static struct
+{
+    uint8_t **data;
+    size_t *sizes;
+    unsigned int count;
+    unsigned int capacity;
+} inputs;
+
+/* Maximum size of an input */
+#    define MAX_INPUT_SIZE 4096
+
+/*
+ * Reads the file `path` and adds it to the inputs.
+ */
+static void add_input_file(const char * const path)
+{
+    FILE * const file = fopen(path, "rb");
+    uint8_t *data;
+    size_t size;
+
+    if (!file) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    data = malloc(MAX_INPUT_SIZE);
+    if (!data) {
+        abort();
+    }
+
+    size = fread(data, 1, MAX_INPUT_SIZE, file);
+    fclose(file);
+
+    if (inputs.count == inputs.capacity) {
+        inputs.capacity = inputs.capacity == 0 ? 16 : inputs.capacity * 2;
+        inputs.data = realloc(inputs.data, inputs.capacity * sizeof(*inputs.data));
+        inputs.sizes = realloc(inputs.sizes, inputs.capacity * sizeof(*inputs.sizes));
+
+        if (!inputs.data || !inputs.sizes) {
+            abort();
+        }
+    }
+
+    inputs.data[inputs.count] = data;
+    inputs.sizes[inputs.count] = size;
+    inputs.count++;
+}
+
+/*
+ * Adds the file `path` or, if it's a directory, all its regular files
+ * to the inputs.
+ */
+static void add_inputs(const char * const path)
+{
+    struct stat st;
+    DIR *dir;
+    const struct dirent *entry;
+
+    if (stat(path, &st) != 0) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        add_input_file(path);
+        return;
+    }
+
+    dir = opendir(path);
+    if (!dir) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    while ((entry = readdir(dir))) {
+        char entry_path[4096];
+
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+
+        snprintf(entry_path, sizeof(entry_path), "%s/%s", path, entry->d_name);
+
+        if (stat(entry_path, &st) == 0 && S_ISREG(st.st_mode)) {
+            add_input_file(entry_path);
+        }
+    }
+
+    closedir(dir);
+}
+
+/* Returns the next value of the xorshift PRNG `*state` */
+static uint32_t next_rand(uint32_t * const state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * Mutates the `*size` bytes of `data` (capacity: `MAX_INPUT_SIZE`)
+ * randomly.
+ */
+static void mutate(uint8_t * const data, size_t * const size, uint32_t * const rand_state)
+{
+    static const uint8_t interesting[] = {'\0', '-', '=', 'a', 'n', 'o', ',', 0xff};
+    const unsigned int mutation_count = 1 + next_rand(rand_state) % 8;
+    unsigned int i;
+
+    for (i = 0; i < mutation_count; i++) {
+        const size_t pos = *size > 0 ? next_rand(rand_state) % *size : 0;
+
+        switch (next_rand(rand_state) % 5) {
+        case 0:
+            /* Flip a bit */
+            if (*size > 0) {
+                data[pos] ^= (uint8_t) (1U << (next_rand(rand_state) % 8));
+            }
+
+            break;
+        case 1:
+            /* Replace with an interesting byte */
+            if (*size > 0) {
+                data[pos] = interesting[next_rand(rand_state) % sizeof(interesting)];
+            }
+
+            break;
+        case 2:
+            /* Insert a byte */
+            if (*size < MAX_INPUT_SIZE) {
+                memmove(&data[pos + 1], &data[pos], *size - pos);
+                data[pos] = interesting[next_rand(rand_state) % sizeof(interesting)];
+                (*size)++;
+            }
+
+            break;
+        case 3:
+            /* Delete a byte */
+            if (*size > 1) {
+                memmove(&data[pos], &data[pos + 1], *size - pos - 1);
+                (*size)--;
+            }
+
+            break;
+        default:
+        {
+            /* Duplicate a chunk (repetitive command lines) */
+            const size_t len = *size - pos < 16 ? *size - pos : 16;
+
+            if (*size + len <= MAX_INPUT_SIZE) {
+                memmove(&data[pos + len], &data[pos], *size - pos);
+                (*size) += len;
+            }
+
+            break;
+        }
+        }
+    }
+}
+
+int main(const int argc, const char * const * const argv)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 't', "time", true),
+        ARGPAR_OPT_DESCR(1, 's', "seed", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    unsigned long seconds = 0;
+    uint32_t rand_state = 1;
+    argpar_iter_t * const iter = argpar_iter_create((unsigned int) argc - 1, &argv[1], descrs);
+    const argpar_item_t *item = NULL;
+    argpar_iter_next_status_t status;
+    unsigned long long runs = 0;
+    unsigned int i;
+
+    if (!iter) {
+        abort();
+    }
+
+    while ((status = argpar_iter_next(iter, &item, NULL)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        if (argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT) {
+            const unsigned long value = strtoul(argpar_item_opt_arg(item), NULL, 10);
+
+            if (argpar_item_opt_descr(item)->id == 0) {
+                seconds = value;
+            } else {
+                rand_state = (uint32_t) value | 1;
+            }
+        } else {
+            add_inputs(argpar_item_non_opt_arg(item));
+        }
+
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    argpar_iter_destroy(iter);
+
+    if (status != ARGPAR_ITER_NEXT_STATUS_END || inputs.count == 0) {
+        fprintf(stderr, "Usage: %s [--time=SECONDS] [--seed=SEED] PATH...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Run each input once */
+    for (i = 0; i < inputs.count; i++) {
+        LLVMFuzzerTestOneInput(inputs.data[i], inputs.sizes[i]);
+        runs++;
+    }
+
+    /* Mutate inputs until the deadline */
+    if (seconds > 0) {
+        const uint64_t deadline_ns = now_ns() + (uint64_t) seconds * 1000000000ULL;
+        uint8_t * const data = malloc(MAX_INPUT_SIZE);
+
+        if (!data) {
+            abort();
+        }
+
+        while (now_ns() < deadline_ns) {
+            const unsigned int index = next_rand(&rand_state) % inputs.count;
+            size_t size = inputs.sizes[index];
+
+            memcpy(data, inputs.data[index], size);
+            mutate(data, &size, &rand_state);
+            LLVMFuzzerTestOneInput(data, size);
+            runs++;
+        }
+
+        free(data);
+    }
+
+    printf("%llu runs over %u inputs: OK\n", runs, inputs.count);
+
+    for (i = 0; i < inputs.count; i++) {
+        free(inputs.data[i]);
+    }
+
+    free(inputs.data);
+    free(inputs.sizes);
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,624 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+/*
+ * Allocation regression tests.
+ *
+ * This test program interposes the allocation functions of the C
+ * library to count the allocations and the peak allocated bytes of
+ * argpar API calls, and ensures that they're exactly the expected
+ * ones: an accidental extra allocation makes a test fail.
+ *
+ * The expected peak bytes depend on the sizes of the internal argpar
+ * structures, therefore this program only checks them on LP64
+ * platforms.
+ *
+ * A sanitizer (ASan, MSan, TSan) replaces the allocation functions
+ * itself, therefore this program skips all its tests in such a build
+ * instead of crashing.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "argpar/argpar.h"
+#include "tap/tap.h"
+
+/* Defined if a sanitizer replaces the allocation functions */
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#    define ALLOC_SANITIZER
+#elif defined(__has_feature)
+#    if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer) ||                     \
+        __has_feature(thread_sanitizer)
+#        define ALLOC_SANITIZER
+#    endif
+#endif
+
+#if defined(__GLIBC__) && !defined(ALLOC_SANITIZER)
+
+/* Maximum number of live allocations which the shim tracks */
+#    define MAX_LIVE_ALLOCS 256
+
+/* Allocation statistics, updated when `enabled` is true */
+static struct
+{
+    bool enabled;
+
+    /* Number of allocations (including reallocations) */
+    unsigned int count;
+
+    /* Current and peak requested bytes */
+    size_t cur_bytes;
+    size_t peak_bytes;
+
+    /* Live allocations made while enabled */
+    struct
+    {
+        void *ptr;
+        size_t size;
+    } live[MAX_LIVE_ALLOCS];
+} stats;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+/*
+ * Forgets the live allocation `ptr`, if tracked, removing its size
+ * from the current byte count.
+ */
+static void forget_alloc(void * const ptr)
+{
+    unsigned int i;
+
+    if (!ptr) {
+        return;
+    }
+
+    for (i = 0; i < MAX_LIVE_ALLOCS; i++) {
+        if (stats.live[i].ptr == ptr) {
+            stats.cur_bytes -= stats.live[i].size;
+            stats.live[i].ptr = NULL;
+            return;
+        }
+    }
+}
+
+/*
+ * Records the new allocation `ptr` of `size` bytes, if enabled.
+ */
+static void record_alloc(void * const ptr, const size_t size)
+{
+    unsigned int i;
+
+    if (!stats.enabled || !ptr) {
+        return;
+    }
+
+    stats.count++;
+    stats.cur_bytes += size;
+
+    if (stats.cur_bytes > stats.peak_bytes) {
+        stats.peak_bytes = stats.cur_bytes;
+    }
+
+    for (i = 0; i < MAX_LIVE_ALLOCS; i++) {
+        if (!stats.live[i].ptr) {
+            stats.live[i].ptr = ptr;
+            stats.live[i].size = size;
+            return;
+        }
+    }
+
+    abort();
+}
+
+void *malloc(const size_t size)
+{
+    void * const ptr = __libc_malloc(size);
+
+    record_alloc(ptr, size);
+    return ptr;
+}
+
+void *calloc(const size_t nmemb, const size_t size)
+{
+    void * const ptr = __libc_calloc(nmemb, size);
+
+    record_alloc(ptr, nmemb * size);
+    return ptr;
+}
+
+void *realloc(void * const ptr, const size_t size)
+{
+    void * const new_ptr = __libc_realloc(ptr, size);
+
+    if (new_ptr) {
+        forget_alloc(ptr);
+        record_alloc(new_ptr, size);
+    }
+
+    return new_ptr;
+}
+
+void free(void * const ptr)
+{
+    forget_alloc(ptr);
+    __libc_free(ptr);
+}
+
+char *strdup(const char * const str)
+{
+    const size_t size = strlen(str) + 1;
+    char * const copy = malloc(size);
+
+    if (copy) {
+        memcpy(copy, str, size);
+    }
+
+    return copy;
+}
+
+/* Resets the statistics and starts counting */
+static void start_counting(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.enabled = true;
+}
+
+/* Stops counting */
+static void stop_counting(void)
+{
+    stats.enabled = false;
+}
+
+/*
+ * Ensures that the statistics match `expected_count` and, on LP64
+ * platforms, `expected_peak_bytes`, and that nothing leaked.
+ */
+static void check_stats(const char * const what, const unsigned int expected_count,
+                        const size_t expected_peak_bytes)
+{
+    const bool check_peak = sizeof(void *) == 8 && sizeof(long) == 8;
+
+    ok(stats.count == expected_count, "%s: %u allocations", what, expected_count);
+
+    if (stats.count != expected_count) {
+        diag("Got %u allocations", stats.count);
+    }
+
+    if (check_peak) {
+        ok(stats.peak_bytes == expected_peak_bytes, "%s: peak of %zu bytes", what,
+           expected_peak_bytes);
+
+        if (stats.peak_bytes != expected_peak_bytes) {
+            diag("Got a peak of %zu bytes", stats.peak_bytes);
+        }
+    } else {
+        skip(1, "%s: peak bytes only checked on LP64 platforms", what);
+    }
+
+    ok(stats.cur_bytes == 0, "%s: no leak", what);
+}
+
+/*
+ * Iterates `argv` (`argc` elements) with argpar_iter_next() using the
+ * option descriptors `descrs`, destroying each item, and returns the
+ * final status.
+ */
+static argpar_iter_next_status_t iterate(const unsigned int argc, const char * const * const argv,
+                                         const argpar_opt_descr_t * const descrs)
+{
+    argpar_iter_t * const iter = argpar_iter_create(argc, argv, descrs);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_iter_next_status_t status;
+
+    while ((status = argpar_iter_next(iter, &item, &error)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+    return status;
+}
+
+/*
+ * LP64 sizes of the allocations: iterator (including its latency
+ * histogram in a histogram build) and its initial temporary buffer,
+ * option or non-option item, and error without its unknown option name.
+ */
+#    ifdef ARGPAR_ENABLE_HISTOGRAM
+#        define ITER_HISTOGRAM_BYTES sizeof(argpar_histogram_t)
+#    else
+#        define ITER_HISTOGRAM_BYTES 0
+#    endif
+#    define ITER_BYTES (512 + ITER_HISTOGRAM_BYTES + 128)
+#    define ITER_ALLOCS 2
+#    define ITEM_BYTES 56
+#    define ERROR_BYTES 72
+
+static const argpar_opt_descr_t descrs[] = {
+    ARGPAR_OPT_DESCR(0, 'a', NULL, false),
+    ARGPAR_OPT_DESCR(1, 'b', NULL, false),
+    ARGPAR_OPT_DESCR(2, '\0', "count", true),
+    ARGPAR_OPT_DESCR(3, '\0', "hello", false),
+    ARGPAR_OPT_DESCR(4, 't', "type", true),
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+
+static void iter_tests(void)
+{
+    /* Iterator creation: iterator and temporary buffer */
+    start_counting();
+    argpar_iter_destroy(argpar_iter_create(0, NULL, descrs));
+    stop_counting();
+    check_stats("argpar_iter_create()", ITER_ALLOCS, ITER_BYTES);
+
+    /* One allocation for the tables of a lookup strategy */
+    {
+        argpar_iter_t *iter;
+
+        start_counting();
+        iter = argpar_iter_create(0, NULL, descrs);
+        argpar_iter_set_lookup_strategy(iter, ARGPAR_LOOKUP_STRATEGY_FINGERPRINT);
+        argpar_iter_destroy(iter);
+        stop_counting();
+        check_stats("argpar_iter_set_lookup_strategy() with fingerprints", ITER_ALLOCS + 1,
+                    ITER_BYTES + 5 * (8 + 4 + 1));
+
+        /* 16 long name slots and 256 short name slots */
+        start_counting();
+        iter = argpar_iter_create(0, NULL, descrs);
+        argpar_iter_set_lookup_strategy(iter, ARGPAR_LOOKUP_STRATEGY_HASH);
+        argpar_iter_destroy(iter);
+        stop_counting();
+        check_stats("argpar_iter_set_lookup_strategy() with hash tables", ITER_ALLOCS + 1,
+                    ITER_BYTES + (16 + 256) * 4);
+    }
+
+    /* One allocation per item */
+    {
+        const char * const argv[] = {"--hello", "--count=23", "/path/to/file", "-ab",
+                                     "--type", "file", "--", "magie"};
+
+        start_counting();
+        iterate(8, argv, descrs);
+        stop_counting();
+        check_stats("argpar_iter_next() with 8 items", ITER_ALLOCS + 8, ITER_BYTES + ITEM_BYTES);
+    }
+
+    /* No item allocation with borrowed items */
+    {
+        const char * const argv[] = {"--hello", "--count=23", "/path/to/file", "-ab",
+                                     "--type", "file", "--", "magie"};
+        argpar_iter_t *iter;
+        const argpar_item_t *item = NULL;
+
+        start_counting();
+        iter = argpar_iter_create(8, argv, descrs);
+
+        while (argpar_iter_borrow_next(iter, &item, NULL) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        }
+
+        argpar_iter_destroy(iter);
+        stop_counting();
+        check_stats("argpar_iter_borrow_next() with 8 items", ITER_ALLOCS, ITER_BYTES);
+    }
+
+    /* Borrowed errors: no allocation */
+    {
+        const char * const argv[] = {"-a", "--meow=x", "-z", "file"};
+        argpar_iter_t *iter;
+        const argpar_item_t *item = NULL;
+        const argpar_error_t *error = NULL;
+        unsigned int error_count = 0;
+        unsigned int i;
+
+        start_counting();
+
+        for (i = 0; i < 4; i++) {
+            iter = argpar_iter_create(4 - i, &argv[i], descrs);
+
+            while (argpar_iter_borrow_next(iter, &item, &error) == ARGPAR_ITER_NEXT_STATUS_OK) {
+            }
+
+            if (error) {
+                error_count++;
+            }
+
+            argpar_iter_destroy(iter);
+        }
+
+        stop_counting();
+        check_stats("argpar_iter_borrow_next() with errors", 4 * ITER_ALLOCS, ITER_BYTES);
+        ok(error_count == 3, "argpar_iter_borrow_next() produces borrowed errors");
+    }
+
+    /* Long option name longer than the temporary buffer */
+    {
+        char arg[256];
+        const char * const argv[] = {arg};
+
+        memset(arg, 'x', sizeof(arg) - 1);
+        memcpy(arg, "--", 2);
+        arg[200] = '=';
+        arg[sizeof(arg) - 1] = '\0';
+        start_counting();
+        iterate(1, argv, descrs);
+        stop_counting();
+        /* Temporary buffer growth, and error with its unknown option name */
+        check_stats("argpar_iter_next() with an unknown long option name of 198 characters",
+                    ITER_ALLOCS + 1 + 1, ITER_BYTES - 128 + 256 + ERROR_BYTES + 201);
+    }
+
+    /* Unknown option error */
+    {
+        const char * const argv[] = {"-a", "--meow"};
+
+        start_counting();
+        iterate(2, argv, descrs);
+        stop_counting();
+        /* Item of `-a` destroyed before the error (with `--meow`) */
+        check_stats("argpar_iter_next() with an unknown option", ITER_ALLOCS + 1 + 1,
+                    ITER_BYTES + ERROR_BYTES + 7);
+    }
+}
+
+static void flag_sink_tests(void)
+{
+    const char * const argv[] = {"-abab", "-a", "--hello", "--count=23"};
+    unsigned char bitset[1] = {0};
+    unsigned int counters[5] = {0};
+    argpar_iter_t *iter;
+
+    /* No item for the flags */
+    start_counting();
+    iter = argpar_iter_create(4, argv, descrs);
+    argpar_iter_set_flag_sink(iter, bitset, counters);
+    argpar_iter_destroy(iter);
+    stop_counting();
+    check_stats("Flag sink without iteration", ITER_ALLOCS, ITER_BYTES);
+
+    start_counting();
+    iter = argpar_iter_create(4, argv, descrs);
+    argpar_iter_set_flag_sink(iter, bitset, counters);
+
+    {
+        const argpar_item_t *item = NULL;
+
+        while (argpar_iter_next(iter, &item, NULL) == ARGPAR_ITER_NEXT_STATUS_OK) {
+            ARGPAR_ITEM_DESTROY_AND_RESET(item);
+        }
+    }
+
+    argpar_iter_destroy(iter);
+    stop_counting();
+    check_stats("argpar_iter_next() with a flag sink", ITER_ALLOCS + 1, ITER_BYTES + ITEM_BYTES);
+}
+
+/* Number of choices of the choice table test */
+#    define CHOICE_COUNT 20000
+
+static void choice_tests(void)
+{
+    static char choice_bufs[CHOICE_COUNT][16];
+    static const char *choices[CHOICE_COUNT + 1];
+    const argpar_opt_descr_t choice_descrs[] = {
+        {.id = 0, .long_name = "format", .with_arg = true, .choices = choices},
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    unsigned int i;
+
+    for (i = 0; i < CHOICE_COUNT; i++) {
+        sprintf(choice_bufs[i], "choice-%u", i);
+        choices[i] = choice_bufs[i];
+    }
+
+    /*
+     * Choice table array and one choice table of 65,536 slots: the
+     * size of a choice table is linear in its choice count.
+     */
+    start_counting();
+    argpar_iter_destroy(argpar_iter_create(0, NULL, choice_descrs));
+    stop_counting();
+    check_stats("argpar_iter_create() with 20,000 choices", ITER_ALLOCS + 2,
+                ITER_BYTES + 16 + 65536 * 4);
+}
+
+static void batch_tests(void)
+{
+    const char * const argv[] = {"--hello", "--count=23", "/path/to/file", "-ab",
+                                 "--type", "file", "--", "magie"};
+    const argpar_parse_result_t *result = NULL;
+
+    /*
+     * Parsing result, item array (as many items as original
+     * arguments), and four segments, whatever the item count.
+     */
+    start_counting();
+    argpar_parse(8, argv, descrs, 0, &result, NULL);
+    argpar_parse_result_destroy(result);
+    stop_counting();
+    check_stats("argpar_parse() with 8 items", ITER_ALLOCS + 3,
+                ITER_BYTES + 72 + 8 * ITEM_BYTES + 4 * 12);
+
+    /* Two more index arrays */
+    start_counting();
+    argpar_parse(8, argv, descrs, ARGPAR_PARSE_FLAG_PERMUTE, &result, NULL);
+    argpar_parse_result_destroy(result);
+    stop_counting();
+    check_stats("argpar_parse() with 8 items and a permutation", ITER_ALLOCS + 5,
+                ITER_BYTES + 72 + 8 * ITEM_BYTES + 4 * 12 + 2 * 8 * 4);
+
+    /* Fingerprint: no item */
+    {
+        argpar_hash128_t fingerprint;
+
+        start_counting();
+        argpar_fingerprint(8, argv, descrs, &fingerprint, NULL);
+        stop_counting();
+        check_stats("argpar_fingerprint() with 8 items", ITER_ALLOCS, ITER_BYTES);
+    }
+}
+
+static void reparser_tests(void)
+{
+    const char * const argv[] = {"--hello", "--count=23", "/path/to/file", "-ab",
+                                 "--type", "file", "--", "magie"};
+    const char * const edited_argv[] = {"--hello", "--count=23", "/path/to/file", "-ab",
+                                        "--type", "file", "--", "magic"};
+    argpar_reparser_t * const reparser = argpar_reparser_create(descrs);
+
+    assert(reparser);
+    argpar_reparser_parse(reparser, 8, argv, NULL);
+
+    /* Only the copy of the changed original argument */
+    start_counting();
+    argpar_reparser_parse(reparser, 8, edited_argv, NULL);
+    stop_counting();
+    ok(stats.count == 1 && argpar_reparser_reused_orig_args(reparser) == 7,
+       "argpar_reparser_parse() only allocates for the changed original argument");
+    argpar_reparser_destroy(reparser);
+}
+
+static void parse_into_tests(void)
+{
+    struct config
+    {
+        bool hello;
+        unsigned long long count;
+    } config = {false, 0};
+    const argpar_opt_descr_t bound_descrs[] = {
+        {.id = 0, .long_name = "hello", .binding = ARGPAR_BIND_FLAG(struct config, hello)},
+        {.id = 1, .long_name = "count", .with_arg = true,
+         .binding = ARGPAR_BIND_UINT(struct config, count)},
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    const char * const argv[] = {"--hello", "--count=23", "--count", "42"};
+
+    /* No item */
+    start_counting();
+    argpar_parse_into(4, argv, bound_descrs, NULL, &config, NULL);
+    stop_counting();
+    check_stats("argpar_parse_into()", ITER_ALLOCS, ITER_BYTES);
+}
+
+/* Live blocks of test_allocator */
+static unsigned int test_allocator_live_count;
+
+static void *test_allocator_realloc(void * const ptr, const size_t size, void * const data)
+{
+    unsigned int * const count = data;
+
+    if (!ptr) {
+        test_allocator_live_count++;
+    }
+
+    (*count)++;
+    return __libc_realloc(ptr, size);
+}
+
+static void test_allocator_free(void * const ptr, void * const data)
+{
+    (void) data;
+
+    if (ptr) {
+        test_allocator_live_count--;
+    }
+
+    __libc_free(ptr);
+}
+
+static void allocator_tests(void)
+{
+    const char * const argv[] = {"-a", "file", "--meow"};
+    unsigned int count = 0;
+    const argpar_allocator_t allocator = {test_allocator_realloc, test_allocator_free, &count};
+    const argpar_parse_result_t *result = NULL;
+    const argpar_error_t *error = NULL;
+
+    /* Iterator, two items, and error */
+    {
+        argpar_iter_t *iter;
+        const argpar_item_t *item = NULL;
+
+        start_counting();
+        iter = argpar_iter_create_with_allocator(3, argv, descrs, &allocator);
+
+        while (argpar_iter_next(iter, &item, &error) == ARGPAR_ITER_NEXT_STATUS_OK) {
+            ARGPAR_ITEM_DESTROY_AND_RESET(item);
+        }
+
+        argpar_error_destroy(error);
+        argpar_iter_destroy(iter);
+        stop_counting();
+    }
+
+    check_stats("argpar_iter_create_with_allocator()", 0, 0);
+    ok(count == ITER_ALLOCS + 2 + 1 && test_allocator_live_count == 0,
+       "argpar_iter_create_with_allocator(): allocates from the allocator");
+
+    /* Parsing result */
+    count = 0;
+    start_counting();
+    argpar_parse_with_allocator(2, argv, descrs, ARGPAR_PARSE_FLAG_PERMUTE, &allocator, &result,
+                                NULL);
+    argpar_parse_result_destroy(result);
+    stop_counting();
+    check_stats("argpar_parse_with_allocator()", 0, 0);
+    ok(count == ITER_ALLOCS + 5 && test_allocator_live_count == 0,
+       "argpar_parse_with_allocator(): allocates from the allocator");
+}
+
+static void no_alloc_tests(void)
+{
+    argpar_kv_iter_t kv_iter;
+    argpar_kv_item_t kv_item;
+    unsigned int kv_count = 0;
+
+    start_counting();
+    argpar_kv_iter_init(&kv_iter, "path=\"/x\",begin=12,names=[a,b],m={x=1}");
+
+    while (argpar_kv_iter_next(&kv_iter, &kv_item) == ARGPAR_KV_ITER_NEXT_STATUS_OK) {
+        kv_count++;
+    }
+
+    stop_counting();
+    check_stats("Key-value argument iteration", 0, 0);
+    ok(kv_count == 9, "Key-value argument iteration yields all the items");
+}
+
+int main(void)
+{
+    plan_tests(59);
+    iter_tests();
+    flag_sink_tests();
+    choice_tests();
+    batch_tests();
+    reparser_tests();
+    parse_into_tests();
+    allocator_tests();
+    no_alloc_tests();
+    return exit_status();
+}
+
+#else
+
+int main(void)
+{
+#    ifdef ALLOC_SANITIZER
+    plan_skip_all("Allocation interposition conflicts with the sanitizer");
+#    else
+    plan_skip_all("Allocation interposition requires the GNU C library");
+#    endif
+    return exit_status();
+}
+
+#endif
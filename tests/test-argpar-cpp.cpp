@@ -0,0 +1,488 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+/*
+ * C++ API tests.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+
+#include "argpar/argpar.hpp"
+#include "tap/tap.h"
+
+namespace {
+
+const argpar_opt_descr_t descrs[] = {
+    ARGPAR_OPT_DESCR(0, 'a', nullptr, false),
+    ARGPAR_OPT_DESCR(1, 'b', nullptr, false),
+    ARGPAR_OPT_DESCR(2, 'o', "output", true),
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+
+/*
+ * Memory resource which counts the live blocks it allocates from its
+ * upstream memory resource.
+ */
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource * const upstream) : _mUpstream {upstream}
+    {
+    }
+
+    unsigned int allocCount = 0;
+    unsigned int liveCount = 0;
+
+private:
+    void *do_allocate(const std::size_t size, const std::size_t align) override
+    {
+        const auto ptr = _mUpstream->allocate(size, align);
+
+        ++allocCount;
+        ++liveCount;
+        return ptr;
+    }
+
+    void do_deallocate(void * const ptr, const std::size_t size, const std::size_t align) override
+    {
+        --liveCount;
+        _mUpstream->deallocate(ptr, size, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource *_mUpstream;
+};
+
+/*
+ * Formats the item `item` like the tests of the C API do.
+ */
+std::string formatItem(const argpar::Item item)
+{
+    if (item.isOpt()) {
+        std::string str {"-"};
+
+        if (item.descr().long_name) {
+            str += std::string {"-"} + item.descr().long_name;
+        } else {
+            str += item.descr().short_name;
+        }
+
+        if (item.arg()) {
+            str += std::string {"="} + item.arg();
+        }
+
+        return str;
+    }
+
+    return std::string {item.arg()} + '<' + std::to_string(item.origIndex()) + ',' +
+           std::to_string(item.nonOptIndex()) + '>';
+}
+
+/*
+ * Parses `argv` with argpar::parse() and ensures that the formatted
+ * items are `expected`.
+ */
+void testParse(const std::span<const char * const> argv, const char * const expected)
+{
+    std::string res;
+
+    for (const auto item : argpar::parse(argv, descrs)) {
+        if (!res.empty()) {
+            res += ' ';
+        }
+
+        res += formatItem(item);
+    }
+
+    ok(res == expected, "argpar::parse() produces the expected items (`%s`)", expected);
+
+    if (res != expected) {
+        diag("Expected: `%s`", expected);
+        diag("Got:      `%s`", res.c_str());
+    }
+}
+
+void parseTests()
+{
+    {
+        const char * const argv[] = {"-ab", "--output=x", "file", "-o", "y", "other"};
+
+        testParse(argv, "-a -b --output=x file<2,0> --output=y other<5,1>");
+    }
+
+    testParse({}, "");
+
+    /* Lazy range composition */
+    {
+        const char * const argv[] = {"-a", "file", "-b", "other", "-a"};
+        unsigned int count = 0;
+
+        for (const auto item : argpar::parse(argv, descrs) |
+                                   std::views::filter([](const argpar::Item filterItem) {
+                                       return filterItem.isOpt() &&
+                                              filterItem.descr().short_name == 'a';
+                                   }) |
+                                   std::views::take(1)) {
+            (void) item;
+            ++count;
+        }
+
+        ok(count == 1, "argpar::parse() composes with range adaptors");
+    }
+}
+
+void errorTests()
+{
+    const char * const argv[] = {"-a", "--meow", "-b"};
+    unsigned int count = 0;
+    bool caught = false;
+
+    try {
+        for (const auto item : argpar::parse(argv, descrs)) {
+            (void) item;
+            ++count;
+        }
+    } catch (const argpar::ParseError& exc) {
+        caught = exc.type() == ARGPAR_ERROR_TYPE_UNKNOWN_OPT && exc.origIndex() == 1 &&
+                 std::strcmp(exc.what(), "Unknown option `--meow`") == 0;
+    }
+
+    ok(caught && count == 1, "argpar::parse() throws argpar::ParseError on parsing error");
+
+    /* Missing option argument as the first item */
+    caught = false;
+
+    try {
+        const char * const missingArgv[] = {"-o"};
+
+        for (const auto item : argpar::parse(missingArgv, descrs)) {
+            (void) item;
+        }
+    } catch (const argpar::ParseError& exc) {
+        caught = exc.type() == ARGPAR_ERROR_TYPE_MISSING_OPT_ARG;
+    }
+
+    ok(caught, "argpar::parse() throws argpar::ParseError on the first item");
+}
+
+/*
+ * Parses `argv` with argpar::tryParse() and returns its last element,
+ * setting `*count` to the number of elements.
+ *
+ * Only an error element remains valid: an item element is a view which
+ * the generator invalidates when it ends.
+ */
+argpar::Expected<argpar::Item> tryParseLast(const std::span<const char * const> argv,
+                                            unsigned int * const count,
+                                            std::pmr::memory_resource * const res = nullptr)
+{
+    std::optional<argpar::Expected<argpar::Item>> last;
+
+    *count = 0;
+
+    for (const auto& exp : argpar::tryParse(argv, descrs, res)) {
+        last = exp;
+        ++*count;
+    }
+
+    return *last;
+}
+
+void tryParseTests()
+{
+    unsigned int count;
+
+    {
+        const char * const argv[] = {"-a", "--meow=x", "-b"};
+        const auto last = tryParseLast(argv, &count);
+
+        ok(count == 2 && !last && last.error().type() == ARGPAR_ERROR_TYPE_UNKNOWN_OPT &&
+               last.error().origIndex() == 1 && last.error().unknownOptName() == "meow" &&
+               !last.error().isShort() && last.error().message() == "Unknown option `--meow`",
+           "argpar::tryParse() produces an unknown long option error");
+    }
+
+    {
+        const char * const argv[] = {"-abz"};
+        const auto last = tryParseLast(argv, &count);
+
+        ok(count == 3 && !last.hasValue() && last.error().unknownOptName() == "z" &&
+               last.error().isShort() && !last.error().descr() &&
+               last.error().message() == "Unknown option `-z`",
+           "argpar::tryParse() produces an unknown short option error");
+    }
+
+    {
+        const char * const argv[] = {"file", "--output"};
+        const auto last = tryParseLast(argv, &count);
+        bool thrown = false;
+
+        try {
+            (void) last.value();
+        } catch (const argpar::ParseError& exc) {
+            thrown = exc.type() == ARGPAR_ERROR_TYPE_MISSING_OPT_ARG;
+        }
+
+        ok(count == 2 && last.error().descr() == &descrs[2] && !last.error().isShort() &&
+               thrown,
+           "argpar::tryParse() produces a missing option argument error");
+    }
+
+    {
+        const char * const argv[] = {"-a", "file"};
+        bool allOk = true;
+        std::string lastArg;
+
+        count = 0;
+
+        /* Items are borrowed: read them before the next step */
+        for (const auto& exp : argpar::tryParse(argv, descrs)) {
+            allOk = allOk && exp.hasValue();
+            lastArg = exp->arg() ? exp->arg() : "";
+            ++count;
+        }
+
+        ok(count == 2 && allOk && lastArg == "file",
+           "argpar::tryParse() produces only items without error");
+    }
+
+    /* Errors cost no allocation */
+    {
+        const char * const validArgv[] = {"-a", "--output=x", "-b"};
+        const char * const errArgv[] = {"-a", "--meow=x", "-b"};
+        CountingResource validRes {std::pmr::new_delete_resource()};
+        CountingResource errRes {std::pmr::new_delete_resource()};
+
+        tryParseLast(validArgv, &count, &validRes);
+        tryParseLast(errArgv, &count, &errRes);
+        ok(errRes.allocCount == validRes.allocCount && errRes.liveCount == 0,
+           "argpar::tryParse() reports an error without allocating");
+    }
+}
+
+void memResourceTests()
+{
+    const char * const argv[] = {"file", "-ab", "--output=x", "other", "-a"};
+
+    /* Generator: coroutine frame and iterator */
+    {
+        CountingResource res {std::pmr::new_delete_resource()};
+        std::string str;
+
+        for (const auto item : argpar::parse(argv, descrs, &res)) {
+            str += formatItem(item) + ' ';
+        }
+
+        ok(str == "file<0,0> -a -b --output=x other<3,1> -a " && res.allocCount > 1 &&
+               res.liveCount == 0,
+           "argpar::parse() allocates from its memory resource");
+    }
+
+    /* Generator: error outliving its generator */
+    {
+        CountingResource res {std::pmr::new_delete_resource()};
+        const char * const errArgv[] = {"--meow"};
+        bool caught = false;
+
+        try {
+            auto gen = argpar::parse(errArgv, descrs, &res);
+
+            for (const auto item : gen) {
+                (void) item;
+            }
+        } catch (const argpar::ParseError& exc) {
+            caught = exc.error().unknownOptName() == "meow" && res.liveCount == 0;
+        }
+
+        ok(caught, "argpar::ParseError outlives its generator");
+    }
+
+    /* Parsing result */
+    {
+        CountingResource res {std::pmr::new_delete_resource()};
+        unsigned int allocCount;
+
+        {
+            const argpar::ParseResult result {argv, descrs, ARGPAR_PARSE_FLAG_PERMUTE, &res};
+
+            allocCount = res.allocCount;
+            ok(result.items().size() == 6 && result.permutedItems().size() == 6 &&
+                   formatItem(result.permutedItems()[3]) == "-a" &&
+                   formatItem(result.permutedItems()[4]) == "file<0,0>",
+               "argpar::ParseResult contains the expected items");
+            ok(result.get_allocator().resource() == &res && allocCount > 4,
+               "argpar::ParseResult allocates everything from its memory resource");
+        }
+
+        ok(res.liveCount == 0, "argpar::ParseResult releases all its memory");
+    }
+
+    /* Parsing result within a monotonic buffer */
+    {
+        std::byte buf[16384];
+        CountingResource upstream {std::pmr::null_memory_resource()};
+        std::pmr::monotonic_buffer_resource res {buf, sizeof(buf), &upstream};
+        const argpar::ParseResult result {argv, descrs, 0, &res};
+
+        ok(result.items().size() == 6 && result.permutedItems().empty() &&
+               upstream.allocCount == 0,
+           "argpar::ParseResult fits into a stack buffer");
+    }
+
+    /* Parsing error */
+    {
+        CountingResource res {std::pmr::new_delete_resource()};
+        const char * const errArgv[] = {"-a", "-o"};
+        bool caught = false;
+
+        try {
+            const argpar::ParseResult result {errArgv, descrs, 0, &res};
+        } catch (const argpar::ParseError& exc) {
+            caught = exc.type() == ARGPAR_ERROR_TYPE_MISSING_OPT_ARG && exc.origIndex() == 1;
+        }
+
+        ok(caught && res.liveCount == 0, "argpar::ParseResult throws argpar::ParseError");
+    }
+}
+
+using TypedOpts =
+    argpar::Opts<argpar::Flag<'v', "verbose">, argpar::Counter<'d', "debug">,
+                 argpar::Value<std::int64_t, 'j', "jobs">,
+                 argpar::Value<unsigned int, '\0', "port">, argpar::Value<double, 'r'>,
+                 argpar::Value<std::string, 'o', "output">>;
+
+/* The descriptor table is a constant */
+static_assert(TypedOpts::descrs.size() == 7);
+static_assert(TypedOpts::descrs[2].id == 2 && TypedOpts::descrs[2].short_name == 'j' &&
+              TypedOpts::descrs[2].with_arg);
+static_assert(!TypedOpts::descrs[3].short_name && TypedOpts::descrs[4].long_name == nullptr);
+
+void typedOptsTests()
+{
+    {
+        const char * const argv[] = {"-dvd", "--jobs=-12", "file", "--port", "0x50",
+                                     "-r",   "2.5",        "-o",   "out",    "-d"};
+        const auto result = TypedOpts::parse(argv);
+
+        ok(result.get<"verbose">() && result.get<'d'>() == 3 && result.get<"debug">() == 3 &&
+               result.get<"jobs">() == -12 && result.get<"port">() == 0x50 &&
+               result.get<'r'>() == 2.5 && result.get<"output">() == "out" &&
+               result.nonOpts().size() == 1 && std::strcmp(result.nonOpts()[0], "file") == 0,
+           "argpar::Opts::parse() converts the option arguments");
+    }
+
+    {
+        const auto result = TypedOpts::parse({});
+
+        ok(!result.get<"verbose">() && result.get<"debug">() == 0 && !result.get<"jobs">() &&
+               !result.get<'o'>() && result.nonOpts().empty(),
+           "argpar::Opts::parse() leaves the values of missing options empty");
+    }
+
+    /* Integer grammar of strtoll() with base 0 */
+    {
+        const char * const argv[] = {"--jobs=010", "--port", "+5"};
+        const auto result = TypedOpts::parse(argv);
+
+        ok(result.get<"jobs">() == 8 && result.get<"port">() == 5,
+           "argpar::Opts::parse() converts octal and explicitly positive integers");
+    }
+
+    /* Real number grammar of strtod() */
+    {
+        const char * const argv[] = {"-r", "+1.5"};
+        const char * const hexArgv[] = {"-r", "0x1p3"};
+        const char * const negHexArgv[] = {"-r-0X1.8p1"};
+
+        ok(TypedOpts::parse(argv).get<'r'>() == 1.5 &&
+               TypedOpts::parse(hexArgv).get<'r'>() == 8.0 &&
+               TypedOpts::parse(negHexArgv).get<'r'>() == -3.0,
+           "argpar::Opts::parse() converts explicitly positive and hexadecimal real numbers");
+    }
+
+    {
+        const char * const argv[] = {"--jobs=-0x7fffffffffffffff", "--jobs",
+                                     "-0x8000000000000000"};
+        const auto result = TypedOpts::parse(argv);
+
+        ok(result.get<"jobs">() == std::numeric_limits<std::int64_t>::min(),
+           "argpar::Opts::parse() converts the minimum signed integer");
+    }
+
+    /* Invalid option arguments */
+    {
+        const auto isInvalid = [](const std::span<const char * const> argv,
+                                  const char * const arg) {
+            try {
+                TypedOpts::parse(argv);
+            } catch (const argpar::InvalidOptArgError& exc) {
+                return std::strcmp(exc.arg(), arg) == 0;
+            }
+
+            return false;
+        };
+        const char * const trailingArgv[] = {"--jobs=12x"};
+        const char * const negativeArgv[] = {"--port=-1"};
+        const char * const rangeArgv[] = {"--port", "99999999999"};
+        const char * const emptyArgv[] = {"-r", ""};
+        const char * const hexSignArgv[] = {"--jobs=0x-5"};
+        const char * const hexPlusArgv[] = {"--port=0x+5"};
+        const char * const signOnlyArgv[] = {"--jobs=-"};
+        const char * const octalArgv[] = {"--jobs=08"};
+        const char * const spaceArgv[] = {"--jobs= 5"};
+        const char * const minRangeArgv[] = {"--jobs=-9223372036854775809"};
+        const char * const realSignArgv[] = {"-r", "+-1.5"};
+        const char * const realHexSignArgv[] = {"-r", "0x-1p3"};
+
+        ok(isInvalid(trailingArgv, "12x") && isInvalid(negativeArgv, "-1") &&
+               isInvalid(rangeArgv, "99999999999") && isInvalid(emptyArgv, ""),
+           "argpar::Opts::parse() throws argpar::InvalidOptArgError on invalid argument");
+        ok(isInvalid(hexSignArgv, "0x-5") && isInvalid(hexPlusArgv, "0x+5") &&
+               isInvalid(signOnlyArgv, "-") && isInvalid(octalArgv, "08") &&
+               isInvalid(spaceArgv, " 5") && isInvalid(minRangeArgv, "-9223372036854775809"),
+           "argpar::Opts::parse() rejects a sign after `0x` and other invalid integers");
+        ok(isInvalid(realSignArgv, "+-1.5") && isInvalid(realHexSignArgv, "0x-1p3"),
+           "argpar::Opts::parse() rejects two signs and a sign after `0x` (real number)");
+    }
+
+    {
+        const char * const argv[] = {"--meow"};
+        bool caught = false;
+
+        try {
+            TypedOpts::parse(argv);
+        } catch (const argpar::ParseError& exc) {
+            caught = exc.type() == ARGPAR_ERROR_TYPE_UNKNOWN_OPT;
+        }
+
+        ok(caught, "argpar::Opts::parse() throws argpar::ParseError on parsing error");
+    }
+}
+
+} /* namespace */
+
+int main()
+{
+    plan_tests(26);
+    parseTests();
+    errorTests();
+    tryParseTests();
+    memResourceTests();
+    typedOptsTests();
+    return exit_status();
+}
@@ -14,6 +14,9 @@
 #include "argpar/argpar.h"
 #include "tap/tap.h"
 
+/* Original argument arrays of the argpar_parse_into() tests */
+static GPtrArray *parse_into_argvs;
+
 /*
  * Formats `item` and appends the resulting string to `res_str` to
  * incrementally build an expected command line string.
@@ -22,6 +25,8 @@
  *
  * ‣ Prefers the `--long-opt=arg` style over the `-s arg` style.
  *
+ * ‣ Uses the `--no-long-opt` form for negated option items.
+ *
  * ‣ Uses the `arg<A,B>` form for non-option arguments, where `A` is the
  *   original argument index and `B` is the non-option argument index.
  */
@@ -37,7 +42,9 @@ static void append_to_res_str(GString * const res_str, const argpar_item_t * con
         const argpar_opt_descr_t * const descr = argpar_item_opt_descr(item);
         const char * const arg = argpar_item_opt_arg(item);
 
-        if (descr->long_name) {
+        if (argpar_item_opt_is_negated(item)) {
+            g_string_append_printf(res_str, "--no-%s", descr->long_name);
+        } else if (descr->long_name) {
             g_string_append_printf(res_str, "--%s", descr->long_name);
 
             if (arg) {
@@ -154,56 +161,64 @@ static void succeed_tests(void)
 
     /* Single long option */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "salut", false}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "salut", false),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--salut", "--salut", descrs, 1);
     }
 
     /* Single short option */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'f', NULL, false}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'f', NULL, false),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-f", "-f", descrs, 1);
     }
 
     /* Short and long option (aliases) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'f', "flaw", false}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'f', "flaw", false),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-f --flaw", "--flaw --flaw", descrs, 2);
     }
 
     /* Long option with argument (space form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "tooth", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "tooth", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--tooth 67", "--tooth=67", descrs, 2);
     }
 
     /* Long option with argument (equal form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "polish", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "polish", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--polish=brick", "--polish=brick", descrs, 1);
     }
 
     /* Short option with argument (space form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'c', NULL, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'c', NULL, true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-c chilly", "-c chilly", descrs, 2);
     }
 
     /* Short option with argument (glued form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'c', NULL, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'c', NULL, true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-cchilly", "-c chilly", descrs, 1);
     }
 
     /* Short and long option (aliases) with argument (all forms) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'd', "dry", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'd', "dry", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--dry=rate -dthing --dry street --dry=shape",
                      "--dry=rate --dry=thing --dry=street --dry=shape", descrs, 5);
@@ -211,9 +226,9 @@ static void succeed_tests(void)
 
     /* Many short options, last one with argument (glued form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'd', NULL, false},
-                                             {0, 'e', NULL, false},
-                                             {0, 'f', NULL, true},
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'd', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, 'e', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, 'f', NULL, true),
                                              ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-defmeow", "-d -e -f meow", descrs, 1);
@@ -221,9 +236,9 @@ static void succeed_tests(void)
 
     /* Many options */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'd', NULL, false},
-                                             {0, 'e', "east", true},
-                                             {0, '\0', "mind", false},
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'd', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, 'e', "east", true),
+                                             ARGPAR_OPT_DESCR(0, '\0', "mind", false),
                                              ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-d --mind -destart --mind --east cough -d --east=itch",
@@ -246,8 +261,8 @@ static void succeed_tests(void)
 
     /* Single non-option argument mixed with options */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'd', NULL, false},
-                                             {0, '\0', "squeeze", true},
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'd', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, '\0', "squeeze", true),
                                              ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-d sprout yes --squeeze little bag -d",
@@ -256,50 +271,56 @@ static void succeed_tests(void)
 
     /* Valid `---opt` */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "-fuel", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "-fuel", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("---fuel=three", "---fuel=three", descrs, 1);
     }
 
     /* Long option containing `=` in argument (equal form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "zebra", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "zebra", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--zebra=three=yes", "--zebra=three=yes", descrs, 1);
     }
 
     /* Short option's argument starting with `-` (glued form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'z', NULL, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'z', NULL, true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-z-will", "-z -will", descrs, 1);
     }
 
     /* Short option's argument starting with `-` (space form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'z', NULL, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'z', NULL, true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-z -will", "-z -will", descrs, 2);
     }
 
     /* Long option's argument starting with `-` (space form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "janine", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "janine", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--janine -sutto", "--janine=-sutto", descrs, 2);
     }
 
     /* Long option's argument starting with `-` (equal form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "janine", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "janine", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("--janine=-sutto", "--janine=-sutto", descrs, 1);
     }
 
     /* Long option's empty argument (equal form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'f', NULL, false},
-                                             {0, '\0', "yeah", true},
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'f', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, '\0', "yeah", true),
                                              ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-f --yeah= -f", "-f --yeah= -f", descrs, 3);
@@ -307,14 +328,16 @@ static void succeed_tests(void)
 
     /* `-` non-option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'f', NULL, false}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'f', NULL, false),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-f - -f", "-f -<1,0> -f", descrs, 3);
     }
 
     /* `--` non-option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'f', NULL, false}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'f', NULL, false),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_succeed("-f -- -f", "-f --<1,0> -f", descrs, 3);
     }
@@ -336,12 +359,35 @@ static void succeed_tests(void)
                                 "cornhole-cliche-tattooed-green-juice-adaptogen-"
                                 "kitsch-lo-fi-vexillologist-migas-gentrify-"
                                 "viral-raw-denim";
-        const argpar_opt_descr_t descrs[] = {{0, '\0', opt_name, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {{.id = 0, .long_name = opt_name, .with_arg = true},
+                                             ARGPAR_OPT_DESCR_SENTINEL};
         char cmdline[1024];
 
         sprintf(cmdline, "--%s=23", opt_name);
         test_succeed(cmdline, cmdline, descrs, 1);
     }
+
+    /* Negated long option */
+    {
+        const argpar_opt_descr_t descrs[] = {
+            {.id = 0, .short_name = 'c', .long_name = "color",
+             .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+            ARGPAR_OPT_DESCR(1, '\0', "nice", true),
+            ARGPAR_OPT_DESCR_SENTINEL};
+
+        test_succeed("--color --no-color -c --nice=no-color --no-color",
+                     "--color --no-color --color --nice=no-color --no-color", descrs, 5);
+    }
+
+    /* Exact `no-` long option name has precedence over negated form */
+    {
+        const argpar_opt_descr_t descrs[] = {
+            {.id = 0, .long_name = "pager", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+            ARGPAR_OPT_DESCR(1, '\0', "no-pager", true),
+            ARGPAR_OPT_DESCR_SENTINEL};
+
+        test_succeed("--no-pager less --pager", "--no-pager=less --pager", descrs, 3);
+    }
 }
 
 /*
@@ -405,10 +451,21 @@ static void test_fail(const char * const cmdline, const argpar_error_type_t expe
                cmdline, i + 1);
 
             if (argpar_error_type(error) == ARGPAR_ERROR_TYPE_UNKNOWN_OPT) {
+                bool is_short;
+                const argpar_slice_t name = argpar_error_unknown_opt_name_slice(error, &is_short);
+                const size_t prefix_len = is_short ? 1 : 2;
+
                 ok(strcmp(argpar_error_unknown_opt_name(error), expected_unknown_opt_name) == 0,
                    "argpar_iter_next() sets an error with the expected unknown option name "
                    "for command line `%s` (call %u)",
                    cmdline, i + 1);
+                ok(strlen(expected_unknown_opt_name) == prefix_len + name.len &&
+                       strncmp(&expected_unknown_opt_name[prefix_len], name.ptr, name.len) == 0 &&
+                       strncmp(expected_unknown_opt_name, "--", prefix_len) == 0 &&
+                       expected_unknown_opt_name[prefix_len] != '-',
+                   "argpar_iter_next() sets an error with the expected unknown option name slice "
+                   "for command line `%s` (call %u)",
+                   cmdline, i + 1);
             } else {
                 bool is_short;
 
@@ -455,21 +512,24 @@ static void fail_tests(void)
 {
     /* Unknown short option (space form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'd', NULL, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'd', NULL, true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("-d salut -e -d meow", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 2, "-e", 0, false, descrs);
     }
 
     /* Unknown short option (glued form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'd', 0, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {{.id = 0, .short_name = 'd', .with_arg = true},
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("-dsalut -e -d meow", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 1, "-e", 0, false, descrs);
     }
 
     /* Unknown long option (space form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "sink", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "sink", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("--sink party --food --sink impulse", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 2, "--food",
                   0, false, descrs);
@@ -477,7 +537,8 @@ static void fail_tests(void)
 
     /* Unknown long option (equal form) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "sink", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "sink", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("--sink=party --food --sink=impulse", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 1, "--food",
                   0, false, descrs);
@@ -485,7 +546,8 @@ static void fail_tests(void)
 
     /* Unknown option before non-option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "thumb", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "thumb", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("--thumb=party --food=18 bateau --thumb waves", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 1,
                   "--food", 0, false, descrs);
@@ -493,7 +555,8 @@ static void fail_tests(void)
 
     /* Unknown option after non-option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "thumb", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "thumb", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("--thumb=party wound --food --thumb waves", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 2,
                   "--food", 0, false, descrs);
@@ -501,23 +564,25 @@ static void fail_tests(void)
 
     /* Missing long option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, '\0', "thumb", true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "thumb", true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("allo --thumb", ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, 1, NULL, 0, false, descrs);
     }
 
     /* Missing short option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'k', NULL, true}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'k', NULL, true),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("zoom heille -k", ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, 2, NULL, 0, true, descrs);
     }
 
     /* Missing short option argument (multiple glued) */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'a', NULL, false},
-                                             {0, 'b', NULL, false},
-                                             {0, 'c', NULL, true},
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'a', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, 'b', NULL, false),
+                                             ARGPAR_OPT_DESCR(0, 'c', NULL, true),
                                              ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("-abc", ARGPAR_ERROR_TYPE_MISSING_OPT_ARG, 0, NULL, 2, true, descrs);
@@ -525,17 +590,1878 @@ static void fail_tests(void)
 
     /* Unexpected long option argument */
     {
-        const argpar_opt_descr_t descrs[] = {{0, 'c', "chevre", false}, ARGPAR_OPT_DESCR_SENTINEL};
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, 'c', "chevre", false),
+                                             ARGPAR_OPT_DESCR_SENTINEL};
 
         test_fail("ambulance --chevre=fromage tar -cjv", ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG, 1,
                   NULL, 0, false, descrs);
     }
+
+    /* Negated form of non-negatable long option */
+    {
+        const argpar_opt_descr_t descrs[] = {ARGPAR_OPT_DESCR(0, '\0', "sugar", false),
+                                             {.id = 1, .long_name = "salt",
+                                              .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+                                             ARGPAR_OPT_DESCR_SENTINEL};
+
+        test_fail("--no-salt --no-sugar", ARGPAR_ERROR_TYPE_UNKNOWN_OPT, 1, "--no-sugar", 0, false,
+                  descrs);
+    }
+
+    /* Unexpected negated long option argument */
+    {
+        const argpar_opt_descr_t descrs[] = {
+            {.id = 0, .long_name = "salt", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+            ARGPAR_OPT_DESCR_SENTINEL};
+
+        test_fail("--salt --no-salt=yes", ARGPAR_ERROR_TYPE_UNEXPECTED_OPT_ARG, 1, NULL, 0, false,
+                  descrs);
+    }
+
+    /* Invalid choice */
+    {
+        const char * const choices[] = {"ctf", "text", NULL};
+        const argpar_opt_descr_t descrs[] = {{.id = 0, .short_name = 'f', .long_name = "format",
+                                              .with_arg = true, .choices = choices},
+                                             ARGPAR_OPT_DESCR_SENTINEL};
+
+        test_fail("--format=ctf salut -fxml", ARGPAR_ERROR_TYPE_INVALID_CHOICE, 2, NULL, 0, true,
+                  descrs);
+    }
+}
+
+/*
+ * Formats `item` and appends the resulting string to `res_str`.
+ *
+ * This function uses the `KEY=` prefix for entries and the `TYPE:VALUE`
+ * form for scalar values, unescaping string values.
+ */
+static void append_kv_item_to_res_str(GString * const res_str, const argpar_kv_item_t * const item)
+{
+    if (res_str->len > 0) {
+        g_string_append_c(res_str, ' ');
+    }
+
+    if (item->key.ptr) {
+        g_string_append_printf(res_str, "%.*s=", (int) item->key.len, item->key.ptr);
+    }
+
+    switch (item->type) {
+    case ARGPAR_KV_ITEM_TYPE_SCALAR:
+        switch (item->scalar_type) {
+        case ARGPAR_KV_SCALAR_TYPE_NULL:
+            g_string_append(res_str, "null");
+            break;
+        case ARGPAR_KV_SCALAR_TYPE_BOOL:
+            g_string_append(res_str, item->bool_val ? "bool:true" : "bool:false");
+            break;
+        case ARGPAR_KV_SCALAR_TYPE_SIGNED_INT:
+            g_string_append_printf(res_str, "sint:%lld", item->int_val);
+            break;
+        case ARGPAR_KV_SCALAR_TYPE_UNSIGNED_INT:
+            g_string_append_printf(res_str, "uint:%llu", item->uint_val);
+            break;
+        case ARGPAR_KV_SCALAR_TYPE_REAL:
+            g_string_append_printf(res_str, "real:%g", item->real_val);
+            break;
+        case ARGPAR_KV_SCALAR_TYPE_STRING:
+        {
+            char * const buf = g_malloc(item->value.len + 1);
+
+            argpar_slice_unescape(item->value, '\\', buf);
+            g_string_append_printf(res_str, "str:%s", buf);
+            g_free(buf);
+            break;
+        }
+        default:
+            abort();
+        }
+
+        break;
+    case ARGPAR_KV_ITEM_TYPE_ARRAY_BEGIN:
+        g_string_append_c(res_str, '[');
+        break;
+    case ARGPAR_KV_ITEM_TYPE_ARRAY_END:
+        g_string_append_c(res_str, ']');
+        break;
+    case ARGPAR_KV_ITEM_TYPE_MAP_BEGIN:
+        g_string_append_c(res_str, '{');
+        break;
+    case ARGPAR_KV_ITEM_TYPE_MAP_END:
+        g_string_append_c(res_str, '}');
+        break;
+    default:
+        abort();
+    }
+}
+
+/*
+ * Iterates the key-value argument `arg` and ensures that the resulting
+ * items are `expected_items` (see append_kv_item_to_res_str()) and, if
+ * `expected_error_offset` is not -1, that argpar_kv_iter_next() fails
+ * at the character offset `expected_error_offset`.
+ */
+static void test_kv(const char * const arg, const char * const expected_items,
+                    const int expected_error_offset)
+{
+    argpar_kv_iter_t iter;
+    argpar_kv_item_t item;
+    argpar_kv_iter_next_status_t status;
+    GString * const res_str = g_string_new(NULL);
+
+    argpar_kv_iter_init(&iter, arg);
+
+    while ((status = argpar_kv_iter_next(&iter, &item)) == ARGPAR_KV_ITER_NEXT_STATUS_OK) {
+        append_kv_item_to_res_str(res_str, &item);
+    }
+
+    if (expected_error_offset < 0) {
+        ok(status == ARGPAR_KV_ITER_NEXT_STATUS_END,
+           "argpar_kv_iter_next() ends successfully for key-value argument `%s`", arg);
+    } else {
+        ok(status == ARGPAR_KV_ITER_NEXT_STATUS_ERROR &&
+               argpar_kv_iter_offset(&iter) == (size_t) expected_error_offset,
+           "argpar_kv_iter_next() fails at the expected offset for key-value argument `%s`",
+           arg);
+
+        if (argpar_kv_iter_offset(&iter) != (size_t) expected_error_offset) {
+            diag("Expected: %d    Got: %zu", expected_error_offset,
+                 argpar_kv_iter_offset(&iter));
+        }
+    }
+
+    ok(argpar_kv_iter_next(&iter, &item) == status,
+       "argpar_kv_iter_next() keeps returning the same status for key-value argument `%s`", arg);
+    ok(strcmp(expected_items, res_str->str) == 0,
+       "argpar_kv_iter_next() returns the expected items for key-value argument `%s`", arg);
+
+    if (strcmp(expected_items, res_str->str) != 0) {
+        diag("Expected: `%s`", expected_items);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    g_string_free(res_str, TRUE);
+}
+
+static void kv_tests(void)
+{
+    test_kv("", "", -1);
+    test_kv("path=\"/x\",begin=12,names=[a,b]",
+            "path=str:/x begin=sint:12 names=[ str:a str:b ]", -1);
+    test_kv("a=null, b = yes ,c=FALSE,d=-0x10,e=+18446744073709551615,f=2.5e3,g=1.2.3",
+            "a=null b=bool:true c=bool:false d=sint:-16 e=uint:18446744073709551615 "
+            "f=real:2500 g=str:1.2.3",
+            -1);
+    test_kv("range={lo=-3,hi=+7.5,sub={}},list=[[1,[]],{k=v},\"q\\\"uo\\\\te\"]",
+            "range={ lo=sint:-3 hi=real:7.5 sub={ } } list=[ [ sint:1 [ ] ] { k=str:v } "
+            "str:q\"uo\\te ]",
+            -1);
+    test_kv("my-key.sub:x=\"\"", "my-key.sub:x=str:", -1);
+    test_kv("a=1,", "a=sint:1", 4);
+    test_kv("a=1 b=2", "a=sint:1", 4);
+    test_kv("a=[1,2", "a=[ sint:1 sint:2", 6);
+    test_kv("a=[1,2},b=3", "a=[ sint:1 sint:2", 6);
+    test_kv("a=\"meow", "", 7);
+    test_kv("=3", "", 0);
+    test_kv("a=[x=3]", "a=[ str:x", 4);
+    test_kv("a=", "", 2);
+    test_kv("a=[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]", "a=[ [ [ [ [ [ [ [ [ [ [ [ [ [ [ [", 18);
+}
+
+/*
+ * Parses the single original argument `orig_arg` with a single option
+ * descriptor having the long name `fields`, the list delimiter
+ * `list_delim`, and the list escape character `list_escape`, and
+ * ensures that the list argument of the resulting option item has
+ * `expected_count` elements and that, once unescaped and joined with
+ * `|`, those are `expected_elems`.
+ */
+static void test_list(const char * const orig_arg, const char list_delim, const char list_escape,
+                      const unsigned int expected_count, const char * const expected_elems)
+{
+    const argpar_opt_descr_t descrs[] = {{.id = 0, .long_name = "fields", .with_arg = true,
+                                          .list_delim = list_delim, .list_escape = list_escape},
+                                         ARGPAR_OPT_DESCR_SENTINEL};
+    argpar_iter_t * const iter = argpar_iter_create(1, &orig_arg, descrs);
+    const argpar_item_t *item = NULL;
+    argpar_iter_next_status_t status;
+    argpar_list_iter_t list_iter;
+    argpar_slice_t elem;
+    GString * const res_str = g_string_new(NULL);
+    unsigned int count = 0;
+
+    assert(iter);
+    status = argpar_iter_next(iter, &item, NULL);
+    assert(status == ARGPAR_ITER_NEXT_STATUS_OK);
+    argpar_item_opt_arg_list_iter_init(item, &list_iter);
+
+    while (argpar_list_iter_next(&list_iter, &elem)) {
+        char * const buf = g_malloc(elem.len + 1);
+
+        if (count > 0) {
+            g_string_append_c(res_str, '|');
+        }
+
+        argpar_slice_unescape(elem, list_escape, buf);
+        g_string_append(res_str, buf);
+        g_free(buf);
+        count++;
+    }
+
+    ok(argpar_item_opt_arg_list_count(item) == expected_count && count == expected_count,
+       "argpar_item_opt_arg_list_count() returns the expected number of elements for `%s`",
+       orig_arg);
+    ok(argpar_item_opt_arg_list_count(item) == expected_count,
+       "argpar_item_opt_arg_list_count() returns the same number of elements again for `%s`",
+       orig_arg);
+    ok(strcmp(expected_elems, res_str->str) == 0,
+       "argpar_list_iter_next() returns the expected elements for `%s`", orig_arg);
+
+    if (strcmp(expected_elems, res_str->str) != 0) {
+        diag("Expected: `%s`", expected_elems);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    g_string_free(res_str, TRUE);
+    argpar_item_destroy(item);
+    argpar_iter_destroy(iter);
+}
+
+static void list_tests(void)
+{
+    test_list("--fields=", ',', '\0', 0, "");
+    test_list("--fields=a", ',', '\0', 1, "a");
+    test_list("--fields=a,b,c", ',', '\0', 3, "a|b|c");
+    test_list("--fields=,a,,b,", ',', '\0', 5, "|a||b|");
+    test_list("--fields=a:b,c", ':', '\0', 2, "a|b,c");
+    test_list("--fields=a\\,b,c\\\\,d\\", ',', '\\', 3, "a,b|c\\|d\\");
+}
+
+/*
+ * Parses `cmdline` with a single option descriptor having the short
+ * name `f`, the long name `format`, and the choices `choices`, and
+ * ensures that:
+ *
+ * • If `expected_suggestion` is `NULL` and `expected_invalid_arg` is
+ *   `NULL`: each option item has the choice index `expected_choice`.
+ *
+ * • Otherwise: argpar_iter_next() fails with an invalid choice error
+ *   for the argument `expected_invalid_arg`, suggesting
+ *   `expected_suggestion` (may be `NULL`).
+ */
+static void test_choice(const char * const cmdline, const char * const * const choices,
+                        const int expected_choice, const char * const expected_invalid_arg,
+                        const char * const expected_suggestion)
+{
+    const argpar_opt_descr_t descrs[] = {{.id = 0, .short_name = 'f', .long_name = "format",
+                                          .with_arg = true, .choices = choices},
+                                         ARGPAR_OPT_DESCR_SENTINEL};
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_iter_t * const iter =
+        argpar_iter_create(g_strv_length(argv), (const char * const *) argv, descrs);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_iter_next_status_t status;
+    bool choices_ok = true;
+
+    assert(iter);
+
+    while ((status = argpar_iter_next(iter, &item, &error)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        if ((int) argpar_item_opt_choice(item) != expected_choice) {
+            choices_ok = false;
+        }
+
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    if (!expected_invalid_arg) {
+        ok(status == ARGPAR_ITER_NEXT_STATUS_END && choices_ok,
+           "argpar_item_opt_choice() returns the expected choice index for command line `%s`",
+           cmdline);
+    } else {
+        ok(status == ARGPAR_ITER_NEXT_STATUS_ERROR &&
+               argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_CHOICE &&
+               strcmp(argpar_error_invalid_choice_arg(error), expected_invalid_arg) == 0,
+           "argpar_iter_next() sets an invalid choice error for command line `%s`", cmdline);
+        ok(status == ARGPAR_ITER_NEXT_STATUS_ERROR &&
+               ((!expected_suggestion && !argpar_error_invalid_choice_suggestion(error)) ||
+                (expected_suggestion && argpar_error_invalid_choice_suggestion(error) &&
+                 strcmp(argpar_error_invalid_choice_suggestion(error), expected_suggestion) ==
+                     0)),
+           "argpar_error_invalid_choice_suggestion() returns the expected suggestion "
+           "for command line `%s`",
+           cmdline);
+    }
+
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+    g_strfreev(argv);
+}
+
+static void choice_tests(void)
+{
+    const char * const formats[] = {"ctf", "text", "json", "dummy", "lttng-live", NULL};
+    const char * const dup_formats[] = {"ctf", "text", "ctf", NULL};
+    const char *many_choices[65];
+    char many_choice_bufs[64][16];
+    unsigned int i;
+
+    test_choice("--format=ctf -fctf --format ctf -f ctf", formats, 0, NULL, NULL);
+    test_choice("--format=lttng-live -flttng-live", formats, 4, NULL, NULL);
+    test_choice("-f ctf --format=ctf", dup_formats, 0, NULL, NULL);
+    test_choice("--format=ctf --format=jsno", formats, 0, "jsno", "json");
+    test_choice("-fdumyy", formats, -1, "dumyy", "dummy");
+    test_choice("--format=xml", formats, -1, "xml", NULL);
+    test_choice("--format=", formats, -1, "", NULL);
+    test_choice("--format=text", dup_formats, 1, NULL, NULL);
+
+    /* Many choices */
+    for (i = 0; i < 64; i++) {
+        sprintf(many_choice_bufs[i], "choice-%u", i * 7);
+        many_choices[i] = many_choice_bufs[i];
+    }
+
+    many_choices[64] = NULL;
+
+    for (i = 0; i < 64; i++) {
+        char cmdline[32];
+
+        sprintf(cmdline, "--format=%s", many_choices[i]);
+        test_choice(cmdline, many_choices, (int) i, NULL, NULL);
+    }
+
+    test_choice("--format=choice-1", many_choices, -1, "choice-1", "choice-0");
+
+    /* Large choice set */
+    {
+        const unsigned int count = 20000;
+        gchar ** const large_choices = g_new0(gchar *, count + 1);
+
+        for (i = 0; i < count; i++) {
+            large_choices[i] = g_strdup_printf("choice-%u", i);
+        }
+
+        test_choice("--format=choice-0", (const char * const *) large_choices, 0, NULL, NULL);
+        test_choice("--format=choice-12345", (const char * const *) large_choices, 12345, NULL,
+                    NULL);
+        test_choice("--format=choice-19999", (const char * const *) large_choices, 19999, NULL,
+                    NULL);
+        test_choice("--format=choice-20000", (const char * const *) large_choices, -1,
+                    "choice-20000", "choice-2000");
+        g_strfreev(large_choices);
+    }
+}
+
+/* Target structure of the argpar_parse_into() tests */
+struct parse_into_config
+{
+    bool color;
+    unsigned int verbosity;
+    unsigned char level;
+    const char *output;
+    int jobs;
+    short offset;
+    unsigned long long size;
+    double ratio;
+    float scale;
+    int format;
+    argpar_arg_list_t includes;
+    argpar_arg_list_t inputs;
+};
+
+/*
+ * Calls argpar_parse_into() with `cmdline` and a set of option
+ * descriptors targeting a `struct parse_into_config` structure,
+ * returning the resulting status and setting `*config` and `*error`.
+ */
+static argpar_parse_into_status_t parse_into(const char * const cmdline,
+                                             struct parse_into_config * const config,
+                                             const argpar_error_t ** const error)
+{
+    static const char * const formats[] = {"ctf", "text", "json", NULL};
+    const argpar_opt_descr_t descrs[] = {
+        {.id = 0, .short_name = 'c', .long_name = "color",
+         .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE,
+         .binding = ARGPAR_BIND_FLAG(struct parse_into_config, color)},
+        {.id = 1, .short_name = 'v', .long_name = "verbose",
+         .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE,
+         .binding = ARGPAR_BIND_COUNTER(struct parse_into_config, verbosity)},
+        {.id = 2, .short_name = 'l',
+         .binding = ARGPAR_BIND_COUNTER(struct parse_into_config, level)},
+        {.id = 3, .short_name = 'o', .long_name = "output", .with_arg = true,
+         .binding = ARGPAR_BIND_STR(struct parse_into_config, output)},
+        {.id = 4, .short_name = 'j', .long_name = "jobs", .with_arg = true,
+         .binding = ARGPAR_BIND_INT(struct parse_into_config, jobs)},
+        {.id = 5, .long_name = "offset", .with_arg = true,
+         .binding = ARGPAR_BIND_INT(struct parse_into_config, offset)},
+        {.id = 6, .long_name = "size", .with_arg = true,
+         .binding = ARGPAR_BIND_UINT(struct parse_into_config, size)},
+        {.id = 7, .long_name = "ratio", .with_arg = true,
+         .binding = ARGPAR_BIND_REAL(struct parse_into_config, ratio)},
+        {.id = 8, .long_name = "scale", .with_arg = true,
+         .binding = ARGPAR_BIND_REAL(struct parse_into_config, scale)},
+        {.id = 9, .short_name = 'f', .long_name = "format", .with_arg = true, .choices = formats,
+         .binding = ARGPAR_BIND_CHOICE(struct parse_into_config, format)},
+        {.id = 10, .short_name = 'I', .with_arg = true,
+         .binding = ARGPAR_BIND_APPEND(struct parse_into_config, includes)},
+        ARGPAR_OPT_DESCR(11, 'q', "quiet", false),
+        ARGPAR_OPT_DESCR_SENTINEL};
+    const argpar_binding_t inputs_binding = ARGPAR_BIND_APPEND(struct parse_into_config, inputs);
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_parse_into_status_t status;
+
+    memset(config, 0, sizeof(*config));
+    config->color = true;
+    config->output = "default";
+    config->jobs = 1;
+    status = argpar_parse_into(g_strv_length(argv), (const char * const *) argv, descrs,
+                               &inputs_binding, config, error);
+
+    /* Keep the arguments alive until the caller is done */
+    g_ptr_array_add(parse_into_argvs, argv);
+    return status;
+}
+
+static void parse_into_tests(void)
+{
+    struct parse_into_config config;
+    const argpar_error_t *error = NULL;
+    argpar_parse_into_status_t status;
+
+    status = parse_into("", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_OK && !error && config.color &&
+           config.verbosity == 0 && strcmp(config.output, "default") == 0 && config.jobs == 1 &&
+           config.includes.count == 0 && config.inputs.count == 0,
+       "argpar_parse_into() keeps the defaults without arguments");
+
+    status = parse_into("-vvv --no-color in1 -o/tmp/a --jobs=-8 -q --offset 0x10 "
+                        "--size=+0xffffffffff --ratio=2.5 --scale 0.25 -fjson -Iinc1 -I inc2 in2 "
+                        "--output=/tmp/b --color --verbose -lll",
+                        &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_OK && !error,
+       "argpar_parse_into() succeeds with all the binding kinds");
+    ok(config.color && config.verbosity == 4 && config.level == 3,
+       "argpar_parse_into() writes the expected flag and counters");
+    ok(strcmp(config.output, "/tmp/b") == 0 && config.jobs == -8 && config.offset == 16 &&
+           config.size == 0xffffffffffULL && config.ratio == 2.5 && config.scale == 0.25f &&
+           config.format == 2,
+       "argpar_parse_into() writes the expected option argument values");
+    ok(config.includes.count == 2 && strcmp(config.includes.args[0], "inc1") == 0 &&
+           strcmp(config.includes.args[1], "inc2") == 0 && config.inputs.count == 2 &&
+           strcmp(config.inputs.args[0], "in1") == 0 && strcmp(config.inputs.args[1], "in2") == 0,
+       "argpar_parse_into() appends the expected arguments");
+    argpar_arg_list_fini(&config.includes);
+    argpar_arg_list_fini(&config.inputs);
+    ok(!config.inputs.args && config.inputs.count == 0 && config.inputs.capacity == 0,
+       "argpar_arg_list_fini() resets the argument list");
+
+    status = parse_into("-vv --no-verbose -v", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_OK && config.verbosity == 1,
+       "argpar_parse_into() resets a counter for a negated option");
+
+    status = parse_into("-v in --offset=40000", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG &&
+           argpar_error_orig_index(error) == 2 &&
+           strcmp(argpar_error_invalid_opt_arg(error), "40000") == 0 &&
+           argpar_error_opt_descr(error, NULL)->id == 5,
+       "argpar_parse_into() fails with an out-of-range signed integer");
+    argpar_error_destroy(error);
+    argpar_arg_list_fini(&config.inputs);
+
+    status = parse_into("-j 12x", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG &&
+           argpar_error_orig_index(error) == 0 &&
+           strcmp(argpar_error_invalid_opt_arg(error), "12x") == 0,
+       "argpar_parse_into() fails with an invalid signed integer");
+    argpar_error_destroy(error);
+
+    status = parse_into("--size=-1", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG,
+       "argpar_parse_into() fails with a negative unsigned integer");
+    argpar_error_destroy(error);
+
+    status = parse_into("--jobs=010 --size=+5", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_OK && config.jobs == 8 && config.size == 5,
+       "argpar_parse_into() converts octal and explicitly positive integers");
+
+    status = parse_into("--jobs=0x-5", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG &&
+           strcmp(argpar_error_invalid_opt_arg(error), "0x-5") == 0 && config.jobs == 1,
+       "argpar_parse_into() fails with a sign after the `0x` prefix");
+    argpar_error_destroy(error);
+
+    status = parse_into("--size=0x+5", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG,
+       "argpar_parse_into() fails with a sign after the `0x` prefix (unsigned)");
+    argpar_error_destroy(error);
+
+    status = parse_into("--ratio=+1.5 --scale=0x1p3", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_OK && config.ratio == 1.5 && config.scale == 8.0f,
+       "argpar_parse_into() converts explicitly positive and hexadecimal real numbers");
+    argpar_error_destroy(error);
+
+    status = parse_into("--scale=1e300", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG &&
+           strcmp(argpar_error_invalid_opt_arg(error), "1e300") == 0 && config.scale == 0.0f,
+       "argpar_parse_into() fails with a real number out of the range of `float`");
+    argpar_error_destroy(error);
+
+    status = parse_into("--ratio=1e300 --scale=-3.5e38", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error && config.ratio == 1e300 &&
+           strcmp(argpar_error_invalid_opt_arg(error), "-3.5e38") == 0,
+       "argpar_parse_into() fails with a negative real number out of the range of `float`");
+    argpar_error_destroy(error);
+
+    status = parse_into("--jobs=\t5", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG && config.jobs == 1,
+       "argpar_parse_into() fails with a signed integer starting with a whitespace");
+    argpar_error_destroy(error);
+
+    status = parse_into("--size=\n5", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG && config.size == 0,
+       "argpar_parse_into() fails with an unsigned integer starting with a whitespace");
+    argpar_error_destroy(error);
+
+    status = parse_into("--ratio=\t2.5", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_OPT_ARG && config.ratio == 0.0,
+       "argpar_parse_into() fails with a real number starting with a whitespace");
+    argpar_error_destroy(error);
+
+    status = parse_into("-f xml", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_INVALID_CHOICE,
+       "argpar_parse_into() fails with an invalid choice");
+    argpar_error_destroy(error);
+
+    status = parse_into("--meow", &config, &error);
+    ok(status == ARGPAR_PARSE_INTO_STATUS_ERROR && error &&
+           argpar_error_type(error) == ARGPAR_ERROR_TYPE_UNKNOWN_OPT,
+       "argpar_parse_into() fails with an unknown option");
+    argpar_error_destroy(error);
+}
+
+/*
+ * Parses `cmdline` with a flag sink using the option descriptors
+ * `descrs`, and ensures that:
+ *
+ * • The resulting effective command line, formatted like
+ *   test_succeed() does, is `expected_cmd_line`.
+ *
+ * • The resulting flag bitset, formatted as a string of `0` and `1`
+ *   characters for the option descriptor IDs 0 to 3, is
+ *   `expected_bits`.
+ *
+ * • The resulting counters, formatted as space-separated decimal
+ *   integers for the option descriptor IDs 0 to 3, are
+ *   `expected_counters`.
+ */
+static void test_flag_sink(const char * const cmdline, const char * const expected_cmd_line,
+                           const char * const expected_bits,
+                           const char * const expected_counters)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+        {.id = 1, .short_name = 'c', .long_name = "color",
+         .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+        ARGPAR_OPT_DESCR(2, 'q', "quiet", false),
+        ARGPAR_OPT_DESCR(3, 'o', "output", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    unsigned char bitset[ARGPAR_FLAG_BITSET_SIZE(4)] = {0};
+    unsigned int counters[4] = {0};
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_iter_t * const iter =
+        argpar_iter_create(g_strv_length(argv), (const char * const *) argv, descrs);
+    GString * const res_str = g_string_new(NULL);
+    GString * const bits_str = g_string_new(NULL);
+    GString * const counters_str = g_string_new(NULL);
+    const argpar_item_t *item = NULL;
+    argpar_iter_next_status_t status;
+    unsigned int i;
+
+    assert(iter);
+    argpar_iter_set_flag_sink(iter, bitset, counters);
+
+    while ((status = argpar_iter_next(iter, &item, NULL)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        append_to_res_str(res_str, item);
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    for (i = 0; i < 4; i++) {
+        g_string_append_c(bits_str, ARGPAR_FLAG_BITSET_IS_SET(bitset, i) ? '1' : '0');
+        g_string_append_printf(counters_str, "%s%u", i > 0 ? " " : "", counters[i]);
+    }
+
+    ok(status == ARGPAR_ITER_NEXT_STATUS_END && strcmp(res_str->str, expected_cmd_line) == 0,
+       "argpar_iter_next() only produces the expected items with a flag sink for command line `%s`",
+       cmdline);
+
+    if (strcmp(res_str->str, expected_cmd_line) != 0) {
+        diag("Expected: `%s`", expected_cmd_line);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    ok(strcmp(bits_str->str, expected_bits) == 0 &&
+           strcmp(counters_str->str, expected_counters) == 0,
+       "argpar_iter_next() fills the flag sink as expected for command line `%s`", cmdline);
+
+    if (strcmp(bits_str->str, expected_bits) != 0 ||
+        strcmp(counters_str->str, expected_counters) != 0) {
+        diag("Expected: `%s` / `%s`", expected_bits, expected_counters);
+        diag("Got:      `%s` / `%s`", bits_str->str, counters_str->str);
+    }
+
+    g_string_free(counters_str, TRUE);
+    g_string_free(bits_str, TRUE);
+    g_string_free(res_str, TRUE);
+    argpar_iter_destroy(iter);
+    g_strfreev(argv);
+}
+
+static void flag_sink_tests(void)
+{
+    test_flag_sink("", "", "0000", "0 0 0 0");
+    test_flag_sink("-vvvcq", "", "1110", "3 1 1 0");
+    test_flag_sink("--verbose -v --color --no-color", "", "1000", "2 0 0 0");
+    test_flag_sink("-vo file hello --quiet -vcofile", "--output=file hello<2,0> --output=file",
+                   "1110", "2 1 1 0");
+    test_flag_sink("--no-color -c", "", "0100", "0 1 0 0");
+    test_flag_sink("-v - -q", "-<1,0>", "1010", "1 0 1 0");
+}
+
+/*
+ * Parses `cmdline` with argpar_parse() using the option descriptors
+ * `descrs`, and ensures that the resulting segmented command line is
+ * `expected_segments`.
+ *
+ * This function formats each segment as its space-separated items
+ * (see append_to_res_str()) between `{` and `}` if it has an opener,
+ * or between `[` and `]` otherwise, and then space-separates the
+ * formatted segments.
+ */
+static void test_parse(const char * const cmdline, const char * const expected_segments,
+                       const argpar_opt_descr_t * const descrs)
+{
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    GString * const res_str = g_string_new(NULL);
+    const argpar_parse_result_t *result = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_parse_status_t status;
+    bool segments_ok = true;
+    unsigned int next_index = 0;
+    unsigned int i;
+
+    status = argpar_parse(g_strv_length(argv), (const char * const *) argv, descrs, 0, &result,
+                          &error);
+    assert(status == ARGPAR_PARSE_STATUS_OK);
+    assert(result);
+    assert(!error);
+
+    for (i = 0; i < argpar_parse_result_segment_count(result); i++) {
+        const argpar_segment_t * const seg = argpar_parse_result_segment(result, i);
+        const bool has_opener = seg->opener_index != ARGPAR_SEGMENT_NO_OPENER;
+        GString * const seg_str = g_string_new(NULL);
+        unsigned int j;
+
+        /* Segments must be contiguous and non-empty */
+        if (seg->first_index != next_index || seg->last_index < seg->first_index ||
+            (has_opener && seg->opener_index != seg->first_index)) {
+            segments_ok = false;
+        }
+
+        for (j = seg->first_index; j <= seg->last_index; j++) {
+            append_to_res_str(seg_str, argpar_parse_result_item(result, j));
+        }
+
+        g_string_append_printf(res_str, "%s%c%s%c", i > 0 ? " " : "", has_opener ? '{' : '[',
+                               seg_str->str, has_opener ? '}' : ']');
+        g_string_free(seg_str, TRUE);
+        next_index = seg->last_index + 1;
+    }
+
+    if (next_index != argpar_parse_result_item_count(result)) {
+        segments_ok = false;
+    }
+
+    ok(segments_ok && strcmp(res_str->str, expected_segments) == 0,
+       "argpar_parse() produces the expected segments for command line `%s`", cmdline);
+
+    if (strcmp(res_str->str, expected_segments) != 0) {
+        diag("Expected: `%s`", expected_segments);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    argpar_parse_result_destroy(result);
+    g_string_free(res_str, TRUE);
+    g_strfreev(argv);
+}
+
+static void parse_tests(void)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+        {.id = 1, .short_name = 'c', .long_name = "component", .with_arg = true,
+         .flags = ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER},
+        ARGPAR_OPT_DESCR(2, 'p', "path", true),
+        {.id = 3, .short_name = 'x', .long_name = "exec",
+         .flags = ARGPAR_OPT_DESCR_FLAG_SCOPE_OPENER},
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+
+    test_parse("", "", descrs);
+    test_parse("-v file", "[--verbose file<1,0>]", descrs);
+    test_parse("--component=src --path=/trace",
+               "{--component=src --path=/trace}", descrs);
+    test_parse("--verbose -c src --path=/trace --component sink -v out",
+               "[--verbose] {--component=src --path=/trace} {--component=sink --verbose out<7,0>}",
+               descrs);
+    test_parse("-vxxv -cs -x", "[--verbose] {--exec} {--exec --verbose} {--component=s} {--exec}",
+               descrs);
+
+    /* Error */
+    {
+        const char * const argv[] = {"-v", "--component"};
+        const argpar_parse_result_t *result = (const argpar_parse_result_t *) descrs;
+        const argpar_error_t *error = NULL;
+        const argpar_parse_status_t status = argpar_parse(2, argv, descrs, 0, &result, &error);
+
+        ok(status == ARGPAR_PARSE_STATUS_ERROR && !result &&
+               argpar_error_type(error) == ARGPAR_ERROR_TYPE_MISSING_OPT_ARG &&
+               argpar_error_orig_index(error) == 1,
+           "argpar_parse() sets a missing option argument error and no result");
+        argpar_error_destroy(error);
+    }
+}
+
+/*
+ * Parses `cmdline` with namespaces, and ensures that the resulting
+ * effective command line is `expected_cmd_line` or, if
+ * `expected_unknown_opt` isn't `NULL`, that parsing fails with an
+ * unknown option error for `expected_unknown_opt`.
+ *
+ * This function formats a namespaced option item as
+ * `--PREFIX.NAME[=ARG]` and other items like append_to_res_str()
+ * does, with the choice index of a choice argument between `#` and
+ * the argument.
+ */
+static void test_namespace(const char * const cmdline, const char * const expected_cmd_line,
+                           const char * const expected_unknown_opt)
+{
+    const char * const formats[] = {"ctf", "text", NULL};
+    const argpar_opt_descr_t main_descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+        ARGPAR_OPT_DESCR(1, '\0', "src.path", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    const argpar_opt_descr_t fs_descrs[] = {
+        ARGPAR_OPT_DESCR(10, 'p', "path", true),
+        {.id = 11, .long_name = "color", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+        {.id = 12, .long_name = "format", .with_arg = true, .choices = formats},
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    const argpar_opt_descr_t text_descrs[] = {
+        ARGPAR_OPT_DESCR(20, '\0', "color", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    const argpar_opt_descr_t src_descrs[] = {
+        ARGPAR_OPT_DESCR(30, '\0', "path", true),
+        ARGPAR_OPT_DESCR(31, '\0', "verbose", false),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_iter_t * const iter =
+        argpar_iter_create(g_strv_length(argv), (const char * const *) argv, main_descrs);
+    GString * const res_str = g_string_new(NULL);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_iter_next_status_t status;
+    argpar_iter_add_namespace_status_t add_ns_status;
+
+    assert(iter);
+    add_ns_status = argpar_iter_add_namespace(iter, "sink.ctf.fs", fs_descrs);
+    assert(add_ns_status == ARGPAR_ITER_ADD_NAMESPACE_STATUS_OK);
+    add_ns_status = argpar_iter_add_namespace(iter, "sink.text", text_descrs);
+    assert(add_ns_status == ARGPAR_ITER_ADD_NAMESPACE_STATUS_OK);
+    add_ns_status = argpar_iter_add_namespace(iter, "src", src_descrs);
+    assert(add_ns_status == ARGPAR_ITER_ADD_NAMESPACE_STATUS_OK);
+
+    while ((status = argpar_iter_next(iter, &item, &error)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        const char * const ns =
+            argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT ? argpar_item_opt_namespace(item) : NULL;
+
+        if (ns) {
+            const char * const arg = argpar_item_opt_arg(item);
+
+            g_string_append_printf(res_str, "%s--%s.%s%s", res_str->len > 0 ? " " : "", ns,
+                                   argpar_item_opt_is_negated(item) ? "no-" : "",
+                                   argpar_item_opt_descr(item)->long_name);
+
+            if (arg) {
+                g_string_append_printf(res_str, "=%s", arg);
+
+                if (argpar_item_opt_descr(item)->choices) {
+                    g_string_append_printf(res_str, "#%u", argpar_item_opt_choice(item));
+                }
+            }
+        } else {
+            append_to_res_str(res_str, item);
+        }
+
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    if (!expected_unknown_opt) {
+        ok(status == ARGPAR_ITER_NEXT_STATUS_END && strcmp(res_str->str, expected_cmd_line) == 0,
+           "argpar_iter_next() routes namespaced options as expected for command line `%s`",
+           cmdline);
+
+        if (strcmp(res_str->str, expected_cmd_line) != 0) {
+            diag("Expected: `%s`", expected_cmd_line);
+            diag("Got:      `%s`", res_str->str);
+        }
+    } else {
+        ok(status == ARGPAR_ITER_NEXT_STATUS_ERROR &&
+               argpar_error_type(error) == ARGPAR_ERROR_TYPE_UNKNOWN_OPT &&
+               strcmp(argpar_error_unknown_opt_name(error), expected_unknown_opt) == 0,
+           "argpar_iter_next() sets an unknown option error for namespaced command line `%s`",
+           cmdline);
+    }
+
+    argpar_error_destroy(error);
+    g_string_free(res_str, TRUE);
+    argpar_iter_destroy(iter);
+    g_strfreev(argv);
+}
+
+static void namespace_tests(void)
+{
+    test_namespace("--sink.ctf.fs.path=/x", "--sink.ctf.fs.path=/x", NULL);
+    test_namespace("--sink.ctf.fs.path /x -v --sink.text.color always",
+                   "--sink.ctf.fs.path=/x --verbose --sink.text.color=always", NULL);
+    test_namespace("--sink.ctf.fs.no-color --sink.ctf.fs.color",
+                   "--sink.ctf.fs.no-color --sink.ctf.fs.color", NULL);
+    test_namespace("--sink.ctf.fs.format=text --src.verbose",
+                   "--sink.ctf.fs.format=text#1 --src.verbose", NULL);
+
+    /* Main option descriptors have precedence */
+    test_namespace("--src.path=/y --src.path /z", "--src.path=/y --src.path=/z", NULL);
+
+    test_namespace("--sink.ctf.fs.nope", NULL, "--sink.ctf.fs.nope");
+    test_namespace("--sink.ctf.path=/x", NULL, "--sink.ctf.path");
+    test_namespace("--sink.text.no-color", NULL, "--sink.text.no-color");
+    test_namespace("--ctf.fs.path", NULL, "--ctf.fs.path");
+}
+
+/*
+ * Parses `cmdline` in stop-at-first-non-option mode using the option
+ * descriptors `descrs`, and ensures that the resulting effective
+ * command line is `expected_cmd_line`, that the iterator ends with
+ * `expected_status`, and that the number of ingested original
+ * arguments is `expected_ingested_orig_args`.
+ */
+static void test_stop_at_non_opt(const char * const cmdline, const char * const expected_cmd_line,
+                                 const argpar_iter_next_status_t expected_status,
+                                 const unsigned int expected_ingested_orig_args)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+        ARGPAR_OPT_DESCR(1, 'o', "output", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_iter_t * const iter =
+        argpar_iter_create(g_strv_length(argv), (const char * const *) argv, descrs);
+    GString * const res_str = g_string_new(NULL);
+    const argpar_item_t *item = NULL;
+    argpar_iter_next_status_t status;
+
+    assert(iter);
+    argpar_iter_set_stop_at_non_opt(iter, true);
+
+    while ((status = argpar_iter_next(iter, &item, NULL)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        append_to_res_str(res_str, item);
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    ok(status == expected_status && strcmp(res_str->str, expected_cmd_line) == 0 &&
+           argpar_iter_ingested_orig_args(iter) == expected_ingested_orig_args &&
+           argpar_iter_next(iter, &item, NULL) == expected_status &&
+           argpar_iter_ingested_orig_args(iter) == expected_ingested_orig_args,
+       "argpar_iter_next() stops as expected at the first non-option argument for command line "
+       "`%s`",
+       cmdline);
+
+    if (strcmp(res_str->str, expected_cmd_line) != 0) {
+        diag("Expected: `%s`", expected_cmd_line);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    g_string_free(res_str, TRUE);
+    argpar_iter_destroy(iter);
+    g_strfreev(argv);
+}
+
+static void stop_at_non_opt_tests(void)
+{
+    test_stop_at_non_opt("", "", ARGPAR_ITER_NEXT_STATUS_END, 0);
+    test_stop_at_non_opt("-v --output=x", "--verbose --output=x", ARGPAR_ITER_NEXT_STATUS_END, 2);
+    test_stop_at_non_opt("-v ls -l --verbose", "--verbose", ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT,
+                         1);
+    test_stop_at_non_opt("-vo file cmd", "--verbose --output=file",
+                         ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT, 2);
+    test_stop_at_non_opt("-v -- -v", "--verbose", ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT, 2);
+    test_stop_at_non_opt("-v --", "--verbose", ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT, 2);
+    test_stop_at_non_opt("- -v", "", ARGPAR_ITER_NEXT_STATUS_END_AT_NON_OPT, 0);
+}
+
+/*
+ * Parses `cmdline` with argpar_parse() and the
+ * `ARGPAR_PARSE_FLAG_PERMUTE` flag using the option descriptors
+ * `descrs`, and ensures that the resulting permuted command line,
+ * formatted like test_succeed() does, is `expected_cmd_line` and that
+ * the number of option items is `expected_opt_count`.
+ */
+static void test_parse_permute(const char * const cmdline, const char * const expected_cmd_line,
+                               const unsigned int expected_opt_count,
+                               const argpar_opt_descr_t * const descrs)
+{
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    GString * const res_str = g_string_new(NULL);
+    const argpar_parse_result_t *result = NULL;
+    argpar_parse_status_t status;
+    unsigned int i;
+
+    status = argpar_parse(g_strv_length(argv), (const char * const *) argv, descrs,
+                          ARGPAR_PARSE_FLAG_PERMUTE, &result, NULL);
+    assert(status == ARGPAR_PARSE_STATUS_OK);
+
+    for (i = 0; i < argpar_parse_result_item_count(result); i++) {
+        append_to_res_str(res_str, argpar_parse_result_permuted_item(result, i));
+    }
+
+    ok(strcmp(res_str->str, expected_cmd_line) == 0 &&
+           argpar_parse_result_opt_count(result) == expected_opt_count,
+       "argpar_parse() produces the expected permutation for command line `%s`", cmdline);
+
+    if (strcmp(res_str->str, expected_cmd_line) != 0) {
+        diag("Expected: `%s`", expected_cmd_line);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    argpar_parse_result_destroy(result);
+    g_string_free(res_str, TRUE);
+    g_strfreev(argv);
+}
+
+static void parse_permute_tests(void)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+        ARGPAR_OPT_DESCR(1, 'o', "output", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+
+    test_parse_permute("", "", 0, descrs);
+    test_parse_permute("a b", "a<0,0> b<1,1>", 0, descrs);
+    test_parse_permute("-v -o x", "--verbose --output=x", 2, descrs);
+    test_parse_permute("a -v b --output x c -vo y d",
+                       "--verbose --output=x --verbose --output=y a<0,0> b<2,1> c<5,2> d<8,3>", 4,
+                       descrs);
+
+    /* Item array growth: more items than original arguments */
+    test_parse_permute("-vvvv a -vv b", "--verbose --verbose --verbose --verbose --verbose "
+                                        "--verbose a<1,0> b<3,1>",
+                       6, descrs);
+}
+
+/*
+ * Returns the sum of the bucket counts of the latency histogram path
+ * statistics `stats`.
+ */
+static unsigned long long
+histogram_bucket_sum(const argpar_histogram_path_stats_t * const stats)
+{
+    unsigned long long sum = 0;
+    unsigned int i;
+
+    for (i = 0; i < ARGPAR_HISTOGRAM_BUCKET_COUNT; i++) {
+        sum += stats->buckets[i];
+    }
+
+    return sum;
+}
+
+static void histogram_tests(void)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'a', NULL, false),
+        ARGPAR_OPT_DESCR(1, 'b', NULL, false),
+        ARGPAR_OPT_DESCR(2, 'o', "output", true),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    const char * const argv[] = {"-ab", "--output=x", "file", "--meow"};
+    argpar_iter_t * const iter = argpar_iter_create(4, argv, descrs);
+    const argpar_histogram_t *histogram;
+    const argpar_item_t *item = NULL;
+
+    assert(iter);
+
+    while (argpar_iter_next(iter, &item, NULL) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    histogram = argpar_iter_get_histogram(iter);
+
+#ifdef ARGPAR_ENABLE_HISTOGRAM
+    ok(histogram && histogram->paths[ARGPAR_HISTOGRAM_PATH_NON_OPT].call_count == 1 &&
+           histogram->paths[ARGPAR_HISTOGRAM_PATH_SHORT_OPT].call_count == 2 &&
+           histogram->paths[ARGPAR_HISTOGRAM_PATH_LONG_OPT].call_count == 1 &&
+           histogram->paths[ARGPAR_HISTOGRAM_PATH_ERROR].call_count == 1,
+       "argpar_iter_get_histogram() counts the calls per path");
+
+    {
+        bool buckets_ok = true;
+        unsigned int path;
+
+        for (path = 0; path < ARGPAR_HISTOGRAM_PATH_COUNT; path++) {
+            const argpar_histogram_path_stats_t * const stats = &histogram->paths[path];
+
+            if (histogram_bucket_sum(stats) != stats->call_count ||
+                stats->max > stats->total) {
+                buckets_ok = false;
+            }
+        }
+
+        ok(buckets_ok, "argpar_iter_get_histogram() has consistent buckets");
+    }
+
+    argpar_histogram_print(histogram, stderr);
+#else
+    ok(!histogram, "argpar_iter_get_histogram() returns `NULL` without histogram support");
+    skip(1, "Histogram buckets require histogram support");
+    (void) histogram_bucket_sum;
+#endif
+
+    argpar_iter_destroy(iter);
+}
+
+/* Option descriptors of the descriptor image tests */
+static const char * const image_test_formats[] = {"ctf", "text", "json", NULL};
+static const char * const image_test_no_choices[] = {NULL};
+static const argpar_opt_descr_t image_test_descrs[] = {
+    ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+    ARGPAR_OPT_DESCR(1, 'o', "output", true),
+    {.id = 2, .long_name = "color", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+    {.id = 3, .short_name = 'f', .long_name = "format", .with_arg = true,
+     .choices = image_test_formats},
+    {.id = 4, .long_name = "fields", .with_arg = true, .list_delim = ',', .list_escape = '\\'},
+    {.id = 5, .long_name = "none", .with_arg = true, .choices = image_test_no_choices},
+    ARGPAR_OPT_DESCR(6, 'v', "verbose", true),
+    ARGPAR_OPT_DESCR(7, 'x', NULL, false),
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+
+/*
+ * Parses `cmdline` with an iterator created from the descriptor image
+ * `image` or, if it's `NULL`, from `image_test_descrs`, returning the
+ * formatted items (see append_to_res_str()), each one followed with its
+ * descriptor ID and, if any, its choice index, and ending with the
+ * formatted error, if any.
+ */
+static GString *parse_with(const char * const cmdline, const argpar_descr_image_t * const image)
+{
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_iter_t * const iter =
+        image ? argpar_iter_create_with_image(g_strv_length(argv), (const char * const *) argv,
+                                              image) :
+                argpar_iter_create(g_strv_length(argv), (const char * const *) argv,
+                                   image_test_descrs);
+    GString * const res_str = g_string_new(NULL);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_iter_next_status_t status;
+
+    assert(iter);
+
+    while ((status = argpar_iter_next(iter, &item, &error)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        append_to_res_str(res_str, item);
+
+        if (argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT) {
+            g_string_append_printf(res_str, "#%d", argpar_item_opt_descr(item)->id);
+
+            if (argpar_item_opt_descr(item)->choices) {
+                g_string_append_printf(res_str, "/%u", argpar_item_opt_choice(item));
+            }
+        }
+
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    if (status == ARGPAR_ITER_NEXT_STATUS_ERROR) {
+        g_string_append_printf(res_str, " !%d@%u:", (int) argpar_error_type(error),
+                               argpar_error_orig_index(error));
+
+        if (argpar_error_type(error) == ARGPAR_ERROR_TYPE_UNKNOWN_OPT) {
+            g_string_append(res_str, argpar_error_unknown_opt_name(error));
+        } else {
+            g_string_append_printf(res_str, "#%d", argpar_error_opt_descr(error, NULL)->id);
+        }
+    }
+
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+    g_strfreev(argv);
+    return res_str;
+}
+
+/*
+ * Ensures that parsing `cmdline` with the descriptor image `image`
+ * produces the same items and error as with the descriptors which
+ * `image` was written from.
+ */
+static void test_image(const char * const cmdline, const argpar_descr_image_t * const image)
+{
+    GString * const expected_str = parse_with(cmdline, NULL);
+    GString * const res_str = parse_with(cmdline, image);
+
+    ok(strcmp(res_str->str, expected_str->str) == 0,
+       "argpar_iter_create_with_image() parses command line `%s` like argpar_iter_create()",
+       cmdline);
+
+    if (strcmp(res_str->str, expected_str->str) != 0) {
+        diag("Expected: `%s`", expected_str->str);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    g_string_free(expected_str, TRUE);
+    g_string_free(res_str, TRUE);
+}
+
+/*
+ * Returns a new buffer containing the descriptor image of
+ * `image_test_descrs` with the key `key`, setting `*size` to its size.
+ */
+static char *write_test_image(const unsigned long long key, size_t * const size)
+{
+    char *buf;
+    size_t written_size;
+
+    *size = argpar_descr_image_write(image_test_descrs, key, NULL, 0);
+    assert(*size > 0 && *size % 8 == 0);
+    buf = g_malloc(*size);
+    written_size = argpar_descr_image_write(image_test_descrs, key, buf, *size);
+    assert(written_size == *size);
+    return buf;
+}
+
+/*
+ * Header of a descriptor image, mirroring `struct image_header` of
+ * `argpar.c`, for the tests which forge images.
+ */
+struct test_image_header
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int byte_order;
+    unsigned long long key;
+    unsigned long long checksum;
+    unsigned int size;
+    unsigned int descr_count;
+    unsigned int long_name_mask;
+    unsigned int pool_len;
+    unsigned int strings_size;
+    unsigned int record_size;
+};
+
+/*
+ * Returns the checksum of the `size` bytes of `data` following the
+ * header of a descriptor image, like image_checksum() of `argpar.c`.
+ */
+static unsigned long long test_image_checksum(const char * const data, const size_t size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    size_t i;
+
+    for (i = 0; i < size; i += 8) {
+        unsigned long long word;
+
+        memcpy(&word, &data[i], sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * Returns the status of argpar_descr_image_open() for `data` (`size`
+ * bytes) and the key `key`, also ensuring that it sets its image
+ * parameter to `NULL` on failure.
+ */
+static argpar_descr_image_open_status_t open_status(const char * const data, const size_t size,
+                                                    const unsigned long long key)
+{
+    const argpar_descr_image_t *image = NULL;
+    const argpar_descr_image_open_status_t status =
+        argpar_descr_image_open(data, size, key, NULL, &image);
+
+    assert((status == ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK) == (image != NULL));
+    argpar_descr_image_destroy(image);
+    return status;
+}
+
+static void image_tests(void)
+{
+    size_t size;
+    char * const data = write_test_image(0xc0ffee, &size);
+    char * const copy = g_malloc(size + 8);
+    const argpar_descr_image_t *image = NULL;
+
+    ok(argpar_descr_image_open(data, size, 0xc0ffee, NULL, &image) ==
+           ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK,
+       "argpar_descr_image_open() loads an image written by argpar_descr_image_write()");
+    assert(image);
+
+    {
+        const argpar_opt_descr_t * const descrs = argpar_descr_image_descrs(image);
+        bool descrs_ok = true;
+        unsigned int i;
+
+        for (i = 0; image_test_descrs[i].short_name || image_test_descrs[i].long_name; i++) {
+            const argpar_opt_descr_t * const expected = &image_test_descrs[i];
+            const argpar_opt_descr_t * const descr = &descrs[i];
+
+            if (descr->id != expected->id || descr->short_name != expected->short_name ||
+                (!descr->long_name) != (!expected->long_name) ||
+                (descr->long_name && strcmp(descr->long_name, expected->long_name) != 0) ||
+                descr->with_arg != expected->with_arg || descr->flags != expected->flags ||
+                descr->list_delim != expected->list_delim ||
+                descr->list_escape != expected->list_escape ||
+                (!descr->choices) != (!expected->choices)) {
+                descrs_ok = false;
+            }
+        }
+
+        ok(descrs_ok && !descrs[i].short_name && !descrs[i].long_name &&
+               strcmp(descrs[3].choices[2], "json") == 0 && !descrs[3].choices[3] &&
+               !descrs[5].choices[0],
+           "argpar_descr_image_descrs() returns the written option descriptors");
+    }
+
+    test_image("-v --output=/x file -fjson --no-color", image);
+    test_image("--fields=a,b\\,c -xvo /y --format ctf -- --color", image);
+    test_image("--verbose --format=xml", image);
+    test_image("--none=a", image);
+    test_image("-vz", image);
+    test_image("--meow=mix", image);
+    test_image("--no-verbose", image);
+    test_image("file --output", image);
+    argpar_descr_image_destroy(image);
+
+    ok(open_status(data, size, 0xdecaf) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_STALE,
+       "argpar_descr_image_open() reports an image having another key as stale");
+
+    memcpy(copy, data, size);
+    copy[8]++;
+    ok(open_status(copy, size, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_STALE,
+       "argpar_descr_image_open() reports an image having another version as stale");
+
+    memcpy(copy, data, size);
+    copy[size - 12] ^= 0x20;
+    ok(open_status(copy, size, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID,
+       "argpar_descr_image_open() reports a corrupted image as invalid");
+
+    ok(open_status(data, size - 8, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID &&
+           open_status(data, 16, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID,
+       "argpar_descr_image_open() reports a truncated image as invalid");
+
+    memcpy(copy, data, size);
+    copy[0] = 'X';
+    ok(open_status(copy, size, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID,
+       "argpar_descr_image_open() reports data which isn't an image as invalid");
+
+    memmove(copy + 4, data, size);
+    ok(open_status(copy + 4, size, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID,
+       "argpar_descr_image_open() reports misaligned image data as invalid");
+
+    /* Forged image with a valid checksum but without an empty slot */
+    {
+        const argpar_opt_descr_t two_descrs[] = {
+            ARGPAR_OPT_DESCR(0, '\0', "alpha", false),
+            ARGPAR_OPT_DESCR(1, '\0', "beta", false),
+            ARGPAR_OPT_DESCR_SENTINEL,
+        };
+        const size_t forged_size = argpar_descr_image_write(two_descrs, 0xc0ffee, NULL, 0);
+        char * const forged = g_malloc(forged_size);
+        struct test_image_header header;
+        int *long_name_slots;
+        unsigned int i;
+        size_t written_size;
+
+        written_size = argpar_descr_image_write(two_descrs, 0xc0ffee, forged, forged_size);
+        assert(written_size == forged_size);
+        memcpy(&header, forged, sizeof(header));
+        assert(header.descr_count == 2 && header.long_name_mask == 3);
+        long_name_slots = (int *) &forged[sizeof(header) + header.descr_count * header.record_size];
+
+        for (i = 0; i <= header.long_name_mask; i++) {
+            long_name_slots[i] = 0;
+        }
+
+        header.checksum =
+            test_image_checksum(&forged[sizeof(header)], forged_size - sizeof(header));
+        memcpy(forged, &header, sizeof(header));
+        ok(open_status(forged, forged_size, 0xc0ffee) == ARGPAR_DESCR_IMAGE_OPEN_STATUS_INVALID,
+           "argpar_descr_image_open() reports an image having a full long name hash table as "
+           "invalid");
+        g_free(forged);
+    }
+
+    memset(copy, 0x55, size);
+    ok(argpar_descr_image_write(image_test_descrs, 0xc0ffee, copy, size - 8) == size &&
+           copy[0] == 0x55 && copy[size - 9] == 0x55,
+       "argpar_descr_image_write() doesn't write to a buffer which is too small");
+
+    g_free(copy);
+    g_free(data);
+}
+
+/*
+ * Formats the items of `reparser` (see append_to_res_str()) into
+ * `res_str`, followed with the formatted error `error`, if any.
+ */
+static void append_reparse_res(GString * const res_str, const argpar_reparser_t * const reparser,
+                               const argpar_error_t * const error)
+{
+    unsigned int i;
+
+    for (i = 0; i < argpar_reparser_item_count(reparser); i++) {
+        append_to_res_str(res_str, argpar_reparser_item(reparser, i));
+    }
+
+    if (error) {
+        g_string_append_printf(res_str, " !%d@%u", (int) argpar_error_type(error),
+                               argpar_error_orig_index(error));
+    }
+}
+
+/*
+ * Parses `cmdline` with `reparser`, and ensures that the result is the
+ * same as with a new reparser and that `reparser` reused
+ * `expected_reused` original arguments.
+ *
+ * This function frees the original arguments before checking the
+ * items of `reparser`.
+ */
+static void test_reparse(argpar_reparser_t * const reparser, const char * const cmdline,
+                         const unsigned int expected_reused,
+                         const argpar_opt_descr_t * const descrs)
+{
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_reparser_t * const fresh_reparser = argpar_reparser_create(descrs);
+    GString * const res_str = g_string_new(NULL);
+    GString * const expected_str = g_string_new(NULL);
+    const argpar_error_t *error = NULL;
+    const argpar_error_t *fresh_error = NULL;
+    argpar_parse_status_t status;
+    argpar_parse_status_t fresh_status;
+
+    assert(fresh_reparser);
+    status = argpar_reparser_parse(reparser, g_strv_length(argv), (const char * const *) argv,
+                                   &error);
+    fresh_status = argpar_reparser_parse(fresh_reparser, g_strv_length(argv),
+                                         (const char * const *) argv, &fresh_error);
+    g_strfreev(argv);
+    append_reparse_res(res_str, reparser, error);
+    append_reparse_res(expected_str, fresh_reparser, fresh_error);
+    ok(status == fresh_status && strcmp(res_str->str, expected_str->str) == 0 &&
+           argpar_reparser_reused_orig_args(reparser) == expected_reused &&
+           argpar_reparser_reused_orig_args(fresh_reparser) == 0,
+       "argpar_reparser_parse() reparses command line `%s` reusing %u original arguments",
+       cmdline, expected_reused);
+
+    if (strcmp(res_str->str, expected_str->str) != 0) {
+        diag("Expected: `%s`", expected_str->str);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    if (argpar_reparser_reused_orig_args(reparser) != expected_reused) {
+        diag("Reused %u original arguments", argpar_reparser_reused_orig_args(reparser));
+    }
+
+    argpar_error_destroy(error);
+    argpar_error_destroy(fresh_error);
+    g_string_free(res_str, TRUE);
+    g_string_free(expected_str, TRUE);
+    argpar_reparser_destroy(fresh_reparser);
+}
+
+static void reparser_tests(void)
+{
+    const char * const formats[] = {"ctf", "text", NULL};
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'v', "verbose", false),
+        ARGPAR_OPT_DESCR(1, 'o', "output", true),
+        {.id = 2, .short_name = 'f', .long_name = "format", .with_arg = true, .choices = formats},
+        ARGPAR_OPT_DESCR(3, 'x', NULL, false),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    argpar_reparser_t * const reparser = argpar_reparser_create(descrs);
+    const argpar_item_t *item;
+
+    assert(reparser);
+
+    /* Typing a command line, argument by argument */
+    test_reparse(reparser, "-v", 0, descrs);
+    test_reparse(reparser, "-v --out", 1, descrs);
+    test_reparse(reparser, "-v --output", 1, descrs);
+    test_reparse(reparser, "-v --output /x", 1, descrs);
+    test_reparse(reparser, "-v --output /x file", 3, descrs);
+    test_reparse(reparser, "-v --output /x file -vx", 4, descrs);
+    test_reparse(reparser, "-v --output /x file -vx other", 5, descrs);
+
+    /* Editing the argument of an option resumes from the option */
+    test_reparse(reparser, "-v --output /y file -vx other", 1, descrs);
+
+    /* Same command line */
+    test_reparse(reparser, "-v --output /y file -vx other", 6, descrs);
+
+    /* Removing and editing trailing arguments */
+    test_reparse(reparser, "-v --output /y", 3, descrs);
+    test_reparse(reparser, "-v --output /y -f", 3, descrs);
+    test_reparse(reparser, "-v --output /y -f xml", 3, descrs);
+    test_reparse(reparser, "-v --output /y -f text", 3, descrs);
+    test_reparse(reparser, "-x --output /y -f text", 0, descrs);
+
+    item = argpar_reparser_item(reparser, 2);
+    ok(argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT && argpar_item_opt_choice(item) == 1 &&
+           strcmp(argpar_item_opt_arg(item), "text") == 0,
+       "argpar_reparser_item() returns the expected item");
+
+    argpar_reparser_destroy(reparser);
+}
+
+/*
+ * Parses `cmdline` with `descrs` and the lookup strategy `strategy`,
+ * with or without a lookup cache depending on `lookup_cache`, and
+ * returns the formatted items (see append_to_res_str()), each one
+ * followed with its descriptor ID, and ending with the formatted error,
+ * if any.
+ */
+static GString *parse_with_lookup_cache(const char * const cmdline,
+                                        const argpar_opt_descr_t * const descrs,
+                                        const bool lookup_cache,
+                                        const argpar_lookup_strategy_t strategy)
+{
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_iter_t * const iter =
+        argpar_iter_create(g_strv_length(argv), (const char * const *) argv, descrs);
+    GString * const res_str = g_string_new(NULL);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+    argpar_iter_next_status_t status;
+    argpar_iter_set_lookup_strategy_status_t set_strategy_status;
+
+    assert(iter);
+    argpar_iter_set_lookup_cache(iter, lookup_cache);
+    set_strategy_status = argpar_iter_set_lookup_strategy(iter, strategy);
+    assert(set_strategy_status == ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK);
+
+    while ((status = argpar_iter_next(iter, &item, &error)) == ARGPAR_ITER_NEXT_STATUS_OK) {
+        append_to_res_str(res_str, item);
+
+        if (argpar_item_type(item) == ARGPAR_ITEM_TYPE_OPT) {
+            g_string_append_printf(res_str, "#%d", argpar_item_opt_descr(item)->id);
+        }
+
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    if (status == ARGPAR_ITER_NEXT_STATUS_ERROR) {
+        g_string_append_printf(res_str, " !%d@%u", (int) argpar_error_type(error),
+                               argpar_error_orig_index(error));
+    }
+
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+    g_strfreev(argv);
+    return res_str;
+}
+
+/*
+ * Ensures that parsing `cmdline` with a lookup cache produces the same
+ * items and error as without it.
+ */
+static void test_lookup_cache(const char * const cmdline)
+{
+    const argpar_opt_descr_t descrs[] = {
+        ARGPAR_OPT_DESCR(0, 'a', "alpha", false),
+        ARGPAR_OPT_DESCR(1, 'b', "bravo", false),
+        ARGPAR_OPT_DESCR(2, 'c', "charlie", false),
+        ARGPAR_OPT_DESCR(3, 'd', "delta", false),
+        ARGPAR_OPT_DESCR(4, 'e', "echo", false),
+        ARGPAR_OPT_DESCR(5, 'f', "foxtrot", false),
+        ARGPAR_OPT_DESCR(6, 'g', "golf", false),
+        ARGPAR_OPT_DESCR(7, 'h', "hotel", false),
+        ARGPAR_OPT_DESCR(8, 'i', "india", false),
+        ARGPAR_OPT_DESCR(9, 'p', "params", true),
+        {.id = 10, .long_name = "color", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+
+        /* Duplicates: never found */
+        ARGPAR_OPT_DESCR(11, 'a', "params", false),
+        ARGPAR_OPT_DESCR(12, 'p', "alpha", true),
+
+        /* Same short name as the long name lookups above */
+        ARGPAR_OPT_DESCR(13, 'v', "verbose", false),
+        ARGPAR_OPT_DESCR(14, 'q', "v", false),
+        ARGPAR_OPT_DESCR_SENTINEL,
+    };
+    GString * const expected_str =
+        parse_with_lookup_cache(cmdline, descrs, false, ARGPAR_LOOKUP_STRATEGY_SCAN);
+    GString * const res_str =
+        parse_with_lookup_cache(cmdline, descrs, true, ARGPAR_LOOKUP_STRATEGY_SCAN);
+
+    ok(strcmp(res_str->str, expected_str->str) == 0,
+       "argpar_iter_set_lookup_cache() keeps the items of command line `%s`", cmdline);
+
+    if (strcmp(res_str->str, expected_str->str) != 0) {
+        diag("Expected: `%s`", expected_str->str);
+        diag("Got:      `%s`", res_str->str);
+    }
+
+    g_string_free(expected_str, TRUE);
+    g_string_free(res_str, TRUE);
+}
+
+static void lookup_cache_tests(void)
+{
+    test_lookup_cache("-v --params=1 -v --params 2 -vv -p3 --params=4");
+    test_lookup_cache("-a --alpha -p x --params y -a --alpha");
+    test_lookup_cache("--v -v --verbose --v -qv --v");
+    test_lookup_cache("--color --no-color --color --no-color");
+
+    /* More distinct options than cache entries */
+    test_lookup_cache("-abcdefghi --india --hotel -a --alpha -i -abcdefghi -p z --golf");
+    test_lookup_cache("-abcdefghi -a --alpha --zulu");
+    test_lookup_cache("-abcdefghiz");
+}
+
+/*
+ * Option descriptors of which the long option names exercise the
+ * fingerprint lookup strategy: up to two full fingerprint blocks and a
+ * partial one, names shorter than, as long as, and longer than eight
+ * bytes, sharing their first eight bytes, and duplicates.
+ */
+static const argpar_opt_descr_t lookup_test_descrs[] = {
+    /* First block */
+    ARGPAR_OPT_DESCR(0, 'a', "a", false),
+    ARGPAR_OPT_DESCR(1, 'b', "abcdefgh", false),
+    ARGPAR_OPT_DESCR(2, 'c', "abcdefghi", false),
+    ARGPAR_OPT_DESCR(3, 'd', "abcdefghij", true),
+    ARGPAR_OPT_DESCR(4, 'e', "abcdefghik", true),
+    ARGPAR_OPT_DESCR(5, '\0', "abcdefg", false),
+    ARGPAR_OPT_DESCR(6, 'f', NULL, false),
+    {.id = 7, .long_name = "color", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+    ARGPAR_OPT_DESCR(8, 'g', "golf", false),
+    ARGPAR_OPT_DESCR(9, 'h', "hotel", false),
+    ARGPAR_OPT_DESCR(10, 'i', "india", false),
+    ARGPAR_OPT_DESCR(11, 'j', "juliett", false),
+    ARGPAR_OPT_DESCR(12, 'k', "kilo", false),
+    ARGPAR_OPT_DESCR(13, 'l', "lima", false),
+    ARGPAR_OPT_DESCR(14, 'm', "mike", false),
+    ARGPAR_OPT_DESCR(15, 'n', "november", false),
+
+    /* Second block: duplicates are never found */
+    ARGPAR_OPT_DESCR(16, 'a', "abcdefghij", false),
+    ARGPAR_OPT_DESCR(17, 'b', "abcdefgh", false),
+    ARGPAR_OPT_DESCR(18, 'o', "oscar", false),
+    ARGPAR_OPT_DESCR(19, 'p', "papa", false),
+    ARGPAR_OPT_DESCR(20, 'q', "quebec", false),
+    ARGPAR_OPT_DESCR(21, 'r', "romeo", false),
+    ARGPAR_OPT_DESCR(22, 's', "sierra", false),
+    ARGPAR_OPT_DESCR(23, 't', "tango", false),
+    ARGPAR_OPT_DESCR(24, 'u', "uniform", false),
+    ARGPAR_OPT_DESCR(25, 'v', "victor", false),
+    ARGPAR_OPT_DESCR(26, 'w', "whiskey", false),
+    ARGPAR_OPT_DESCR(27, 'x', "x-ray", false),
+    ARGPAR_OPT_DESCR(28, 'y', "yankee", false),
+    ARGPAR_OPT_DESCR(29, 'z', "zulu", false),
+    ARGPAR_OPT_DESCR(30, 'A', "alfa", false),
+    ARGPAR_OPT_DESCR(31, 'B', "bravo", false),
+
+    /* Partial block */
+    ARGPAR_OPT_DESCR(32, 'C', "abcdefghijklmnop", true),
+    ARGPAR_OPT_DESCR(33, 'D', "abcdefghijklmnoq", true),
+    ARGPAR_OPT_DESCR(34, 'f', "foxtrot", false),
+    ARGPAR_OPT_DESCR(35, 'E', "echo", false),
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+
+/* Names of the lookup strategies, indexed by `argpar_lookup_strategy_t` */
+static const char * const lookup_strategy_names[] = {
+    "auto",
+    "scan",
+    "fingerprint",
+    "hash",
+};
+
+/*
+ * Ensures that parsing `cmdline` with `lookup_test_descrs` produces
+ * the formatted items and error `expected` (see
+ * parse_with_lookup_cache()) with each lookup strategy.
+ */
+static void test_lookup_strategies(const char * const cmdline, const char * const expected)
+{
+    unsigned int strategy;
+
+    for (strategy = ARGPAR_LOOKUP_STRATEGY_AUTO; strategy <= ARGPAR_LOOKUP_STRATEGY_HASH;
+         strategy++) {
+        GString * const res_str = parse_with_lookup_cache(cmdline, lookup_test_descrs, false,
+                                                          (argpar_lookup_strategy_t) strategy);
+
+
+        ok(strcmp(res_str->str, expected) == 0,
+           "Lookup strategy `%s` gives the expected items for command line `%s`",
+           lookup_strategy_names[strategy], cmdline);
+
+        if (strcmp(res_str->str, expected) != 0) {
+            diag("Expected: `%s`", expected);
+            diag("Got:      `%s`", res_str->str);
+        }
+
+        g_string_free(res_str, TRUE);
+    }
+}
+
+/*
+ * Ensures that argpar_iter_create() selects the lookup strategy
+ * `expected` for `count` generated option descriptors of which the
+ * long option names have the prefix `prefix`, and that
+ * argpar_iter_set_lookup_strategy() overrides it.
+ */
+static void test_auto_lookup_strategy(const unsigned int count, const char * const prefix,
+                                      const argpar_lookup_strategy_t expected)
+{
+    argpar_opt_descr_t * const descrs = g_new0(argpar_opt_descr_t, count + 1);
+    char ** const long_names = g_new0(char *, count + 1);
+    const char * const argv[] = {"--x", "-a"};
+    const argpar_item_t *item = NULL;
+    argpar_iter_t *iter;
+    argpar_iter_set_lookup_strategy_status_t set_strategy_status;
+    unsigned int i;
+
+    for (i = 0; i < count; i++) {
+        long_names[i] = g_strdup_printf("%s%u", prefix, i);
+
+        {
+            const argpar_opt_descr_t descr =
+                ARGPAR_OPT_DESCR((int) i, (char) ('a' + i % 26), long_names[i], false);
+
+            /* Option descriptor members are `const` */
+            memcpy(&descrs[i], &descr, sizeof(descr));
+        }
+    }
+
+    iter = argpar_iter_create(2, argv, descrs);
+    assert(iter);
+    ok(argpar_iter_lookup_strategy(iter) == expected,
+       "argpar_iter_create() selects the lookup strategy `%s` for %u option descriptors "
+       "named `%s*`",
+       lookup_strategy_names[expected], count, prefix);
+
+    set_strategy_status = argpar_iter_set_lookup_strategy(iter, ARGPAR_LOOKUP_STRATEGY_FINGERPRINT);
+    assert(set_strategy_status == ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK);
+    ok(argpar_iter_lookup_strategy(iter) == ARGPAR_LOOKUP_STRATEGY_FINGERPRINT &&
+           argpar_iter_next(iter, &item, NULL) == ARGPAR_ITER_NEXT_STATUS_ERROR,
+       "argpar_iter_set_lookup_strategy() overrides the lookup strategy");
+
+    set_strategy_status = argpar_iter_set_lookup_strategy(iter, ARGPAR_LOOKUP_STRATEGY_HASH);
+    assert(set_strategy_status == ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK);
+    set_strategy_status = argpar_iter_set_lookup_strategy(iter, ARGPAR_LOOKUP_STRATEGY_AUTO);
+    assert(set_strategy_status == ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK);
+    ok(argpar_iter_lookup_strategy(iter) == expected,
+       "argpar_iter_set_lookup_strategy() selects the same lookup strategy with "
+       "`ARGPAR_LOOKUP_STRATEGY_AUTO`");
+
+    argpar_iter_destroy(iter);
+    g_strfreev(long_names);
+    g_free(descrs);
+}
+
+static void lookup_strategy_tests(void)
+{
+    test_lookup_strategies("--a --abcdefgh --abcdefg --abcdefghi",
+                           "--a#0 --abcdefgh#1 --abcdefg#5 --abcdefghi#2");
+    test_lookup_strategies("--abcdefghij=1 --abcdefghik 2 -d3 -e 4",
+                           "--abcdefghij=1#3 --abcdefghik=2#4 --abcdefghij=3#3 --abcdefghik=4#4");
+    test_lookup_strategies("-abf -AB -E",
+                           "--a#0 --abcdefgh#1 -f#6 --alfa#30 --bravo#31 --echo#35");
+    test_lookup_strategies("--abcdefghijklmnop=x --abcdefghijklmnoq y -C z",
+                           "--abcdefghijklmnop=x#32 --abcdefghijklmnoq=y#33 "
+                           "--abcdefghijklmnop=z#32");
+    test_lookup_strategies("--no-color --foxtrot --zulu --echo",
+                           "--no-color#7 --foxtrot#34 --zulu#29 --echo#35");
+    test_lookup_strategies("--abcdefghijklmnor", " !0@0");
+    test_lookup_strategies("--abcdefghijk", " !0@0");
+    test_lookup_strategies("--ab", " !0@0");
+    test_lookup_strategies("-F", " !0@0");
+
+    test_auto_lookup_strategy(1, "opt-", ARGPAR_LOOKUP_STRATEGY_SCAN);
+    test_auto_lookup_strategy(23, "opt-", ARGPAR_LOOKUP_STRATEGY_SCAN);
+    test_auto_lookup_strategy(24, "opt-", ARGPAR_LOOKUP_STRATEGY_FINGERPRINT);
+    test_auto_lookup_strategy(63, "opt-", ARGPAR_LOOKUP_STRATEGY_FINGERPRINT);
+    test_auto_lookup_strategy(32, "component-", ARGPAR_LOOKUP_STRATEGY_HASH);
+    test_auto_lookup_strategy(64, "opt-", ARGPAR_LOOKUP_STRATEGY_HASH);
+    test_auto_lookup_strategy(20000, "opt-", ARGPAR_LOOKUP_STRATEGY_HASH);
+
+    /* Image: always hash tables */
+    {
+        size_t size;
+        char * const data = write_test_image(0xbeef, &size);
+        const argpar_descr_image_t *image = NULL;
+        const char * const argv[] = {"-v"};
+        argpar_iter_t *iter;
+        argpar_descr_image_open_status_t image_open_status;
+
+        image_open_status = argpar_descr_image_open(data, size, 0xbeef, NULL, &image);
+        assert(image_open_status == ARGPAR_DESCR_IMAGE_OPEN_STATUS_OK);
+        iter = argpar_iter_create_with_image(1, argv, image);
+        assert(iter);
+        ok(argpar_iter_set_lookup_strategy(iter, ARGPAR_LOOKUP_STRATEGY_SCAN) ==
+                   ARGPAR_ITER_SET_LOOKUP_STRATEGY_STATUS_OK &&
+               argpar_iter_lookup_strategy(iter) == ARGPAR_LOOKUP_STRATEGY_HASH,
+           "An iterator created with an image always uses the hash lookup strategy");
+        argpar_iter_destroy(iter);
+        argpar_descr_image_destroy(image);
+        g_free(data);
+    }
+}
+
+static const argpar_opt_descr_t fingerprint_test_descrs[] = {
+    {.id = 0, .short_name = 'v', .long_name = "verbose",
+     .flags = ARGPAR_OPT_DESCR_FLAG_ORDER_INSENSITIVE},
+    ARGPAR_OPT_DESCR(1, 'o', "output", true),
+    ARGPAR_OPT_DESCR(2, 'i', "input", true),
+    {.id = 3, .long_name = "color", .flags = ARGPAR_OPT_DESCR_FLAG_NEGATABLE},
+    {.id = 4, .short_name = 'D', .long_name = "define", .with_arg = true,
+     .flags = ARGPAR_OPT_DESCR_FLAG_ORDER_INSENSITIVE},
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+
+/*
+ * Returns the fingerprint of `cmdline` with `fingerprint_test_descrs`.
+ */
+static argpar_hash128_t fingerprint_of(const char * const cmdline)
+{
+    gchar ** const argv = g_strsplit(cmdline, " ", 0);
+    argpar_hash128_t fingerprint = {0, 0};
+    const argpar_fingerprint_status_t status =
+        argpar_fingerprint(g_strv_length(argv), (const char * const *) argv,
+                           fingerprint_test_descrs, &fingerprint, NULL);
+
+    assert(status == ARGPAR_FINGERPRINT_STATUS_OK);
+    g_strfreev(argv);
+    return fingerprint;
+}
+
+/*
+ * Ensures that `cmdline_a` and `cmdline_b` have the same fingerprint
+ * if `same` is true, or different fingerprints otherwise.
+ */
+static void test_fingerprint_eq(const char * const cmdline_a, const char * const cmdline_b,
+                                const bool same)
+{
+    const argpar_hash128_t a = fingerprint_of(cmdline_a);
+    const argpar_hash128_t b = fingerprint_of(cmdline_b);
+
+    ok((a.high == b.high && a.low == b.low) == same,
+       "argpar_fingerprint() gives %s fingerprints for `%s` and `%s`",
+       same ? "the same" : "different", cmdline_a, cmdline_b);
+}
+
+/*
+ * Ensures that the fingerprint of `cmdline` is `high` and `low`.
+ */
+static void test_fingerprint_value(const char * const cmdline, const unsigned long long high,
+                                   const unsigned long long low)
+{
+    const argpar_hash128_t fingerprint = fingerprint_of(cmdline);
+
+    ok(fingerprint.high == high && fingerprint.low == low,
+       "argpar_fingerprint() gives the expected fingerprint for `%s`", cmdline);
+}
+
+static void fingerprint_tests(void)
+{
+    /* Stable values */
+    test_fingerprint_value("", 0x1f0ea28a6492097aULL, 0xc8c937853bb9f50aULL);
+    test_fingerprint_value("-v -o x file", 0x0cab4c7abf85f723ULL, 0x8fb480e3de77776cULL);
+
+    /* Spelling */
+    test_fingerprint_eq("-o x", "--output=x", true);
+    test_fingerprint_eq("-ox", "--output x", true);
+    test_fingerprint_eq("-v -o x", "-o x -v", true);
+    test_fingerprint_eq("-vv -Da=1 -Db=2 in", "in -Db=2 --verbose -Da=1 -v", true);
+
+    /* Semantics */
+    test_fingerprint_eq("-v", "-vv", false);
+    test_fingerprint_eq("a b", "b a", false);
+    test_fingerprint_eq("-o x -i y", "-i y -o x", false);
+    test_fingerprint_eq("--color", "--no-color", false);
+    test_fingerprint_eq("-o ab c", "-o a bc", false);
+    test_fingerprint_eq("-o x", "-i x", false);
+    test_fingerprint_eq("-Da -Db", "-Dab", false);
+
+    /* Parsing error */
+    {
+        const char * const argv[] = {"-o", "x", "--zut"};
+        argpar_hash128_t fingerprint = {1, 2};
+        const argpar_error_t *error = NULL;
+
+        ok(argpar_fingerprint(3, argv, fingerprint_test_descrs, &fingerprint, &error) ==
+                   ARGPAR_FINGERPRINT_STATUS_ERROR &&
+               error && argpar_error_type(error) == ARGPAR_ERROR_TYPE_UNKNOWN_OPT &&
+               argpar_error_orig_index(error) == 2 && fingerprint.high == 1 &&
+               fingerprint.low == 2,
+           "argpar_fingerprint() reports a parsing error");
+        argpar_error_destroy(error);
+
+        ok(argpar_fingerprint(3, argv, fingerprint_test_descrs, &fingerprint, NULL) ==
+               ARGPAR_FINGERPRINT_STATUS_ERROR,
+           "argpar_fingerprint() accepts a `NULL` error");
+    }
 }
 
 int main(void)
 {
-    plan_tests(309);
+    plan_tests(687);
     succeed_tests();
     fail_tests();
+    kv_tests();
+    list_tests();
+    choice_tests();
+    parse_into_argvs = g_ptr_array_new_with_free_func((GDestroyNotify) g_strfreev);
+    parse_into_tests();
+    g_ptr_array_free(parse_into_argvs, TRUE);
+    flag_sink_tests();
+    parse_tests();
+    namespace_tests();
+    stop_at_non_opt_tests();
+    parse_permute_tests();
+    histogram_tests();
+    image_tests();
+    reparser_tests();
+    lookup_cache_tests();
+    lookup_strategy_tests();
+    fingerprint_tests();
     return exit_status();
 }
@@ -0,0 +1,277 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ * SPDX-FileCopyrightText: EfficiOS Inc.
+ */
+
+/*
+ * CTF trace event sink tests.
+ *
+ * This test program writes the events of argument parsing iterators
+ * with the CTF trace writer into a temporary directory, and then
+ * decodes the resulting data stream to ensure that it contains the
+ * expected packets and events.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "argpar/argpar-ctf.h"
+#include "tap/tap.h"
+
+static const argpar_opt_descr_t descrs[] = {
+    ARGPAR_OPT_DESCR(0, 'a', NULL, false),
+    ARGPAR_OPT_DESCR(1, 'o', "output", true),
+    ARGPAR_OPT_DESCR_SENTINEL,
+};
+
+/* Decoded data stream */
+struct decoded
+{
+    /* `true` if all the packets are well-formed */
+    bool packets_ok;
+
+    /* Number of packets */
+    unsigned int packet_count;
+
+    /* Number of events */
+    unsigned int event_count;
+
+    /* Summary of the first events */
+    char summary[512];
+};
+
+/*
+ * Reads the whole file `path` into a new buffer, setting `*size` to
+ * its size.
+ */
+static unsigned char *read_file(const char * const path, size_t * const size)
+{
+    FILE * const fp = fopen(path, "rb");
+    unsigned char *data = NULL;
+    long len;
+
+    assert(fp);
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    assert(len >= 0);
+    fseek(fp, 0, SEEK_SET);
+    data = malloc((size_t) len + 1);
+    assert(data);
+    *size = fread(data, 1, (size_t) len, fp);
+    data[*size] = '\0';
+    fclose(fp);
+    return data;
+}
+
+/* Reads a native 32-bit value from `data` */
+static uint32_t read_u32(const unsigned char * const data)
+{
+    uint32_t val;
+
+    memcpy(&val, data, sizeof(val));
+    return val;
+}
+
+/* Reads a native 64-bit value from `data` */
+static uint64_t read_u64(const unsigned char * const data)
+{
+    uint64_t val;
+
+    memcpy(&val, data, sizeof(val));
+    return val;
+}
+
+/*
+ * Decodes the data stream `data` (`size` bytes) into `decoded`,
+ * summarizing the first events.
+ */
+static void decode_stream(const unsigned char * const data, const size_t size,
+                          struct decoded * const decoded)
+{
+    size_t offset = 0;
+
+    memset(decoded, 0, sizeof(*decoded));
+    decoded->packets_ok = true;
+
+    while (offset < size) {
+        const unsigned char * const packet = &data[offset];
+        const uint64_t ts_begin = read_u64(&packet[24]);
+        const uint64_t ts_end = read_u64(&packet[32]);
+        const uint64_t content_size = read_u64(&packet[40]) / 8;
+        uint64_t last_ts = ts_begin;
+        size_t pos = 56;
+
+        if (read_u32(packet) != UINT32_C(0xc1fc1fc1) ||
+            content_size != read_u64(&packet[48]) / 8 || offset + content_size > size ||
+            ts_begin > ts_end) {
+            decoded->packets_ok = false;
+            return;
+        }
+
+        while (pos < content_size) {
+            const unsigned int id = packet[pos];
+            const uint64_t ts = read_u64(&packet[pos + 1]);
+            char event_summary[64];
+
+            if (ts < last_ts || ts > ts_end) {
+                decoded->packets_ok = false;
+            }
+
+            last_ts = ts;
+            pos += 9 + 8;
+
+            if (id == 0) {
+                sprintf(event_summary, "create(%u) ", read_u32(&packet[pos]));
+                pos += 4;
+            } else {
+                sprintf(event_summary, "%s(%d,%u,%d,%d) ", id == 1 ? "next" : "error",
+                        (int) read_u32(&packet[pos]), read_u32(&packet[pos + 4]),
+                        (int) read_u32(&packet[pos + 8]), (int) read_u32(&packet[pos + 12]));
+                pos += 16;
+            }
+
+            if (strlen(decoded->summary) + strlen(event_summary) < sizeof(decoded->summary)) {
+                strcat(decoded->summary, event_summary);
+            }
+
+            decoded->event_count++;
+        }
+
+        if (pos != content_size) {
+            decoded->packets_ok = false;
+        }
+
+        decoded->packet_count++;
+        offset += content_size;
+    }
+}
+
+/*
+ * Iterates `argv` (`argc` elements) with the CTF trace writer
+ * `writer` as the event sink.
+ */
+static void iterate(argpar_ctf_writer_t * const writer, const unsigned int argc,
+                    const char * const * const argv, const bool want_error)
+{
+    argpar_iter_t * const iter = argpar_iter_create(argc, argv, descrs);
+    const argpar_item_t *item = NULL;
+    const argpar_error_t *error = NULL;
+
+    assert(iter);
+    argpar_iter_set_event_sink(iter, argpar_ctf_writer_sink, writer);
+
+    while (argpar_iter_next(iter, &item, want_error ? &error : NULL) ==
+           ARGPAR_ITER_NEXT_STATUS_OK) {
+        ARGPAR_ITEM_DESTROY_AND_RESET(item);
+    }
+
+    argpar_error_destroy(error);
+    argpar_iter_destroy(iter);
+}
+
+/*
+ * Writes the trace of the iterations of `argv` (`argc` elements),
+ * `iter_count` times, into a temporary directory, and decodes its data
+ * stream into `decoded`.
+ */
+static void write_and_decode(const unsigned int argc, const char * const * const argv,
+                             const unsigned int iter_count, const bool want_error,
+                             struct decoded * const decoded, bool * const metadata_ok)
+{
+    char dir_path[] = "/tmp/argpar-test-ctf-XXXXXX";
+    char path[64];
+    argpar_ctf_writer_t *writer;
+    unsigned char *data;
+    size_t size;
+    unsigned int i;
+    const char *created_dir_path;
+    int destroy_ret;
+
+    created_dir_path = mkdtemp(dir_path);
+    assert(created_dir_path);
+    writer = argpar_ctf_writer_create(dir_path);
+    assert(writer);
+
+    for (i = 0; i < iter_count; i++) {
+        iterate(writer, argc, argv, want_error);
+    }
+
+    destroy_ret = argpar_ctf_writer_destroy(writer);
+    assert(destroy_ret == 0);
+
+    /* Metadata */
+    sprintf(path, "%s/metadata", dir_path);
+    data = read_file(path, &size);
+    *metadata_ok = strncmp((const char *) data, "/* CTF 1.8 */", 13) == 0 &&
+                   strstr((const char *) data, "name = \"argpar:iter_next\";") != NULL;
+    free(data);
+    unlink(path);
+
+    /* Data stream */
+    sprintf(path, "%s/stream", dir_path);
+    data = read_file(path, &size);
+    decode_stream(data, size, decoded);
+    free(data);
+    unlink(path);
+    rmdir(dir_path);
+}
+
+/*
+ * Ensures that the trace of the iterations of `argv` (`argc` elements)
+ * has the summary `expected_summary`.
+ */
+static void test_events(const unsigned int argc, const char * const * const argv,
+                        const bool want_error, const char * const expected_summary)
+{
+    struct decoded decoded;
+    bool metadata_ok;
+
+    write_and_decode(argc, argv, 1, want_error, &decoded, &metadata_ok);
+    ok(metadata_ok, "CTF trace writer writes the metadata (%u arguments)", argc);
+    ok(decoded.packets_ok && decoded.packet_count == 1 &&
+           strcmp(decoded.summary, expected_summary) == 0,
+       "CTF trace writer writes the expected events (%u arguments)", argc);
+
+    if (strcmp(decoded.summary, expected_summary) != 0) {
+        diag("Expected: `%s`", expected_summary);
+        diag("Got:      `%s`", decoded.summary);
+    }
+}
+
+int main(void)
+{
+    plan_tests(7);
+
+    {
+        const char * const argv[] = {"-a", "--output=x", "file"};
+
+        test_events(3, argv, true,
+                    "create(3) next(0,0,0,0) next(0,1,0,1) next(0,2,1,-1) next(1,3,-1,-1) ");
+    }
+
+    /* Error event, with and without the error object */
+    {
+        const char * const argv[] = {"-a", "--meow", "-o"};
+
+        test_events(3, argv, true, "create(3) next(0,0,0,0) error(-1,1,0,-1) ");
+        test_events(3, argv, false, "create(3) next(0,0,0,0) error(-1,1,0,-1) ");
+    }
+
+    /* Many events: many packets */
+    {
+        const char * const argv[] = {"-a", "--output=x", "file", "-aaa"};
+        struct decoded decoded;
+        bool metadata_ok;
+
+        write_and_decode(4, argv, 200, true, &decoded, &metadata_ok);
+        ok(decoded.packets_ok && decoded.packet_count > 1 && decoded.event_count == 200 * 8,
+           "CTF trace writer splits the events into packets");
+    }
+
+    return exit_status();
+}